@@ -0,0 +1,404 @@
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/calldata_view.h>
+#include <evmtools/decode_cache.h>
+#include <evmtools/json_writer.h>
+#include <evmtools/selector_scanner.h>
+#include <evmtools/typed_decoder.h>
+#include <evmtools/version.h>
+#include <evmtools/word_classifier.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cxxopts.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace evmtools::calldata_decoder;
+using evmtools::typed_decoder::CommonDecoders;
+
+// ---- Allocation counting ----
+
+namespace {
+  std::atomic<size_t> allocations{0};
+
+  void* counted_alloc(std::size_t size, std::size_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    size = std::max<std::size_t>(size, 1);
+#ifdef _MSC_VER
+    void* memory{_aligned_malloc(size, alignment)};
+#else
+    // aligned_alloc needs a size that is a multiple of the alignment.
+    void* memory{std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)};
+#endif
+    if (memory == nullptr) {
+      throw std::bad_alloc{};
+    }
+    return memory;
+  }
+
+  void counted_free(void* memory) noexcept {
+#ifdef _MSC_VER
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+  }
+}  // namespace
+
+void* operator new(std::size_t size) { return counted_alloc(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return counted_alloc(size, std::max(static_cast<std::size_t>(alignment), alignof(void*)));
+}
+void operator delete(void* memory) noexcept { counted_free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { counted_free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { counted_free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+  counted_free(memory);
+}
+
+// ---- Measurement ----
+
+namespace {
+  /** Keeps the compiler from optimising away a benchmarked result. */
+  template <typename T> void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+  }
+
+  struct Result {
+    std::string benchmark;
+    std::string input;
+    size_t iterations{0};
+    double ns_per_op{0};
+    double bytes_per_second{0};
+    double allocs_per_op{0};
+  };
+
+  struct Corpus {
+    std::string name;
+    std::string hex;
+    std::vector<uint8_t> bytes;
+  };
+
+  /**
+   * Runs `op` in growing batches until `min_time` has passed, and reports the per-op averages of
+   * the last batch.
+   */
+  template <typename Op> Result measure(std::string benchmark, std::string input,
+                                        size_t bytes_per_op, std::chrono::nanoseconds min_time,
+                                        Op&& op) {
+    using clock = std::chrono::steady_clock;
+
+    // Warm up caches and lazily initialised state.
+    op();
+
+    for (size_t iterations = 1;; iterations *= 2) {
+      auto allocations_before{allocations.load(std::memory_order_relaxed)};
+      auto start{clock::now()};
+
+      for (size_t i = 0; i < iterations; i++) {
+        op();
+      }
+
+      auto elapsed{clock::now() - start};
+      auto allocated{allocations.load(std::memory_order_relaxed) - allocations_before};
+
+      if (elapsed >= min_time || iterations >= (size_t{1} << 40)) {
+        double ns{std::chrono::duration<double, std::nano>(elapsed).count()};
+        double ops{static_cast<double>(iterations)};
+        return Result{std::move(benchmark),
+                      std::move(input),
+                      iterations,
+                      ns / ops,
+                      static_cast<double>(bytes_per_op) * ops / (ns / 1e9),
+                      static_cast<double>(allocated) / ops};
+      }
+    }
+  }
+
+  std::vector<Corpus> load_corpus(const std::filesystem::path& directory) {
+    std::vector<Corpus> corpus;
+
+    for (const auto& entry : std::filesystem::directory_iterator{directory}) {
+      if (entry.path().extension() != ".hex") {
+        continue;
+      }
+
+      std::ifstream file{entry.path()};
+      std::stringstream text;
+      text << file.rdbuf();
+
+      auto hex{text.str()};
+      auto is_space{[](unsigned char c) { return std::isspace(c) != 0; }};
+      hex.erase(std::remove_if(hex.begin(), hex.end(), is_space), hex.end());
+
+      auto bytes{bytes_from_hex(hex)};
+      corpus.push_back(Corpus{entry.path().stem().string(), std::move(hex), std::move(bytes)});
+    }
+
+    std::sort(corpus.begin(), corpus.end(),
+              [](const Corpus& a, const Corpus& b) { return a.bytes.size() < b.bytes.size(); });
+    return corpus;
+  }
+
+  std::vector<Result> run(const std::vector<Corpus>& corpus, const std::string& filter,
+                          std::chrono::nanoseconds min_time) {
+    std::vector<Result> results;
+
+    auto enabled{[&](std::string_view benchmark) {
+      return filter.empty() || benchmark.find(filter) != std::string_view::npos;
+    }};
+
+    // The selectors of the whole corpus stand in for a set of known selectors.
+    std::vector<Selector> known;
+    for (const auto& input : corpus) {
+      if (input.bytes.size() >= SELECTOR_SIZE) {
+        known.push_back(Selector::from_bytes(input.bytes.data()));
+      }
+    }
+    const evmtools::selector_scanner::SelectorSet known_set{known};
+
+    for (const auto& input : corpus) {
+      std::span<const uint8_t> bytes{input.bytes};
+      std::string_view hex{input.hex};
+
+      // The 64-character hex words of the params, as `uint_from_hex_str` sees them.
+      std::vector<std::string_view> hex_words;
+      for (size_t i = 2 + SELECTOR_SIZE * 2; i + WORD_SIZE * 2 <= hex.size(); i += WORD_SIZE * 2) {
+        hex_words.push_back(hex.substr(i, WORD_SIZE * 2));
+      }
+      auto words{split_calldata(bytes.subspan(SELECTOR_SIZE))};
+      const size_t words_size{words.size() * WORD_SIZE};
+
+      if (enabled("split_calldata")) {
+        results.push_back(measure("split_calldata", input.name, bytes.size(), min_time,
+                                  [&] { keep(split_calldata(bytes)); }));
+      }
+
+      if (enabled("uint_from_hex_str") && !hex_words.empty()) {
+        results.push_back(measure("uint_from_hex_str", input.name, hex_words.size() * WORD_SIZE * 2,
+                                  min_time, [&] {
+                                    for (auto word : hex_words) keep(uint_from_hex_str<256>(word));
+                                  }));
+      }
+
+      if (enabled("get_param_type") && !words.empty()) {
+        results.push_back(measure("get_param_type", input.name, words_size, min_time, [&] {
+          for (const auto& word : words) keep(get_param_type(word));
+        }));
+      }
+
+      if (enabled("classify_words") && !words.empty()) {
+        std::vector<ParamTypes> types(words.size());
+        results.push_back(measure("classify_words", input.name, words_size, min_time, [&] {
+          evmtools::word_classifier::classify(words, types);
+          keep(types);
+        }));
+      }
+
+      if (enabled("scan_selectors")) {
+        std::vector<evmtools::selector_scanner::Candidate> candidates;
+        results.push_back(measure("scan_selectors", input.name, bytes.size(), min_time, [&] {
+          candidates.clear();
+          evmtools::selector_scanner::scan(bytes, known_set, candidates);
+          keep(candidates);
+        }));
+      }
+
+      if (enabled("view_selector")) {
+        results.push_back(measure("view_selector", input.name, SELECTOR_SIZE, min_time,
+                                  [&] { keep(CalldataView{bytes}.selector()); }));
+      }
+
+      if (enabled("typed_dispatch")
+          && CommonDecoders::contains(Selector::from_bytes(bytes.data()))) {
+        results.push_back(measure("typed_dispatch", input.name, bytes.size(), min_time, [&] {
+          CommonDecoders::visit(bytes, [](auto, const auto& values) { keep(values); });
+        }));
+      }
+
+      if (enabled("calldata_hex")) {
+        results.push_back(measure("calldata_hex", input.name, hex.size(), min_time,
+                                  [&] { keep(Calldata{hex}); }));
+      }
+
+      if (enabled("calldata_bytes")) {
+        results.push_back(measure("calldata_bytes", input.name, bytes.size(), min_time,
+                                  [&] { keep(Calldata{bytes}); }));
+      }
+
+      if (enabled("format_json")) {
+        Calldata calldata{bytes};
+        std::string out;
+        results.push_back(measure("format_json", input.name, bytes.size(), min_time, [&] {
+          out.clear();
+          evmtools::json_writer::append_json(out, calldata);
+          keep(out);
+        }));
+      }
+
+      if (enabled("calldata_cached")) {
+        // Every op after the warm-up is a hit.
+        evmtools::decode_cache::DecodeCache cache{16};
+        results.push_back(measure("calldata_cached", input.name, bytes.size(), min_time,
+                                  [&] { keep(cache.get(bytes)); }));
+      }
+
+      if (enabled("calldata_arena")) {
+        DecodeArena arena{};
+        results.push_back(measure("calldata_arena", input.name, bytes.size(), min_time, [&] {
+          {
+            Calldata calldata{bytes, arena.allocator()};
+            keep(calldata);
+          }
+          arena.reset();
+        }));
+      }
+    }
+
+    return results;
+  }
+
+  void write_text(std::ostream& out, const std::vector<Result>& results) {
+    out << std::left;
+    out.width(20);
+    out << "benchmark";
+    out.width(18);
+    out << "input";
+    out << std::right;
+    out.width(14);
+    out << "ns/op";
+    out.width(14);
+    out << "MB/s";
+    out.width(12);
+    out << "allocs/op" << '\n';
+
+    out.setf(std::ios::fixed);
+    out.precision(1);
+
+    for (const auto& result : results) {
+      out << std::left;
+      out.width(20);
+      out << result.benchmark;
+      out.width(18);
+      out << result.input;
+      out << std::right;
+      out.width(14);
+      out << result.ns_per_op;
+      out.width(14);
+      out << result.bytes_per_second / 1e6;
+      out.width(12);
+      out << result.allocs_per_op << '\n';
+    }
+  }
+
+  void write_json(std::ostream& out, const std::vector<Result>& results) {
+    out.precision(6);
+    out << "{\"version\":\"" << EVMTOOLS_VERSION << "\",\"results\":[";
+
+    for (size_t i = 0; i < results.size(); i++) {
+      const auto& result{results[i]};
+      out << (i == 0 ? "" : ",") << "\n  {\"benchmark\":\"" << result.benchmark
+          << "\",\"input\":\"" << result.input << "\",\"iterations\":" << result.iterations
+          << ",\"ns_per_op\":" << result.ns_per_op
+          << ",\"bytes_per_second\":" << result.bytes_per_second
+          << ",\"allocs_per_op\":" << result.allocs_per_op << "}";
+    }
+
+    out << "\n]}\n";
+  }
+
+  void write_csv(std::ostream& out, const std::vector<Result>& results) {
+    out.precision(6);
+    out << "benchmark,input,iterations,ns_per_op,bytes_per_second,allocs_per_op\n";
+
+    for (const auto& result : results) {
+      out << result.benchmark << ',' << result.input << ',' << result.iterations << ','
+          << result.ns_per_op << ',' << result.bytes_per_second << ',' << result.allocs_per_op
+          << '\n';
+    }
+  }
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  cxxopts::Options options(*argv, "Benchmarks the calldata decoder over a corpus of inputs");
+
+  std::string corpus_dir{EVMTOOLS_BENCH_CORPUS};
+  std::string format;
+  std::string filter;
+  std::string output;
+  double min_time{0.2};
+
+  // clang-format off
+  options.add_options()
+    ("h,help", "Show help")
+    ("c,corpus", "Directory of .hex files to benchmark", cxxopts::value(corpus_dir))
+    ("f,format", "Output format: text, json or csv",
+     cxxopts::value(format)->default_value("text"))
+    ("filter", "Only run benchmarks whose name contains this", cxxopts::value(filter))
+    ("min-time", "Minimum seconds to run each benchmark for",
+     cxxopts::value(min_time)->default_value("0.2"))
+    ("o,output", "File to write results to, instead of stdout", cxxopts::value(output))
+  ;
+  // clang-format on
+
+  auto result = options.parse(argc, argv);
+
+  if (result["help"].as<bool>()) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  if (format != "text" && format != "json" && format != "csv") {
+    std::cerr << "unknown format " << format << std::endl;
+    return 1;
+  }
+
+  try {
+    auto corpus{load_corpus(corpus_dir)};
+    if (corpus.empty()) {
+      std::cerr << "no .hex files in " << corpus_dir << std::endl;
+      return 1;
+    }
+
+    auto results{run(corpus, filter,
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::duration<double>{min_time}))};
+
+    std::ofstream output_file;
+    if (!output.empty()) {
+      output_file.open(output);
+      if (!output_file) {
+        std::cerr << "failed to open " << output << std::endl;
+        return 1;
+      }
+    }
+    std::ostream& out{output.empty() ? std::cout : output_file};
+
+    if (format == "json") {
+      write_json(out, results);
+    } else if (format == "csv") {
+      write_csv(out, results);
+    } else {
+      write_text(out, results);
+    }
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
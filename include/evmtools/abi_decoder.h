@@ -0,0 +1,173 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief Exact decoding of calldata for functions whose ABI is known at runtime.
+   *
+   * Each function of a Solidity ABI JSON file is compiled once into a flat decode plan: one
+   * Instruction per node of its params' type tree, in pre-order, with the params themselves
+   * wrapped in a root tuple. Decoding looks up the plan by selector and runs it with a small
+   * interpreter, so its cost doesn't depend on how many ABIs are loaded.
+   */
+  namespace abi_decoder {
+    using calldata_decoder::allocator_type;
+    using calldata_decoder::Selector;
+
+    /** Operations of a decode plan. */
+    enum class Op : uint8_t {
+      Address,
+      Bool,
+      Uint,
+      Int,
+      FixedBytes,
+      Bytes,
+      String,
+      // T[]
+      Array,
+      // T[k]
+      FixedArray,
+      Tuple
+    };
+
+    /** One node of a function's param type tree. */
+    struct Instruction {
+      Op op{Op::Uint};
+      // Whether the encoding is dynamic, i.e. the head is an offset to the value.
+      bool dynamic{false};
+      // Bits of `uint<N>`/`int<N>`, or bytes of `bytes<N>`.
+      uint16_t size{0};
+      // Length of `T[k]`, or number of components of a tuple.
+      uint32_t count{0};
+      // Bytes the value takes up in the head of its enclosing tuple or array.
+      uint32_t head{0};
+      // Index of the instruction after this node's subtree. Children follow the node directly.
+      uint32_t end{0};
+    };
+
+    /** A function compiled into a decode plan. */
+    struct Function {
+      std::string name;
+      // Canonical signature, e.g. `swap((address,uint256)[],bytes)`.
+      std::string signature;
+      Selector selector;
+      // The decode plan. `plan[0]` is the tuple of params.
+      std::vector<Instruction> plan;
+      // Name of the param or tuple component of each instruction, empty for array elements.
+      std::vector<std::string> names;
+      // Deepest nesting of the plan, with the root tuple at depth 0.
+      uint32_t depth{0};
+    };
+
+    /** A decoded value. */
+    struct Value {
+      // Marks the root value, which has no parent.
+      static constexpr uint32_t NO_PARENT{std::numeric_limits<uint32_t>::max()};
+
+      // Index of the instruction that decoded the value, in `Function::plan`.
+      uint32_t instruction{0};
+      // Index of the enclosing tuple or array, in `DecodedCall::values`.
+      uint32_t parent{NO_PARENT};
+      Op op{Op::Uint};
+      // Param or tuple component name, empty for array elements.
+      std::string_view name;
+      // The 32-byte word of elementary values, or the payload of `bytes` and `string`. Refers into
+      // the decoded calldata.
+      std::span<const uint8_t> data;
+      // Number of elements of arrays, or components of tuples.
+      size_t count{0};
+    };
+
+    /** The result of decoding calldata with a decode plan. */
+    struct DecodedCall {
+      const Function* function{nullptr};
+      // Every decoded value in pre-order, so each value comes after its parent.
+      std::pmr::vector<Value> values;
+    };
+
+    /**
+     * @brief A set of decode plans, indexed by selector.
+     *
+     * @note Loading is not thread-safe, but decoding from any number of threads is.
+     */
+    class AbiDecoder {
+    public:
+      /** Deepest nesting of tuples and arrays accepted in an ABI. */
+      static constexpr uint32_t MAX_DEPTH{32};
+
+      AbiDecoder() = default;
+
+      /**
+       * @brief Compiles every function of an ABI.
+       *
+       * @note Functions whose selector is already loaded are skipped, so loading the same ABI
+       * twice is harmless.
+       *
+       * @param abi_json A JSON array of ABI entries, or a JSON object (e.g. a build artifact) with
+       * such an array in its `abi` field. Entries other than functions are ignored.
+       * @return The number of functions added.
+       * @throws std::invalid_argument if the JSON is malformed or a function has an unsupported or
+       * too deeply nested type.
+       */
+      size_t load_json(std::string_view abi_json);
+
+      /**
+       * @brief Compiles every function of an ABI JSON file.
+       *
+       * @param path Path to the file.
+       * @return The number of functions added.
+       * @throws std::system_error if the file can't be read.
+       * @throws std::invalid_argument if the file isn't a valid ABI.
+       */
+      size_t load_file(const std::filesystem::path& path);
+
+      /**
+       * @param selector The selector to be looked up.
+       * @return The function with the selector, or nullptr if none is loaded.
+       */
+      [[nodiscard]] const Function* find(const Selector selector) const noexcept;
+
+      /**
+       * @brief Decodes calldata with the decode plan of its selector.
+       *
+       * @note Values of `bytes` and `string` refer into `calldata`, which must outlive the result.
+       *
+       * @param calldata The raw calldata bytes.
+       * @param alloc Allocator for the decoded values.
+       * @return The decoded values, or `std::nullopt` if no function has the selector or the
+       * calldata isn't a valid encoding of its params.
+       */
+      [[nodiscard]] std::optional<DecodedCall> decode(std::span<const uint8_t> calldata,
+                                                      allocator_type alloc = {}) const;
+
+      /**
+       * @brief Decodes the raw bytes of heuristically decoded calldata exactly.
+       */
+      [[nodiscard]] std::optional<DecodedCall> decode(const calldata_decoder::Calldata& calldata,
+                                                      allocator_type alloc = {}) const;
+
+      /** @return The number of functions loaded. */
+      [[nodiscard]] size_t size() const noexcept;
+
+    private:
+      // A deque, so that loading more functions doesn't move those already handed out.
+      std::deque<Function> functions;
+      std::unordered_map<uint32_t, uint32_t> by_selector;
+    };
+
+  }  // namespace abi_decoder
+}  // namespace evmtools
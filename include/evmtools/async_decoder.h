@@ -0,0 +1,177 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/mpmc_queue.h>
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief Decoding off the caller's thread: inputs are handed to a set of decoder threads
+   * through a bounded lock-free queue, and results come back through a callback, a future, a
+   * coroutine or a queue of completions polled in batches.
+   */
+  namespace async_decoder {
+
+    /** A decoded input, along with the input itself, which the calldata refers into. */
+    struct Decoded {
+      std::vector<uint8_t> input;
+      calldata_decoder::DecodeResult result;
+    };
+
+    /** Called on a decoder thread with each result. Must not throw. */
+    using Callback = std::function<void(Decoded&&)>;
+
+    /** A result of a tagged submission, see `AsyncDecoder::poll`. */
+    struct Completion {
+      uint64_t tag{0};
+      Decoded decoded;
+    };
+
+    /** Tuning knobs for an AsyncDecoder. */
+    struct AsyncOptions {
+      // Number of decoder threads, or 0 to use one per hardware thread.
+      size_t threads{0};
+      // Most inputs that may wait to be decoded before submissions are refused or wait.
+      size_t queue_capacity{4096};
+      // Most tagged results that may wait to be polled before the decoder threads wait.
+      size_t completion_capacity{4096};
+      // Limits on the work each decode may do.
+      calldata_decoder::DecodeOptions decode{};
+    };
+
+    /**
+     * @brief A service that decodes raw calldata on its own threads.
+     *
+     * Submissions go through a bounded lock-free queue. The `try_` functions never block or lock:
+     * they return false when the queue is full, which leaves the input with the caller, so an I/O
+     * thread can shed or defer load instead of stalling. The other submit functions sleep until
+     * there is room instead. Idle decoder threads sleep until there is work, and decoder threads
+     * with tagged results sleep while the completion queue is full.
+     *
+     * @note All member functions may be called concurrently from any thread.
+     */
+    class AsyncDecoder {
+    public:
+      class Awaitable;
+
+      /**
+       * @brief Starts the decoder threads.
+       *
+       * @param options Tuning knobs for the service.
+       */
+      explicit AsyncDecoder(const AsyncOptions& options = {});
+
+      /**
+       * @brief Decodes every input submitted so far, then joins the decoder threads. Tagged
+       * results that haven't been polled are dropped once the completion queue is full.
+       */
+      ~AsyncDecoder();
+
+      AsyncDecoder(const AsyncDecoder& other) = delete;
+      AsyncDecoder& operator=(const AsyncDecoder& other) = delete;
+
+      /**
+       * @brief Queues an input to be decoded and passed to `callback`, unless the queue is full.
+       *
+       * @param input The raw calldata bytes.
+       * @param callback Called with the result on a decoder thread.
+       * @return Whether the input was queued. If not, `input` and `callback` are left untouched.
+       */
+      bool try_submit(std::vector<uint8_t>&& input, Callback&& callback);
+
+      /** @brief Queues an input to be decoded and passed to `callback`, waiting for room. */
+      void submit(std::vector<uint8_t> input, Callback callback);
+
+      /**
+       * @brief Queues an input to be decoded, waiting for room.
+       *
+       * @return A future that becomes ready with the result.
+       */
+      [[nodiscard]] std::future<Decoded> submit(std::vector<uint8_t> input);
+
+      /**
+       * @brief Decodes an input from within a coroutine. `co_await` on the result queues the input
+       * (waiting for room) and resumes the coroutine on a decoder thread with the `Decoded`.
+       */
+      [[nodiscard]] Awaitable decode(std::vector<uint8_t> input);
+
+      /**
+       * @brief Queues an input whose result is put in the completion queue under `tag`, unless the
+       * submission queue is full.
+       *
+       * @return Whether the input was queued. If not, `input` is left untouched.
+       */
+      bool try_submit_tagged(std::vector<uint8_t>&& input, uint64_t tag);
+
+      /** @brief Queues an input for the completion queue under `tag`, waiting for room. */
+      void submit_tagged(std::vector<uint8_t> input, uint64_t tag);
+
+      /**
+       * @brief Moves up to `max` results of tagged submissions to the end of `out`, without
+       * waiting. Results come in roughly the order they finished.
+       *
+       * @return The number of results moved.
+       */
+      size_t poll(std::vector<Completion>& out, size_t max = SIZE_MAX);
+
+      /** @return The number of inputs submitted but not yet decoded. */
+      [[nodiscard]] size_t pending() const noexcept;
+
+      /** @brief Awaits the decode of one input; see `decode`. */
+      class Awaitable {
+      public:
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        Decoded await_resume() noexcept { return std::move(this->decoded); }
+
+      private:
+        friend class AsyncDecoder;
+
+        Awaitable(AsyncDecoder& owner, std::vector<uint8_t> bytes)
+            : decoder(owner), input(std::move(bytes)) {}
+
+        AsyncDecoder& decoder;
+        std::vector<uint8_t> input;
+        Decoded decoded;
+      };
+
+    private:
+      struct Job {
+        std::vector<uint8_t> input;
+        // Called with the result; if empty, the result goes to the completion queue instead.
+        Callback callback;
+        uint64_t tag{0};
+      };
+
+      calldata_decoder::DecodeOptions decode_options;
+      mpmc_queue::MpmcQueue<Job> jobs;
+      mpmc_queue::MpmcQueue<Completion> completions;
+      // Bumped on every submission and on shutdown; idle decoder threads wait for it to change.
+      std::atomic<uint32_t> epoch{0};
+      // Bumped whenever a job leaves the queue; submitters wait for it to change while it's full.
+      std::atomic<uint32_t> job_room{0};
+      // Bumped whenever results are polled and on shutdown; decoder threads wait for it to change
+      // while the completion queue is full.
+      std::atomic<uint32_t> completion_room{0};
+      std::atomic<size_t> queued{0};
+      std::atomic<bool> stopping{false};
+      std::vector<std::thread> workers;
+
+      bool try_push(Job&& job);
+      void push(Job&& job);
+      std::optional<Job> try_pop();
+      void run(Job&& job);
+      void worker_loop();
+    };
+
+  }  // namespace async_decoder
+}  // namespace evmtools
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/thread_pool.h>
+
+#include <cstddef>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+namespace evmtools {
+  namespace calldata_decoder {
+
+    /** Default number of inputs each task of `decode_batch` decodes. */
+    constexpr size_t DEFAULT_BATCH_GRAIN{64};
+
+    /**
+     * @brief Decodes a range of calldata inputs in parallel on a thread pool.
+     *
+     * @note Inputs are anything a Calldata can be constructed from: hex strings or spans of raw
+     * bytes. Raw byte inputs must outlive the results, which refer into them.
+     *
+     * @param inputs The calldata inputs to be decoded.
+     * @param pool The thread pool the inputs are decoded on.
+     * @param options Limits on the work each decode may do.
+     * @param grain Number of consecutive inputs decoded by each task.
+     * @return The decoded calldata, in input order. Inputs that fail to decode (e.g. malformed hex
+     * or over budget) are `std::nullopt`.
+     */
+    template <std::ranges::random_access_range Range>
+      requires std::ranges::sized_range<Range>
+               && std::constructible_from<Calldata, std::ranges::range_reference_t<const Range>,
+                                          const DecodeOptions&>
+    [[nodiscard]] std::vector<std::optional<Calldata>> decode_batch(
+        const Range& inputs, thread_pool::ThreadPool& pool, const DecodeOptions& options,
+        size_t grain = DEFAULT_BATCH_GRAIN) {
+      std::vector<std::optional<Calldata>> results(std::ranges::size(inputs));
+
+      pool.parallel_for(results.size(), grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          try {
+            results[i].emplace(std::ranges::begin(inputs)[i], options);
+          } catch (const std::exception&) {
+            // Leave malformed inputs empty.
+          }
+        }
+      });
+
+      return results;
+    }
+
+    /**
+     * @brief Decodes a range of calldata inputs in parallel on a thread pool, without limits.
+     */
+    template <std::ranges::random_access_range Range>
+      requires std::ranges::sized_range<Range>
+               && std::constructible_from<Calldata, std::ranges::range_reference_t<const Range>>
+    [[nodiscard]] std::vector<std::optional<Calldata>> decode_batch(
+        const Range& inputs, thread_pool::ThreadPool& pool, size_t grain = DEFAULT_BATCH_GRAIN) {
+      return decode_batch(inputs, pool, DecodeOptions{}, grain);
+    }
+
+    /**
+     * @brief Decodes a range of calldata inputs in parallel on a temporary thread pool.
+     *
+     * @param inputs The calldata inputs to be decoded.
+     * @param threads Number of threads, or 0 to use one per hardware thread.
+     * @return The decoded calldata, in input order. Inputs that fail to decode are `std::nullopt`.
+     */
+    template <std::ranges::random_access_range Range>
+      requires std::ranges::sized_range<Range>
+               && std::constructible_from<Calldata, std::ranges::range_reference_t<const Range>>
+    [[nodiscard]] std::vector<std::optional<Calldata>> decode_batch(const Range& inputs,
+                                                                    size_t threads = 0) {
+      thread_pool::ThreadPool pool{threads};
+      return decode_batch(inputs, pool);
+    }
+
+  }  // namespace calldata_decoder
+}  // namespace evmtools
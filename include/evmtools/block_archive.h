@@ -0,0 +1,125 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/mapped_file.h>
+#include <evmtools/signature_index.h>
+#include <evmtools/stream_decoder.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief Parallel decoding of the calldata in a local archive of RLP-encoded blocks.
+   *
+   * An archive is a file, or a directory whose regular files are read in name order. Each file
+   * holds blocks back to back, either as plain concatenated RLP (what `geth export` writes) or
+   * each behind a 4-byte little-endian length. Files are memory-mapped and blocks are never
+   * copied.
+   */
+  namespace block_archive {
+
+    /** How blocks are laid out in the files of an archive. */
+    enum class ArchiveFormat {
+      // Concatenated RLP blocks.
+      Rlp,
+      // Each block is preceded by its size as a 4-byte little-endian integer.
+      LengthPrefixed
+    };
+
+    /** A memory-mapped archive of blocks, read one block at a time. */
+    class BlockArchive {
+    public:
+      /**
+       * @brief Maps the archive at `path`.
+       *
+       * @param path A file, or a directory whose regular files are read in name order.
+       * @param format How blocks are laid out in each file.
+       * @throws std::system_error if a file can't be opened or mapped.
+       */
+      explicit BlockArchive(const std::filesystem::path& path,
+                            ArchiveFormat format = ArchiveFormat::Rlp);
+
+      /**
+       * @brief Reads the next block.
+       *
+       * @note Not thread-safe. Blocks refer into the mapped files and live as long as the archive.
+       *
+       * @return The encoded block, or `std::nullopt` after the last one.
+       * @throws std::invalid_argument if a file doesn't split into whole blocks.
+       */
+      [[nodiscard]] std::optional<std::span<const uint8_t>> next();
+
+      /** @brief Starts reading from the first block again. */
+      void rewind() noexcept;
+
+      /** @return The number of mapped files. */
+      [[nodiscard]] size_t file_count() const noexcept;
+
+      /** @return The total size of the mapped files in bytes. */
+      [[nodiscard]] size_t size() const noexcept;
+
+    private:
+      std::vector<mapped_file::MappedFile> files;
+      ArchiveFormat format;
+      size_t file{0};
+      size_t offset{0};
+    };
+
+    /** Tuning knobs for `decode_archive`. */
+    struct ArchiveOptions {
+      // Number of decoder threads, or 0 to use one per hardware thread.
+      size_t threads{0};
+      // Number of blocks in flight between being read and being written, or 0 for 4 per thread.
+      // Bounds how far decoding may run ahead of a slow block.
+      size_t window{0};
+      // Index used to name selectors in the output, if any.
+      const signature_index::SignatureIndex* signatures{nullptr};
+      // Format the results are written in.
+      stream_decoder::OutputFormat format{stream_decoder::OutputFormat::Text};
+      // Limits on the work each decode may do. Calldata over budget is reported as an error.
+      calldata_decoder::DecodeOptions decode{};
+    };
+
+    /** Totals reported by `decode_archive`. */
+    struct ArchiveStats {
+      size_t blocks{0};
+      // Blocks that aren't well-formed, whose transactions are left out of the output.
+      size_t malformed_blocks{0};
+      size_t transactions{0};
+      size_t decoded{0};
+      // Contract creations and transactions without a selector's worth of calldata.
+      size_t skipped{0};
+      size_t bytes{0};
+    };
+
+    /**
+     * @brief Decodes the calldata of every transaction in `archive` and writes the results to
+     * `out` in block and transaction order.
+     *
+     * Each block is a task on a work-stealing pool that splits, decodes and formats its
+     * transactions, while the calling thread reads blocks ahead and writes finished ones through a
+     * reorder buffer of `window` blocks, so output order costs no parallelism.
+     *
+     * Text lines are named `<block>:<position>`, and NDJSON objects carry `block` and `index`
+     * fields, where `<block>` is the number in the block header and `<position>` the transaction's
+     * place in its block. Columnar rows are indexed by the transaction's place in the archive.
+     * Transactions that fail to decode are written as errors; skipped ones aren't written.
+     *
+     * @param archive The archive, read from its next block on.
+     * @param out The stream results are written to, opened in binary mode for columnar output.
+     * @param options Tuning knobs for the decode.
+     * @return Totals over the whole archive.
+     * @throws std::invalid_argument if the archive doesn't split into blocks.
+     * @throws std::runtime_error if writing columnar output fails.
+     */
+    ArchiveStats decode_archive(BlockArchive& archive, std::ostream& out,
+                                const ArchiveOptions& options = {});
+
+  }  // namespace block_archive
+}  // namespace evmtools
@@ -1,17 +1,141 @@
 #pragma once
 
+#include <evmtools/hex.h>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <intx/intx.hpp>
 #include <iostream>
-#include <map>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <vector>
 
 namespace evmtools {
+  /**
+   * @brief Heuristic decoding of EVM calldata.
+   *
+   * Thread safety: the library keeps no mutable global state, so every free function may be called
+   * concurrently. Distinct Calldata objects may be constructed and modified on different threads,
+   * and a Calldata that is no longer being modified may be read from any number of threads.
+   */
   namespace calldata_decoder {
 
+    /** Size in bytes of a single ABI word. */
+    constexpr size_t WORD_SIZE{32};
+
+    /** Size in bytes of a method selector. */
+    constexpr size_t SELECTOR_SIZE{4};
+
+    /**
+     * @brief Converts a single hex character into its 4-bit value.
+     *
+     * @param c The hex character, upper or lower case.
+     * @return The value of the nibble, or 0 if `c` is not a hex character.
+     */
+    [[nodiscard]] constexpr uint8_t nibble_from_hex(const char c) noexcept {
+      if (c >= '0' && c <= '9') return static_cast<uint8_t>(c - '0');
+      if (c >= 'a' && c <= 'f') return static_cast<uint8_t>(c - 'a' + 10);
+      if (c >= 'A' && c <= 'F') return static_cast<uint8_t>(c - 'A' + 10);
+      return 0;
+    }
+
+    /**
+     * @brief A 32-byte ABI word stored as raw big-endian bytes.
+     *
+     * The decoder keeps every word in this form and only produces hex when output is formatted.
+     */
+    struct Word {
+      std::array<uint8_t, WORD_SIZE> bytes{};
+
+      /**
+       * @brief Creates a word from up to 64 hex characters (without a `0x` prefix).
+       *
+       * @note Shorter input fills the word from the left and leaves the remaining bytes zeroed,
+       * matching how the ABI pads trailing data.
+       *
+       * @param hex The hex characters to be converted.
+       * @return The word representation of the hex characters.
+       */
+      [[nodiscard]] static constexpr Word from_hex(const std::string_view hex) noexcept {
+        Word word{};
+        for (size_t i = 0; i < WORD_SIZE && i * 2 + 1 < hex.size(); i++) {
+          word.bytes[i] = static_cast<uint8_t>(nibble_from_hex(hex[i * 2]) << 4
+                                               | nibble_from_hex(hex[i * 2 + 1]));
+        }
+        return word;
+      }
+
+      /**
+       * @brief Creates a word from up to 32 bytes, zero-padding the right if fewer are given.
+       *
+       * @param data The bytes to be copied.
+       * @return The word holding the bytes.
+       */
+      [[nodiscard]] static Word from_bytes(std::span<const uint8_t> data) noexcept;
+
+      /** @return The 64-character lower case hex representation of the word. */
+      [[nodiscard]] std::string to_hex() const;
+
+      /** @return The word interpreted as a big-endian unsigned integer. */
+      [[nodiscard]] intx::uint256 to_uint() const noexcept {
+        return intx::be::unsafe::load<intx::uint256>(this->bytes.data());
+      }
+
+      /** @return Whether every byte of the word is zero. */
+      [[nodiscard]] constexpr bool is_zero() const noexcept {
+        for (auto byte : this->bytes) {
+          if (byte != 0) return false;
+        }
+        return true;
+      }
+
+      /** @return The number of leading '0' characters in the hex representation of the word. */
+      [[nodiscard]] constexpr size_t leading_zero_nibbles() const noexcept {
+        for (size_t i = 0; i < WORD_SIZE; i++) {
+          if (this->bytes[i] != 0) {
+            return i * 2 + (this->bytes[i] < 0x10 ? 1 : 0);
+          }
+        }
+        return WORD_SIZE * 2;
+      }
+
+      constexpr bool operator==(const Word& other) const = default;
+    };
+
+    /**
+     * @brief A 4-byte method selector, stored as a big-endian integer (e.g. `0xa9059cbb`).
+     */
+    struct Selector {
+      uint32_t value{0};
+
+      /**
+       * @brief Reads a selector from the first 4 bytes pointed to by `data`.
+       *
+       * @param data Pointer to at least 4 bytes.
+       * @return The selector.
+       */
+      [[nodiscard]] static constexpr Selector from_bytes(const uint8_t* data) noexcept {
+        return Selector{uint32_t{data[0]} << 24 | uint32_t{data[1]} << 16 | uint32_t{data[2]} << 8
+                        | uint32_t{data[3]}};
+      }
+
+      /** @return The 8-character lower case hex representation of the selector. */
+      [[nodiscard]] std::string to_hex() const;
+
+      constexpr bool operator==(const Selector& other) const = default;
+    };
+
     /** Hex string constants for masking and decoding parameters */
     namespace constants {
       constexpr std::string_view MASK_4{"FFFFFFFF"};
@@ -29,6 +153,17 @@ namespace evmtools {
 
       constexpr std::string_view MAX_U128{
           "00000000000000000000000000000000ffffffffffffffffffffffffffffffff"};
+
+      // Binary forms of the constants above, used by the decoder for its comparisons.
+      constexpr Selector EMPTY_4_SELECTOR{0x00000000};
+
+      constexpr Selector MASK_4_SELECTOR{0xffffffff};
+
+      constexpr Word EMPTY_32_WORD{Word::from_hex(EMPTY_32)};
+
+      constexpr Word MAX_U256_WORD{Word::from_hex(MAX_U256)};
+
+      constexpr Word MAX_U128_WORD{Word::from_hex(MAX_U128)};
     }  // namespace constants
 
     /** Possible types for decoded params */
@@ -50,59 +185,253 @@ namespace evmtools {
       MaxUint128
     };
 
+    /**
+     * @brief A set of candidate types for a param, stored as a bitmask over Types.
+     *
+     * @note Iteration yields the types in the order they're declared in Types.
+     */
     struct ParamTypes {
-      std::vector<Types> types;
+      uint16_t mask{0};
+
+      /** Iterates over the types in a set, lowest bit first. */
+      class iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Types;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Types;
+
+        constexpr iterator() noexcept = default;
+        constexpr explicit iterator(const uint16_t remaining) noexcept : remaining(remaining) {}
+
+        constexpr Types operator*() const noexcept {
+          return static_cast<Types>(std::countr_zero(this->remaining));
+        }
+
+        constexpr iterator& operator++() noexcept {
+          this->remaining = static_cast<uint16_t>(this->remaining & (this->remaining - 1));
+          return *this;
+        }
+
+        constexpr iterator operator++(int) noexcept {
+          auto previous{*this};
+          ++*this;
+          return previous;
+        }
+
+        constexpr bool operator==(const iterator& other) const = default;
+
+      private:
+        uint16_t remaining{0};
+      };
+
+      constexpr ParamTypes() noexcept = default;
+
+      constexpr ParamTypes(const std::initializer_list<Types> types) noexcept {
+        for (auto type : types) this->insert(type);
+      }
+
+      explicit ParamTypes(const std::vector<Types>& types) noexcept {
+        for (auto type : types) this->insert(type);
+      }
+
+      /** @return The bit of `type` in the mask. */
+      [[nodiscard]] static constexpr uint16_t bit(const Types type) noexcept {
+        return static_cast<uint16_t>(1u << static_cast<unsigned>(type));
+      }
+
+      constexpr void insert(const Types type) noexcept { this->mask |= bit(type); }
+
+      [[nodiscard]] constexpr bool contains(const Types type) const noexcept {
+        return (this->mask & bit(type)) != 0;
+      }
 
-      ParamTypes(std::vector<Types> types);
+      [[nodiscard]] constexpr bool empty() const noexcept { return this->mask == 0; }
 
-      ParamTypes(std::initializer_list<Types> types);
+      [[nodiscard]] constexpr size_t size() const noexcept {
+        return static_cast<size_t>(std::popcount(this->mask));
+      }
 
-      ParamTypes();
+      [[nodiscard]] constexpr iterator begin() const noexcept { return iterator{this->mask}; }
+      [[nodiscard]] constexpr iterator end() const noexcept { return iterator{}; }
 
-      // implement copy and move constructors
-      ParamTypes(const ParamTypes& other);
-      ParamTypes(ParamTypes&& other);
+      constexpr bool operator==(const ParamTypes& other) const = default;
+    };
 
-      // implement copy and move assignment operators
-      ParamTypes& operator=(const ParamTypes& other);
-      ParamTypes& operator=(ParamTypes&& other);
+    static_assert(static_cast<unsigned>(Types::MaxUint128) < 16, "Types must fit in ParamTypes");
 
-      // implement destructor
-      ~ParamTypes();
+    /**
+     * @brief Decoded params laid out as parallel columns, for scanning many results at once.
+     *
+     * @note Entry `i` of every column describes the same param. The columns refer into the Params
+     * or Calldata they came from.
+     */
+    struct ParamColumns {
+      std::span<const Word> words;
+      // Byte offset of each word into the decoded calldata.
+      std::span<const uint32_t> offsets;
+      std::span<const ParamTypes> types;
     };
 
-    struct Params {
-      std::string selector;
-      std::vector<std::string> params;
-      std::vector<ParamTypes> param_types;
+    /**
+     * @brief The allocator every container of a decode draws from.
+     *
+     * Defaults to `std::pmr::get_default_resource()`, i.e. the global heap.
+     */
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    /** Marks a call that isn't nested in another nested call. */
+    constexpr uint32_t NO_PARENT{std::numeric_limits<uint32_t>::max()};
 
-      Params(const std::string_view selector, std::vector<std::string> params);
+    /**
+     * @brief Limits on how much work a decode may do, so crafted calldata can't stall a decoder or
+     * exhaust its memory.
+     *
+     * Decodes past the depth or nested call limits still succeed, with the rest of the call tree
+     * left undecoded. Decodes that need more steps or memory than allowed fail instead.
+     *
+     * The step and memory budgets of a decode are the smaller of their `max_` limit and their
+     * `_per_byte` allowance times the size of the calldata (at least MIN_BUDGET_BYTES), so the
+     * defaults bound every decode to a constant factor of its input. They cover any calldata
+     * nested up to the default `max_depth`; raise them along with `max_depth`.
+     */
+    struct DecodeOptions {
+      // Deepest nesting of calls to decode, with the main call at depth 0. Deeper calls are left
+      // undecoded.
+      size_t max_depth{64};
+      // Most nested calls to decode. Calls found after the limit is reached are left undecoded.
+      size_t max_nested_calls{SIZE_MAX};
+      // Most units of work, each about one word scanned, copied or classified.
+      size_t max_steps{SIZE_MAX};
+      // Most bytes of decoded data (bytes, words, offsets and types) held by the result and the
+      // decode's scratch space, not counting container overhead.
+      size_t max_memory{SIZE_MAX};
+      // Steps allowed for each byte of calldata.
+      size_t steps_per_byte{8};
+      // Bytes of decoded data allowed for each byte of calldata.
+      size_t memory_per_byte{128};
+    };
+
+    /** Calldata shorter than this gets the step and memory budgets of calldata this long. */
+    constexpr size_t MIN_BUDGET_BYTES{1024};
+
+    /** @brief Thrown when a decode needs more steps or memory than its DecodeOptions allow. */
+    class BudgetExceeded : public std::runtime_error {
+    public:
+      using std::runtime_error::runtime_error;
+    };
+
+    struct Params {
+      using allocator_type = calldata_decoder::allocator_type;
+
+      Selector selector;
+      std::pmr::vector<Word> params;
+      // Byte offset into the decoded calldata of each param.
+      std::pmr::vector<uint32_t> offsets;
+      std::pmr::vector<ParamTypes> param_types;
+      // The encoded call (selector followed by params), referring into the decoded calldata.
+      std::span<const uint8_t> data;
+      // Index into `Calldata::nested_details` of the nested call whose params hold this call, or
+      // NO_PARENT if it is the main call or held directly by the main call's params.
+      uint32_t parent{NO_PARENT};
+      // Number of calls this call is nested in; 0 for the main call.
+      uint32_t depth{0};
+
+      Params(const Selector selector, std::span<const Word> params, allocator_type alloc = {});
 
       // declaration of default constructor, copy constructor, move constructor,
       // copy assignment operator, move assignment operator and destructor
       Params();
       Params(const Params& other);
-      Params(Params&& other);
+      Params(Params&& other) noexcept;
       Params& operator=(const Params& other);
       Params& operator=(Params&& other);
       ~Params();
+
+      // Allocator-extended constructors, so containers of Params pass their allocator on.
+      explicit Params(allocator_type alloc);
+      Params(const Params& other, allocator_type alloc);
+      Params(Params&& other, allocator_type alloc);
+
+      [[nodiscard]] allocator_type get_allocator() const noexcept;
+
+      /** @return The params, their offsets and their types as parallel columns. */
+      [[nodiscard]] ParamColumns columns() const noexcept;
     };
 
     struct Calldata {
-      // Raw calldata being assesed.
-      std::string calldata;
+      using allocator_type = calldata_decoder::allocator_type;
+
+      // Raw calldata bytes owned by this object, only used when decoding from hex.
+      std::pmr::vector<uint8_t> storage;
+      // Raw calldata being assesed; refers into `storage` or into the caller's buffer.
+      std::span<const uint8_t> calldata;
       // Method selector being targeted.
-      std::string selector;
+      Selector selector;
       // Param types for our method.
       Params main_details;
       // The params found after selector is sliced out.
-      std::vector<std::string> raw_params;
-      std::vector<std::string> params;
-      // Method calls extending from our method.
+      std::pmr::vector<Word> raw_params;
+      std::pmr::vector<Word> params;
+      // Method calls extending from our method, at any depth, as a tree in a flat array: every
+      // call comes after its parent, and calls at the same depth are in calldata order.
       // Includes potential types guessed.
-      std::vector<Params> nested_details;
+      std::pmr::vector<Params> nested_details;
+      // Whether a limit of the DecodeOptions left some nested calls undecoded.
+      bool truncated{false};
+
+      /**
+       * @brief Decodes hex calldata, with or without a `0x` prefix.
+       *
+       * @throws std::invalid_argument if the hex string has an odd number of characters or contains
+       * an invalid character.
+       * @param calldata The hex string to be decoded.
+       * @param alloc Allocator for every container of the decode, including scratch space.
+       * @throws std::out_of_range if the calldata is shorter than a method selector.
+       */
+      Calldata(const std::string_view calldata, allocator_type alloc = {});
+
+      /**
+       * @brief Decodes hex calldata within the limits of `options`.
+       *
+       * @throws std::invalid_argument if the hex string has an odd number of characters or contains
+       * an invalid character.
+       * @throws std::out_of_range if the calldata is shorter than a method selector.
+       * @throws BudgetExceeded if the decode needs more steps or memory than `options` allow.
+       */
+      Calldata(const std::string_view calldata, const DecodeOptions& options,
+               allocator_type alloc = {});
 
-      Calldata(const std::string_view calldata);
+      /**
+       * @brief Decodes raw calldata bytes without copying them.
+       *
+       * @note `calldata` and the `data` of every decoded Params refer into the given buffer, which
+       * must outlive this object.
+       *
+       * @param calldata The bytes to be decoded.
+       * @param alloc Allocator for every container of the decode, including scratch space.
+       * @throws std::out_of_range if the calldata is shorter than a method selector.
+       */
+      Calldata(std::span<const uint8_t> calldata, allocator_type alloc = {});
+      Calldata(std::span<const std::byte> calldata, allocator_type alloc = {});
+
+      /**
+       * @brief Decodes raw calldata bytes without copying them, within the limits of `options`.
+       *
+       * @throws std::out_of_range if the calldata is shorter than a method selector.
+       * @throws BudgetExceeded if the decode needs more steps or memory than `options` allow.
+       */
+      Calldata(std::span<const uint8_t> calldata, const DecodeOptions& options,
+               allocator_type alloc = {});
+
+      // Copies re-point their views into their own `storage` when decoding from hex. Like other
+      // std::pmr containers, copies use the default memory resource.
+      Calldata(const Calldata& other);
+      Calldata(Calldata&& other) noexcept;
+      Calldata& operator=(const Calldata& other);
+      Calldata& operator=(Calldata&& other);
+      ~Calldata();
 
       /**
        * @brief Parses the method selector the calldata is being sent to and prepares the raw
@@ -112,8 +441,20 @@ namespace evmtools {
 
       /**
        * @brief Parses the raw calldata params for each param and for any new method selectors.
+       *
+       * Offsets in the ABI heads are followed to their length words in a single pass. Tails that
+       * hold a selector followed by whole words are decoded as nested calls (and their own heads
+       * followed in turn), and other tails as possible arrays of heads. Each word is visited at
+       * most once, and nested calls that would overlap another call found in the same call are
+       * skipped, so each byte is copied at most once per level of nesting. Decoding is linear in
+       * the size of the calldata for a given `max_depth`.
+       *
+       * The offset graph is walked with an explicit work list rather than by recursion, so deep
+       * call trees can't overflow the stack, and each nested call records its parent and depth.
+       *
+       * @param options Limits on the depth and number of nested calls decoded.
        */
-      void parse_raw_params();
+      void parse_raw_params(const DecodeOptions& options = {});
 
       /**
        * @brief Gets the potential types for all the calldata params.
@@ -122,90 +463,178 @@ namespace evmtools {
       void get_param_types();
 
       /**
-       * @brief Parses the length of data in the `params_64` vector of strings, starting from index
-       * `from` and for a length of `len`.
+       * @return The params of the main method, their offsets and their types as parallel columns.
+       */
+      [[nodiscard]] ParamColumns columns() const noexcept;
+
+      [[nodiscard]] allocator_type get_allocator() const noexcept;
+
+      /**
+       * @brief Parses the length of data in the calldata, starting from byte `offset` and for a
+       * length of `len` bytes.
        *
-       * @param params_64 Vector of strings representing the data to be parsed.
-       * @param from Index of `params_64` vector to start parsing from.
-       * @param len Length of data to parse.
-       * @return An optional size_t that contains the length of parsed data, or `std::nullopt` if
+       * @param offset Byte offset into `calldata` to start parsing from.
+       * @param len Length of data to parse, in bytes.
+       * @return An optional size_t that contains the number of words to skip, or `std::nullopt` if
        * nothing was parsed and no params were recorded.
        */
-      std::optional<size_t> parse_len(const std::vector<std::string>& params_64, size_t from,
-                                      size_t len);
+      std::optional<size_t> parse_len(size_t offset, size_t len);
+
+    private:
+      /**
+       * @brief Points every view that referred into a copy of `storage` at `old_base` into our own
+       * `storage` instead.
+       */
+      void rebase_views(const uint8_t* old_base);
+
+      // What is left of the step and memory budgets of the DecodeOptions.
+      size_t steps_left{SIZE_MAX};
+      size_t memory_left{SIZE_MAX};
+
+      /**
+       * @brief Spends part of the budget.
+       *
+       * @throws BudgetExceeded if there isn't enough left.
+       */
+      void charge(size_t steps, size_t bytes);
+    };
+
+    /** Outcomes of `try_decode`. */
+    enum class DecodeStatus : uint8_t {
+      Ok,
+      // The input isn't valid calldata, e.g. bad hex or shorter than a selector.
+      Malformed,
+      // Decoding needed more steps or memory than allowed.
+      BudgetExceeded
     };
 
     /**
-     * @brief Converts a calldata string into chunks of a given size.
-     *
-     * @param calldata The calldata string to be converted.
-     * @param chunk_size The size of each chunk.
-     * @return A vector of strings containing the chunks.
+     * @param status DecodeStatus enum value.
+     * @return The name of the status, e.g. "budget_exceeded".
      */
-    std::vector<std::string> split_calldata(const std::string_view calldata, size_t chunk_size);
+    [[nodiscard]] constexpr std::string_view status_name(const DecodeStatus status) noexcept {
+      switch (status) {
+        case DecodeStatus::Ok:
+          return "ok";
+        case DecodeStatus::Malformed:
+          return "malformed";
+        case DecodeStatus::BudgetExceeded:
+          return "budget_exceeded";
+      }
+      return "unknown";
+    }
+
+    /** The result of `try_decode`. */
+    struct DecodeResult {
+      DecodeStatus status{DecodeStatus::Ok};
+      // The decoded calldata, only if `status` is Ok.
+      std::optional<Calldata> calldata;
+
+      [[nodiscard]] explicit operator bool() const noexcept {
+        return this->status == DecodeStatus::Ok;
+      }
+    };
 
     /**
-     * @brief Adds padding of 4 '0s' to the left of a chunk in a vector of strings (chunks) of the
-     * same size.
+     * @brief Decodes hex calldata within the budgets of `options`, without throwing.
      *
-     * @param chunks The vector of strings in which a chunk will be padded.
-     * @param chunk_index The index of the chunk to be padded.
-     * @return A vector of strings containing the padded chunk.
+     * @note Running out of memory counts as exceeding the budget.
+     *
+     * @param calldata The hex string to be decoded, with or without a `0x` prefix.
+     * @param options Limits on the work the decode may do.
+     * @param alloc Allocator for every container of the decode.
+     * @return The decoded calldata, or why it couldn't be decoded.
      */
-    std::vector<std::string> pad_chunk_left(std::vector<std::string> chunks, size_t chunk_index);
+    [[nodiscard]] DecodeResult try_decode(std::string_view calldata,
+                                          const DecodeOptions& options = {},
+                                          allocator_type alloc = {}) noexcept;
 
-    using SelectorAndCalldata = std::tuple<std::string, std::string>;
+    /**
+     * @brief Decodes raw calldata bytes within the budgets of `options`, without throwing.
+     *
+     * @note The result refers into `calldata`, which must outlive it.
+     */
+    [[nodiscard]] DecodeResult try_decode(std::span<const uint8_t> calldata,
+                                          const DecodeOptions& options = {},
+                                          allocator_type alloc = {}) noexcept;
 
     /**
-     * @brief Parses the selector from the calldata string.
+     * @brief A reusable arena for decoding one Calldata at a time off the global heap.
+     *
+     * Workers keep one arena (e.g. per thread), decode each transaction with `allocator()`, and
+     * call `reset()` once they are done with the result. Reset is O(1) for decodes that fit in the
+     * initial buffer, and the buffer is reused, so those decodes never touch the global heap.
+     * Larger decodes spill over to `std::pmr::new_delete_resource()` until the next reset.
      *
-     * @param calldata The calldata string to be parsed.
-     * @return A tuple containing the selector (if found) and the calldata string without the
-     * selector. If the selector is not found, the selector string will be empty bytes (EMPTY_4) and
-     * the calldata string will be the same as the input.
+     * @note Not thread-safe; use one arena per thread.
      */
-    SelectorAndCalldata try_parse_selector(const std::string_view calldata);
+    class DecodeArena {
+    public:
+      /** Default size of the initial buffer, enough for most calldata. */
+      static constexpr size_t DEFAULT_SIZE{64 * 1024};
+
+      /**
+       * @param size Size of the initial buffer in bytes.
+       */
+      explicit DecodeArena(size_t size = DEFAULT_SIZE);
+
+      DecodeArena(const DecodeArena& other) = delete;
+      DecodeArena& operator=(const DecodeArena& other) = delete;
+      DecodeArena(DecodeArena&& other) = delete;
+      DecodeArena& operator=(DecodeArena&& other) = delete;
+      ~DecodeArena();
+
+      /** @return The allocator to decode with. */
+      [[nodiscard]] allocator_type allocator() noexcept;
+
+      /**
+       * @brief Releases everything allocated since the last reset.
+       *
+       * @note Every Calldata decoded with the arena since the last reset must no longer be used.
+       */
+      void reset() noexcept;
 
-    using ChunksAndCalldata = std::tuple<std::vector<std::string>, std::string>;
+    private:
+      std::unique_ptr<std::byte[]> buffer;
+      std::pmr::monotonic_buffer_resource resource;
+    };
 
     /**
-     * @brief Replaces a chunk in a vector of strings (chunks) with a replacement string and moves
-     * constants::EMPTY_4 to the end of the vector.
+     * @brief Decodes a hex string, with or without a `0x` prefix, into raw bytes.
      *
-     * @param chunks The vector of strings in which a chunk will be replaced.
-     * @param chunk_index The index of the chunk to be replaced.
-     * @param replacement The string to replace the chunk.
-     * @return A tuple containing the vector of strings with the replaced chunk and the new
-     * concatenated calldata string.
+     * @param hex The hex string to be decoded.
+     * @return The decoded bytes.
+     * @throws std::invalid_argument if the hex string has an odd number of characters or contains
+     * an invalid character.
      */
-    ChunksAndCalldata rearrange_chunks(std::vector<std::string> chunks, size_t chunk_index,
-                                       const std::string_view replacement);
+    std::vector<uint8_t> bytes_from_hex(std::string_view hex);
 
     /**
-     * @brief Returns the previous chunk in a vector of strings (chunks), if any.
+     * @brief Converts calldata bytes into 32-byte words.
+     *
+     * @note A trailing partial word is zero-padded on the right.
      *
-     * @param chunks The vector of strings.
-     * @param chunk_index The index of the chunk to get the previous chunk from.
-     * @return An optional string containing the previous chunk, if any.
+     * @param calldata The calldata bytes to be converted.
+     * @return A vector containing the words.
      */
-    std::optional<std::string> previous_chunk(std::vector<std::string> chunks, size_t chunk_index);
+    std::vector<Word> split_calldata(std::span<const uint8_t> calldata);
 
     /**
-     * @brief Returns the next chunk in a vector of strings (chunks), if any.
+     * @brief Parses the selector from the start of a word.
      *
-     * @param chunks The vector of strings.
-     * @param chunk_index The index of the chunk to get the next chunk from.
-     * @return An optional string containing the next chunk, if any.
+     * @param word The word to be parsed.
+     * @return The selector, if the word starts with 4 non-empty bytes that aren't constants::MASK_4
+     * followed by 4 empty bytes (constants::EMPTY_4).
      */
-    std::optional<std::string> next_chunk(std::vector<std::string> chunks, size_t chunk_index);
+    std::optional<Selector> try_parse_selector(const Word& word);
 
     /**
      * @brief Gets all the potential types of a parameter by checking specific patterns.
      *
-     * @param param 32-byte string representation of a parameter.
+     * @param param 32-byte word representation of a parameter.
      * @return All the potential types of the parameter.
      */
-    ParamTypes get_param_type(const std::string_view param);
+    ParamTypes get_param_type(const Word& param);
 
     /**
      * @brief Concept for checking if an unsigned integer is a valid bit size for an intx::uint.
@@ -222,96 +651,105 @@ namespace evmtools {
      * @brief Converts a 32-byte hex string to a intx::uint.
      *
      * @note Ethereum uses the big-endian byte order for integers in calldata, so the bytes must
-     * also be ordered as big-endian (most significant byte first/on the left).
+     * also be ordered as big-endian (most significant byte first/on the left). Hex strings shorter
+     * than N / 4 characters fill the integer from the left and leave the remaining bytes zeroed.
      *
      * @tparam N The bit size of the intx::uint to be returned.
      * @param hex_str The 32-byte hex string to be converted.
      * @return The intx::uint representation of the hex string.
+     * @throws std::invalid_argument if the hex string contains an invalid character.
      */
     template <unsigned N>
       requires BitSize<N>
-    [[nodiscard]] inline intx::uint<N> uint_from_hex_str(const std::string_view hex_str) noexcept {
-      std::vector<uint8_t> byte_vec;
+    [[nodiscard]] inline intx::uint<N> uint_from_hex_str(const std::string_view hex_str) {
+      std::array<uint8_t, N / 8> bytes{};
 
-      for (unsigned int i = 0; i < hex_str.length(); i += 2) {
-        std::string_view byte_str = hex_str.substr(i, 2);
-        byte_vec.push_back((uint8_t)strtoul(std::string{byte_str}.data(), nullptr, 16));
+      if (auto invalid = hex::decode(hex_str, bytes)) {
+        throw std::invalid_argument("invalid hex character at index " + std::to_string(*invalid));
       }
 
-      return intx::be::unsafe::load<intx::uint<N>>(byte_vec.data());
+      return intx::be::unsafe::load<intx::uint<N>>(bytes.data());
     }
 
     /**
-     * @brief Joins a vector of strings into a single string.
+     * @brief Gets the name of a Types enum value.
      *
-     * @param strings The vector of strings to be joined.
-     * @return The joined string.
+     * @param value Types enum value
+     * @return The name of the value, e.g. "Types::Address".
      */
-    [[nodiscard]] inline std::string join_strings(std::vector<std::string> strings) noexcept {
-      std::string result{""};
-      size_t total_size{0};
-
-      for (const auto& str : strings) {
-        total_size += str.size();
+    [[nodiscard]] constexpr std::string_view type_name(const Types value) noexcept {
+      switch (value) {
+#define TYPE_NAME(p) \
+  case p:            \
+    return #p
+        TYPE_NAME(Types::AnyZero);
+        TYPE_NAME(Types::AnyMax);
+        TYPE_NAME(Types::Uint);
+        TYPE_NAME(Types::Int);
+        TYPE_NAME(Types::Bytes);
+        TYPE_NAME(Types::Bool);
+        TYPE_NAME(Types::Uint8);
+        TYPE_NAME(Types::Bytes1);
+        TYPE_NAME(Types::Bytes20);
+        TYPE_NAME(Types::Address);
+        TYPE_NAME(Types::Selector);
+        TYPE_NAME(Types::String);
+        TYPE_NAME(Types::Address0);
+        TYPE_NAME(Types::ZeroUint);
+        TYPE_NAME(Types::MaxUint128);
+#undef TYPE_NAME
       }
 
-      result.reserve(total_size);
-
-      for (const auto& str : strings) {
-        result += str;
-      }
-
-      return result;
+      return "";
     }
 
     /**
-     * @brief Trims leading zeroes from a string.
+     * @brief Converts Types enum values to strings
      *
-     * @param str The string to be trimmed.
-     * @return The trimmed string.
+     * @param out std::ostream& to write to
+     * @param value Types enum value
+     * @return std::ostream& to allow chaining
      */
-    [[nodiscard]] inline std::string trim_zeroes(const std::string_view str) noexcept {
-      auto trimmed{std::string{str}};
-
-      size_t pos{str.find_first_not_of("0")};
+    [[nodiscard]] inline std::ostream& operator<<(std::ostream& out, const Types value) noexcept {
+      return out << type_name(value);
+    }
 
-      if (pos != std::string::npos) {
-        trimmed.erase(0, pos);
+    /**
+     * @brief Writes the names of a set of types, separated by `|`.
+     *
+     * @param out std::ostream& to write to
+     * @param types ParamTypes to be written
+     * @return std::ostream& to allow chaining
+     */
+    inline std::ostream& operator<<(std::ostream& out, const ParamTypes types) {
+      const char* separator{""};
+      for (auto type : types) {
+        out << separator << type_name(type);
+        separator = "|";
       }
-
-      return trimmed;
+      return out;
     }
 
     /**
-     * @brief Converts Types enum values to strings
+     * @brief Writes the hex representation of a word.
      *
      * @param out std::ostream& to write to
-     * @param value Types enum value
+     * @param word Word to be written
      * @return std::ostream& to allow chaining
      */
-    [[nodiscard]] inline std::ostream& operator<<(std::ostream& out, const Types value) noexcept {
-      static std::map<Types, std::string> strings;
-      if (strings.size() == 0) {
-#define INSERT_ELEMENT(p) strings[p] = #p
-        INSERT_ELEMENT(Types::AnyZero);
-        INSERT_ELEMENT(Types::AnyMax);
-        INSERT_ELEMENT(Types::Uint);
-        INSERT_ELEMENT(Types::Int);
-        INSERT_ELEMENT(Types::Bytes);
-        INSERT_ELEMENT(Types::Bool);
-        INSERT_ELEMENT(Types::Uint8);
-        INSERT_ELEMENT(Types::Bytes1);
-        INSERT_ELEMENT(Types::Bytes20);
-        INSERT_ELEMENT(Types::Address);
-        INSERT_ELEMENT(Types::Selector);
-        INSERT_ELEMENT(Types::String);
-        INSERT_ELEMENT(Types::Address0);
-        INSERT_ELEMENT(Types::ZeroUint);
-        INSERT_ELEMENT(Types::MaxUint128);
-#undef INSERT_ELEMENT
-      }
+    inline std::ostream& operator<<(std::ostream& out, const Word& word) {
+      return out << word.to_hex();
+    }
 
-      return out << strings[value];
+    /**
+     * @brief Writes the hex representation of a selector.
+     *
+     * @param out std::ostream& to write to
+     * @param selector Selector to be written
+     * @return std::ostream& to allow chaining
+     */
+    inline std::ostream& operator<<(std::ostream& out, const Selector selector) {
+      return out << selector.to_hex();
     }
 
   }  // namespace calldata_decoder
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace evmtools {
+  namespace calldata_decoder {
+
+    /**
+     * @brief A lazy view of raw calldata bytes.
+     *
+     * Constructing a view only reads the selector. Words are read from the calldata when asked
+     * for, and type candidates and the full decode (nested calls) are computed on first access and
+     * memoized, so filtering many inputs by selector costs one 4-byte read each.
+     *
+     * @note The calldata must outlive the view. Since first accesses fill the memo, a view must not
+     * be accessed from several threads at once.
+     */
+    class CalldataView {
+    public:
+      /**
+       * @param calldata The raw calldata bytes. Any size is accepted; calldata shorter than a
+       * method selector simply has none.
+       * @param alloc Allocator for the memoized types and decode.
+       */
+      explicit CalldataView(std::span<const uint8_t> calldata, allocator_type alloc = {}) noexcept;
+      explicit CalldataView(std::span<const std::byte> calldata,
+                            allocator_type alloc = {}) noexcept;
+
+      /** @return The method selector, or `std::nullopt` if the calldata is shorter than one. */
+      [[nodiscard]] std::optional<Selector> selector() const noexcept;
+
+      /** @return The raw calldata bytes. */
+      [[nodiscard]] std::span<const uint8_t> bytes() const noexcept;
+
+      /** @return The number of params of the main method, as in `Calldata::params`. */
+      [[nodiscard]] size_t size() const noexcept;
+
+      /**
+       * @brief Reads a param of the main method from the calldata.
+       *
+       * @param index The index of the param, below `size()`.
+       * @return The param, equal to `Calldata::params[index]`.
+       * @throws std::out_of_range if `index` is out of range.
+       */
+      [[nodiscard]] Word word(size_t index) const;
+
+      /**
+       * @brief Gets the potential types of a param of the main method, computing them on first
+       * access.
+       *
+       * @param index The index of the param, below `size()`.
+       * @return The potential types of the param.
+       * @throws std::out_of_range if `index` is out of range.
+       */
+      [[nodiscard]] ParamTypes types(size_t index) const;
+
+      /**
+       * @brief Fully decodes the calldata on first access.
+       *
+       * @return The decoded calldata, referring into the viewed bytes.
+       * @throws std::out_of_range if the calldata is shorter than a method selector.
+       */
+      [[nodiscard]] const Calldata& decoded() const;
+
+      /**
+       * @return The method calls extending from the main method, decoding the calldata on first
+       * access.
+       * @throws std::out_of_range if the calldata is shorter than a method selector.
+       */
+      [[nodiscard]] std::span<const Params> nested() const;
+
+      /** @return Whether the calldata has been fully decoded yet. */
+      [[nodiscard]] bool is_decoded() const noexcept;
+
+    private:
+      std::span<const uint8_t> calldata;
+      allocator_type alloc;
+
+      // Memoized types per param; an empty set means not computed yet.
+      mutable std::pmr::vector<ParamTypes> param_types;
+      mutable std::optional<Calldata> full;
+
+      /** @return The bytes of the param at `index`, as split by `Calldata::parse_selector`. */
+      [[nodiscard]] std::span<const uint8_t> word_bytes(size_t index) const;
+    };
+
+  }  // namespace calldata_decoder
+}  // namespace evmtools
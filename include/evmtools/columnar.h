@@ -0,0 +1,196 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/mapped_file.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief A columnar binary format for decoded calldata, written as a stream and read in place.
+   *
+   * A file is a header followed by any number of row groups, each holding the calls of a run of
+   * consecutive inputs. Every call (the main call of an input and each nested call) is a row of
+   * the call table, every word a row of the word table, and every nested call a row of the
+   * nested table. All integers are little-endian:
+   *
+   * - header: magic `EVMCOL\0\1`, then a u32 format version and 20 reserved bytes
+   * - row group header: u64 size of the whole group in bytes, u64 input count, then u32 call,
+   *   word and nested counts and 36 reserved bytes
+   * - call table: u64 input index, u32 selector and u32 end of the call's words, one per call
+   * - word table: the 32-byte words, then a u32 byte offset into the calldata and a u16 type mask
+   *   per word
+   * - nested table: u32 parent call and u32 child call, one per nested call
+   *
+   * Each column of a group is stored contiguously and starts 32-byte aligned, so the reader hands
+   * out spans straight into the memory-mapped file. A query that only reads one column only
+   * touches the pages of that column. Call indices (word ends, parents and children) are relative
+   * to their row group.
+   */
+  namespace columnar {
+    using calldata_decoder::Calldata;
+    using calldata_decoder::ParamColumns;
+    using calldata_decoder::ParamTypes;
+    using calldata_decoder::Selector;
+    using calldata_decoder::Word;
+
+    static_assert(sizeof(Selector) == 4 && sizeof(ParamTypes) == 2,
+                  "Columns must be readable in place");
+
+    /** Version of the format written by ColumnWriter. */
+    constexpr uint32_t FORMAT_VERSION{1};
+
+    /** One row group of a columnar file. Every span refers into the file. */
+    struct RowGroup {
+      // Number of inputs the group was written from, including inputs that failed to decode.
+      uint64_t inputs{0};
+
+      // Call table.
+      std::span<const uint64_t> call_inputs;
+      std::span<const Selector> selectors;
+      // Index into the word table of the end of each call's words; each call starts where the
+      // previous one ends.
+      std::span<const uint32_t> word_ends;
+
+      // Word table.
+      std::span<const Word> words;
+      std::span<const uint32_t> offsets;
+      std::span<const ParamTypes> types;
+
+      // Nested table.
+      std::span<const uint32_t> parents;
+      std::span<const uint32_t> children;
+
+      /**
+       * @param call Index of a call in the group.
+       * @return The words of the call, their offsets and their types as parallel columns.
+       */
+      [[nodiscard]] ParamColumns call_words(size_t call) const noexcept;
+    };
+
+    /**
+     * @brief Appends decoded calldata to a stream in the columnar format.
+     *
+     * Calls are buffered until a row group is full, then written out column by column, so memory
+     * stays bounded however long the stream is.
+     */
+    class ColumnWriter {
+    public:
+      /** Default number of words after which a row group is written. */
+      static constexpr size_t DEFAULT_GROUP_WORDS{1 << 16};
+
+      /**
+       * @brief Writes the file header to `out`.
+       *
+       * @param out The stream to be written to, opened in binary mode.
+       * @param group_words Number of words (or calls) after which a row group is written.
+       * @throws std::runtime_error if `out` fails or the host isn't little-endian.
+       */
+      explicit ColumnWriter(std::ostream& out, size_t group_words = DEFAULT_GROUP_WORDS);
+
+      ColumnWriter(const ColumnWriter& other) = delete;
+      ColumnWriter& operator=(const ColumnWriter& other) = delete;
+
+      /** @brief Writes any buffered calls. Errors are ignored; call `flush()` to see them. */
+      ~ColumnWriter();
+
+      /**
+       * @brief Appends the calls of one input.
+       *
+       * @param index The index of the input.
+       * @param calldata The decoded input, or nullptr if it failed to decode, in which case only
+       * the group's input count grows.
+       * @throws std::runtime_error if writing a full row group fails.
+       * @throws std::length_error if the calldata has more words than a row group can index.
+       */
+      void append(uint64_t index, const Calldata* calldata);
+
+      /** @brief Appends the calls of one input, like the overload above. */
+      void append(uint64_t index, const std::optional<Calldata>& calldata);
+
+      /**
+       * @brief Writes the buffered calls as a row group, if there are any, and flushes the stream.
+       *
+       * @throws std::runtime_error if writing fails.
+       */
+      void flush();
+
+    private:
+      std::ostream& out;
+      size_t group_words;
+
+      uint64_t inputs{0};
+      std::vector<uint64_t> call_inputs;
+      std::vector<Selector> selectors;
+      std::vector<uint32_t> word_ends;
+      std::vector<Word> words;
+      std::vector<uint32_t> offsets;
+      std::vector<ParamTypes> types;
+      std::vector<uint32_t> parents;
+      std::vector<uint32_t> children;
+
+      /** @brief Writes the buffered calls as a row group and clears the buffers. */
+      void write_group();
+    };
+
+    /**
+     * @brief A read-only columnar file, either memory-mapped or held in memory.
+     *
+     * @note The header of every row group is checked when the file is opened, along with the
+     * columns holding call indices, but words are never read until asked for.
+     */
+    class ColumnReader {
+    public:
+      /**
+       * @brief Memory-maps a columnar file.
+       *
+       * @param path Path to the file.
+       * @throws std::system_error if the file can't be mapped.
+       * @throws std::runtime_error if the file isn't a valid columnar file, or the host isn't
+       * little-endian.
+       */
+      explicit ColumnReader(const std::filesystem::path& path);
+
+      /**
+       * @brief Reads a columnar file held in memory.
+       *
+       * @param image The contents of the file.
+       * @throws std::runtime_error if `image` isn't a valid columnar file.
+       */
+      explicit ColumnReader(std::vector<uint8_t> image);
+
+      ColumnReader(const ColumnReader& other) = delete;
+      ColumnReader& operator=(const ColumnReader& other) = delete;
+      ColumnReader(ColumnReader&& other) = default;
+      ColumnReader& operator=(ColumnReader&& other) = default;
+      ~ColumnReader() = default;
+
+      /** @return The row groups, in the order they were written. */
+      [[nodiscard]] std::span<const RowGroup> groups() const noexcept;
+
+      /** @return The number of inputs over every row group. */
+      [[nodiscard]] uint64_t inputs() const noexcept;
+
+      /** @return The number of calls over every row group. */
+      [[nodiscard]] uint64_t calls() const noexcept;
+
+      /** @return The number of words over every row group. */
+      [[nodiscard]] uint64_t words() const noexcept;
+
+    private:
+      std::optional<mapped_file::MappedFile> file;
+      std::vector<uint8_t> owned;
+      std::span<const uint8_t> image;
+      std::vector<RowGroup> row_groups;
+
+      void parse();
+    };
+
+  }  // namespace columnar
+}  // namespace evmtools
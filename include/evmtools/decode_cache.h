@@ -0,0 +1,158 @@
+#pragma once
+
+#include <evmtools/batch_decoder.h>
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/thread_pool.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief A concurrent cache of decoded calldata, for streams that repeat the same inputs.
+   *
+   * Entries are keyed by a 64-bit hash of the input and checked against a copy of it, so a hash
+   * collision costs a decode but never returns the wrong result. The cache is split into shards,
+   * each with its own lock and its own CLOCK eviction, and inputs are spread over the shards by
+   * hash. Decoding happens outside of any lock.
+   */
+  namespace decode_cache {
+    using calldata_decoder::Calldata;
+
+    /**
+     * @brief Hashes a byte string. Fast, but not meant to resist collisions chosen by an attacker.
+     *
+     * @param bytes The bytes to be hashed.
+     * @return The 64-bit hash.
+     */
+    [[nodiscard]] uint64_t hash_bytes(std::span<const uint8_t> bytes) noexcept;
+
+    /** Counters of a DecodeCache, summed over its shards. */
+    struct CacheStats {
+      size_t hits{0};
+      size_t misses{0};
+      size_t evictions{0};
+      // Number of entries currently cached.
+      size_t size{0};
+    };
+
+    /**
+     * @brief A fixed-capacity, sharded CLOCK cache of decoded calldata.
+     *
+     * @note All member functions may be called concurrently from any thread. Results are shared
+     * and immutable, and stay valid after they're evicted for as long as they're held.
+     */
+    class DecodeCache {
+    public:
+      /**
+       * @param capacity Maximum number of cached entries, rounded up to a multiple of `shards`.
+       * @param shards Number of shards, or 0 to pick one from the number of hardware threads.
+       * @param options Limits on the work each decode may do.
+       * @throws std::invalid_argument if `capacity` is 0.
+       */
+      explicit DecodeCache(size_t capacity, size_t shards = 0,
+                           const calldata_decoder::DecodeOptions& options = {});
+
+      DecodeCache(const DecodeCache& other) = delete;
+      DecodeCache& operator=(const DecodeCache& other) = delete;
+      ~DecodeCache();
+
+      /**
+       * @brief Gets the cached decode of a hex string, decoding and caching it on a miss.
+       *
+       * @param hex The calldata hex string, with or without a `0x` prefix.
+       * @return The decoded calldata.
+       * @throws Whatever `Calldata` throws for malformed or over-budget input, which is not cached.
+       */
+      [[nodiscard]] std::shared_ptr<const Calldata> get(std::string_view hex);
+
+      /**
+       * @brief Gets the cached decode of raw calldata bytes, decoding and caching it on a miss.
+       *
+       * @note The bytes are copied into the cache on a miss, so the result doesn't refer into
+       * `bytes`.
+       *
+       * @param bytes The raw calldata bytes.
+       * @return The decoded calldata.
+       * @throws Whatever `Calldata` throws for malformed or over-budget input, which is not cached.
+       */
+      [[nodiscard]] std::shared_ptr<const Calldata> get(std::span<const uint8_t> bytes);
+
+      /** @return The hit, miss and eviction counters and the current size. */
+      [[nodiscard]] CacheStats stats() const;
+
+      /** @return The maximum number of cached entries. */
+      [[nodiscard]] size_t capacity() const noexcept;
+
+      /** @brief Drops every entry. Counters are kept. */
+      void clear();
+
+    private:
+      struct Entry;
+
+      struct Slot {
+        uint64_t hash{0};
+        std::shared_ptr<const Entry> entry;
+        // Set on every hit, and cleared as the clock hand passes over the slot.
+        bool referenced{false};
+      };
+
+      struct Shard {
+        mutable std::mutex mutex;
+        std::vector<Slot> slots;
+        std::unordered_map<uint64_t, size_t> index;
+        size_t hand{0};
+        size_t hits{0};
+        size_t misses{0};
+        size_t evictions{0};
+      };
+
+      std::vector<std::unique_ptr<Shard>> shards;
+      size_t slots_per_shard{0};
+      calldata_decoder::DecodeOptions options;
+
+      template <typename Decode> std::shared_ptr<const Calldata> get(std::span<const uint8_t> key,
+                                                                     bool hex, Decode&& decode);
+
+      /** @brief Stores `entry` in a free slot of `shard`, evicting an entry if there is none. */
+      void insert(Shard& shard, uint64_t hash, std::shared_ptr<const Entry> entry);
+    };
+
+    /**
+     * @brief Decodes a range of calldata inputs in parallel on a thread pool, through a cache.
+     *
+     * @param inputs The calldata inputs to be decoded: hex strings or spans of raw bytes.
+     * @param pool The thread pool the inputs are decoded on.
+     * @param cache The cache results are looked up in and added to.
+     * @param grain Number of consecutive inputs decoded by each task.
+     * @return The decoded calldata, in input order. Inputs that fail to decode are nullptr.
+     */
+    template <std::ranges::random_access_range Range>
+      requires std::ranges::sized_range<Range>
+    [[nodiscard]] std::vector<std::shared_ptr<const Calldata>> decode_batch(
+        const Range& inputs, thread_pool::ThreadPool& pool, DecodeCache& cache,
+        size_t grain = calldata_decoder::DEFAULT_BATCH_GRAIN) {
+      std::vector<std::shared_ptr<const Calldata>> results(std::ranges::size(inputs));
+
+      pool.parallel_for(results.size(), grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          try {
+            results[i] = cache.get(std::ranges::begin(inputs)[i]);
+          } catch (const std::exception&) {
+            // Leave malformed inputs empty.
+          }
+        }
+      });
+
+      return results;
+    }
+
+  }  // namespace decode_cache
+}  // namespace evmtools
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+
+namespace evmtools {
+  /**
+   * @brief Optional counters of where decoding spends its time.
+   *
+   * Built with `EVMTOOLS_ENABLE_STATS` defined (the `EVMTOOLS_ENABLE_STATS` CMake option), the
+   * decoder counts calls, bytes, allocations and time per decode phase, nested calls found and
+   * the candidate types guessed for each word. Otherwise every hook is an empty inline function
+   * and the counters stay at zero.
+   *
+   * Each thread counts into its own counters without synchronisation; `snapshot()` sums them
+   * over every thread, including threads that have since exited.
+   */
+  namespace decode_stats {
+
+    /** Whether the library was built with instrumentation. */
+#ifdef EVMTOOLS_ENABLE_STATS
+    inline constexpr bool ENABLED{true};
+#else
+    inline constexpr bool ENABLED{false};
+#endif
+
+    /** Instrumented phases of a decode. */
+    enum class Phase : uint8_t { ParseSelector, ParseRawParams, ParseLen, GetParamTypes };
+
+    constexpr size_t PHASE_COUNT{4};
+    constexpr size_t TYPES_COUNT{static_cast<size_t>(calldata_decoder::Types::MaxUint128) + 1};
+
+    /**
+     * @param phase Phase enum value.
+     * @return The name of the phase, e.g. "parse_selector".
+     */
+    [[nodiscard]] constexpr std::string_view phase_name(const Phase phase) noexcept {
+      switch (phase) {
+        case Phase::ParseSelector:
+          return "parse_selector";
+        case Phase::ParseRawParams:
+          return "parse_raw_params";
+        case Phase::ParseLen:
+          return "parse_len";
+        case Phase::GetParamTypes:
+          return "get_param_types";
+      }
+      return "unknown";
+    }
+
+    /** Counters of one phase. */
+    struct PhaseStats {
+      uint64_t calls{0};
+      // Calldata bytes the phase worked on.
+      uint64_t bytes{0};
+      // Allocations made through a CountingResource while the phase was innermost.
+      uint64_t allocations{0};
+      uint64_t allocated_bytes{0};
+      // Wall time, including any phase called from within this one.
+      uint64_t nanoseconds{0};
+    };
+
+    /** Counters summed over every thread. */
+    struct Snapshot {
+      std::array<PhaseStats, PHASE_COUNT> phases{};
+      // Nested calls found in calldata.
+      uint64_t nested_calls{0};
+      // Words for which each type was a candidate, indexed by Types.
+      std::array<uint64_t, TYPES_COUNT> types{};
+      // Words for which no type was a candidate.
+      uint64_t untyped{0};
+
+      [[nodiscard]] const PhaseStats& operator[](const Phase phase) const noexcept {
+        return this->phases[static_cast<size_t>(phase)];
+      }
+
+      [[nodiscard]] uint64_t count(const calldata_decoder::Types type) const noexcept {
+        return this->types[static_cast<size_t>(type)];
+      }
+    };
+
+    /**
+     * @brief Sums the counters of every thread.
+     *
+     * @note Counters of threads that are decoding while the snapshot is taken may be a few
+     * updates behind.
+     */
+    [[nodiscard]] Snapshot snapshot();
+
+    /** @brief Sets every counter back to zero. Meant to be called while nothing decodes. */
+    void reset();
+
+    /**
+     * @brief A memory resource that counts allocations against the phase running on the
+     * allocating thread, then forwards them to another resource.
+     *
+     * Decodes only count their allocations if they allocate through one, e.g. with
+     * `Calldata{input, &counting}`, or after `std::pmr::set_default_resource(&counting)`.
+     */
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+      explicit CountingResource(
+          std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+          : upstream(upstream) {}
+
+    private:
+      std::pmr::memory_resource* upstream;
+
+      void* do_allocate(size_t bytes, size_t alignment) override;
+      void do_deallocate(void* memory, size_t bytes, size_t alignment) override;
+      [[nodiscard]] bool do_is_equal(
+          const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    namespace detail {
+      void begin_phase(Phase phase, size_t bytes, Phase& previous, bool& nested) noexcept;
+      void end_phase(Phase phase, Phase previous, bool nested, uint64_t nanoseconds) noexcept;
+      void record_bytes(Phase phase, size_t bytes) noexcept;
+      void record_nested_call() noexcept;
+      void record_types(calldata_decoder::ParamTypes types) noexcept;
+    }  // namespace detail
+
+    /**
+     * @brief Counts a call of `phase` and the time until the end of the scope.
+     */
+    class Scope {
+    public:
+      Scope([[maybe_unused]] const Phase phase, [[maybe_unused]] const size_t bytes) noexcept {
+        if constexpr (ENABLED) {
+          this->phase = phase;
+          detail::begin_phase(phase, bytes, this->previous, this->nested);
+          this->start = std::chrono::steady_clock::now();
+        }
+      }
+
+      ~Scope() {
+        if constexpr (ENABLED) {
+          auto elapsed{std::chrono::steady_clock::now() - this->start};
+          detail::end_phase(
+              this->phase, this->previous, this->nested,
+              static_cast<uint64_t>(
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+      }
+
+      Scope(const Scope& other) = delete;
+      Scope& operator=(const Scope& other) = delete;
+
+      /** @brief Counts more bytes for phases that only learn their size as they go. */
+      void add_bytes([[maybe_unused]] const size_t bytes) noexcept {
+        if constexpr (ENABLED) detail::record_bytes(this->phase, bytes);
+      }
+
+    private:
+      Phase phase{};
+      Phase previous{};
+      bool nested{false};
+      std::chrono::steady_clock::time_point start{};
+    };
+
+    /** @brief Counts a nested call found in calldata. */
+    inline void count_nested_call() noexcept {
+      if constexpr (ENABLED) detail::record_nested_call();
+    }
+
+    /** @brief Counts the candidate types guessed for a word. */
+    inline void count_types([[maybe_unused]] const calldata_decoder::ParamTypes types) noexcept {
+      if constexpr (ENABLED) detail::record_types(types);
+    }
+
+  }  // namespace decode_stats
+}  // namespace evmtools
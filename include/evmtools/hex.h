@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace evmtools {
+  namespace hex {
+
+    /** Implementations of the hex kernels, from slowest to fastest. */
+    enum class Kernel { Scalar, Sse4, Avx2 };
+
+    /**
+     * @brief Checks whether a kernel can run on the current CPU.
+     *
+     * @param kernel The kernel to be checked.
+     * @return Whether the kernel is supported. Kernel::Scalar is always supported.
+     */
+    [[nodiscard]] bool is_supported(const Kernel kernel) noexcept;
+
+    /**
+     * @brief Returns the fastest kernel supported by the current CPU, which is the one used by
+     * `decode` unless another one is requested.
+     *
+     * @note The CPU is only queried on the first call.
+     */
+    [[nodiscard]] Kernel best_kernel() noexcept;
+
+    /**
+     * @brief Decodes hex characters (without a `0x` prefix) into bytes, validating every
+     * character.
+     *
+     * @note `hex` must have an even number of characters and `out` must hold at least
+     * `hex.size() / 2` bytes. Bytes are written up to the first invalid character.
+     *
+     * @param hex The hex characters to be decoded, upper or lower case.
+     * @param out The buffer the bytes are written to.
+     * @return `std::nullopt` if every character was valid, or else the index of the first
+     * invalid character in `hex`.
+     */
+    [[nodiscard]] std::optional<size_t> decode(const std::string_view hex,
+                                               std::span<uint8_t> out) noexcept;
+
+    /**
+     * @brief Decodes hex characters into bytes using a specific kernel.
+     *
+     * @note Falls back to Kernel::Scalar if `kernel` isn't supported by the current CPU.
+     *
+     * @param hex The hex characters to be decoded, upper or lower case.
+     * @param out The buffer the bytes are written to.
+     * @param kernel The kernel to decode with.
+     * @return `std::nullopt` if every character was valid, or else the index of the first
+     * invalid character in `hex`.
+     */
+    [[nodiscard]] std::optional<size_t> decode(const std::string_view hex,
+                                               std::span<uint8_t> out,
+                                               const Kernel kernel) noexcept;
+
+    /**
+     * @brief Encodes bytes as lower case hex characters (without a `0x` prefix).
+     *
+     * @note Only `min(bytes.size(), out.size() / 2)` bytes are encoded, so `out` is never written
+     * past its end.
+     *
+     * @param bytes The bytes to be encoded.
+     * @param out The buffer the characters are written to, two per byte.
+     */
+    void encode(std::span<const uint8_t> bytes, std::span<char> out) noexcept;
+
+    /**
+     * @brief Encodes bytes as lower case hex characters using a specific kernel.
+     *
+     * @note Falls back to Kernel::Scalar if `kernel` isn't supported by the current CPU.
+     *
+     * @param bytes The bytes to be encoded.
+     * @param out The buffer the characters are written to, two per byte.
+     * @param kernel The kernel to encode with.
+     */
+    void encode(std::span<const uint8_t> bytes, std::span<char> out, const Kernel kernel) noexcept;
+
+  }  // namespace hex
+}  // namespace evmtools
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/signature_index.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace evmtools {
+  /**
+   * @brief Writes decoded calldata as JSON, appending to a caller's buffer.
+   *
+   * A decoded input is written as one object:
+   *
+   * ```json
+   * {"selector":"0xa9059cbb","signature":"transfer(address,uint256)","truncated":false,
+   *  "params":[{"word":"0x…","offset":4,"types":["Address","Uint"]}],
+   *  "nested":[{"selector":"0x…","parent":0,"depth":2,"params":[…]}]}
+   * ```
+   *
+   * `signature` is only written for selectors found in a signature index, and `parent` only for
+   * calls nested in another nested call (it indexes `nested`). NDJSON lines are the same objects
+   * with an `index` field first, or `{"index":<n>,"error":true}` for inputs that failed to decode.
+   * Lines for the transactions of a block start with a `block` field as well.
+   *
+   * Each call is written in place after growing the buffer once to an upper bound of its size, so
+   * appending to a buffer with enough capacity never allocates. Words are hex encoded with the
+   * SIMD kernels of `hex::encode`.
+   */
+  namespace json_writer {
+    using calldata_decoder::Calldata;
+    using calldata_decoder::Types;
+
+    /** Number of Types values. */
+    constexpr size_t TYPE_COUNT{static_cast<size_t>(Types::MaxUint128) + 1};
+
+    /** JSON names of the Types values, e.g. "Address" for Types::Address. */
+    constexpr std::array<std::string_view, TYPE_COUNT> TYPE_NAMES{[] {
+      constexpr std::string_view prefix{"Types::"};
+      std::array<std::string_view, TYPE_COUNT> names{};
+      for (size_t i = 0; i < names.size(); i++) {
+        names[i] = calldata_decoder::type_name(static_cast<Types>(i)).substr(prefix.size());
+      }
+      return names;
+    }()};
+
+    /**
+     * @brief Appends a decoded input to `out` as a JSON object, without a trailing newline.
+     *
+     * @param out The buffer to append to.
+     * @param calldata The decoded input.
+     * @param signatures If given, known selectors get a `signature` field.
+     */
+    void append_json(std::string& out, const Calldata& calldata,
+                     const signature_index::SignatureIndex* signatures = nullptr);
+
+    /**
+     * @brief Appends one NDJSON line for a decoded input to `out`.
+     *
+     * @param out The buffer to append to.
+     * @param index The index of the input.
+     * @param calldata The decoded input, or nullptr if it failed to decode.
+     * @param signatures If given, known selectors get a `signature` field.
+     */
+    void append_ndjson(std::string& out, size_t index, const Calldata* calldata,
+                       const signature_index::SignatureIndex* signatures = nullptr);
+
+    /**
+     * @brief Appends one NDJSON line for a decoded input to `out`, like the overload above.
+     *
+     * @param calldata The decoded input, or `std::nullopt` if it failed to decode.
+     */
+    void append_ndjson(std::string& out, size_t index, const std::optional<Calldata>& calldata,
+                       const signature_index::SignatureIndex* signatures = nullptr);
+
+    /**
+     * @brief Appends one NDJSON line for the calldata of a transaction to `out`, with a `block`
+     * field before `index`.
+     *
+     * @param out The buffer to append to.
+     * @param block The number of the block holding the transaction.
+     * @param index The position of the transaction in its block.
+     * @param calldata The decoded calldata, or nullptr if it failed to decode.
+     * @param signatures If given, known selectors get a `signature` field.
+     */
+    void append_transaction_ndjson(std::string& out, uint64_t block, size_t index,
+                                   const Calldata* calldata,
+                                   const signature_index::SignatureIndex* signatures = nullptr);
+
+  }  // namespace json_writer
+}  // namespace evmtools
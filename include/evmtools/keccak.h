@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace evmtools {
+  namespace keccak {
+
+    /** A 32-byte Keccak-256 digest. */
+    using Hash = std::array<uint8_t, 32>;
+
+    namespace detail {
+      constexpr std::array<uint64_t, 24> ROUND_CONSTANTS{
+          0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+          0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+          0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+          0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+          0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+          0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008};
+
+      constexpr std::array<unsigned, 24> ROTATIONS{1,  3,  6,  10, 15, 21, 28, 36,
+                                                   45, 55, 2,  14, 27, 41, 56, 8,
+                                                   25, 43, 62, 18, 39, 61, 20, 44};
+
+      constexpr std::array<size_t, 24> LANES{10, 7,  11, 17, 18, 3, 5,  16, 8,  21, 24, 4,
+                                             15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1};
+
+      // Bytes absorbed per permutation for a 256-bit output.
+      constexpr size_t RATE{136};
+
+      constexpr uint64_t rotl(const uint64_t value, const unsigned shift) noexcept {
+        return value << shift | value >> (64 - shift);
+      }
+
+      /** The Keccak-f[1600] permutation. */
+      constexpr void permute(std::array<uint64_t, 25>& state) noexcept {
+        for (auto round_constant : ROUND_CONSTANTS) {
+          // Theta
+          std::array<uint64_t, 5> columns{};
+          for (size_t x = 0; x < 5; x++) {
+            columns[x] = state[x] ^ state[x + 5] ^ state[x + 10] ^ state[x + 15] ^ state[x + 20];
+          }
+          for (size_t x = 0; x < 5; x++) {
+            auto d{columns[(x + 4) % 5] ^ rotl(columns[(x + 1) % 5], 1)};
+            for (size_t y = 0; y < 25; y += 5) state[x + y] ^= d;
+          }
+
+          // Rho and pi
+          auto current{state[1]};
+          for (size_t t = 0; t < 24; t++) {
+            auto next{state[LANES[t]]};
+            state[LANES[t]] = rotl(current, ROTATIONS[t]);
+            current = next;
+          }
+
+          // Chi
+          for (size_t y = 0; y < 25; y += 5) {
+            std::array<uint64_t, 5> row{state[y], state[y + 1], state[y + 2], state[y + 3],
+                                        state[y + 4]};
+            for (size_t x = 0; x < 5; x++) {
+              state[y + x] = row[x] ^ (~row[(x + 1) % 5] & row[(x + 2) % 5]);
+            }
+          }
+
+          // Iota
+          state[0] ^= round_constant;
+        }
+      }
+
+      template <typename Byte> constexpr Hash keccak256(std::span<const Byte> data) noexcept {
+        std::array<uint64_t, 25> state{};
+        size_t absorbed{0};
+
+        auto absorb{[&](uint8_t byte) {
+          state[absorbed / 8] ^= uint64_t{byte} << (8 * (absorbed % 8));
+          if (++absorbed == RATE) {
+            permute(state);
+            absorbed = 0;
+          }
+        }};
+
+        for (auto byte : data) {
+          absorb(static_cast<uint8_t>(byte));
+        }
+
+        // Original Keccak padding (0x01 ... 0x80), not the SHA-3 one.
+        state[absorbed / 8] ^= uint64_t{0x01} << (8 * (absorbed % 8));
+        state[(RATE - 1) / 8] ^= uint64_t{0x80} << (8 * ((RATE - 1) % 8));
+        permute(state);
+
+        Hash hash{};
+        for (size_t i = 0; i < hash.size(); i++) {
+          hash[i] = static_cast<uint8_t>(state[i / 8] >> (8 * (i % 8)));
+        }
+        return hash;
+      }
+    }  // namespace detail
+
+    /**
+     * @brief Computes the Keccak-256 digest used by Ethereum.
+     *
+     * @param data The bytes to be hashed.
+     * @return The digest.
+     */
+    [[nodiscard]] constexpr Hash keccak256(std::span<const uint8_t> data) noexcept {
+      return detail::keccak256(data);
+    }
+
+    /**
+     * @brief Computes the Keccak-256 digest of a string, e.g. a function signature.
+     *
+     * @param text The string to be hashed.
+     * @return The digest.
+     */
+    [[nodiscard]] constexpr Hash keccak256(std::string_view text) noexcept {
+      return detail::keccak256(std::span<const char>{text.data(), text.size()});
+    }
+
+  }  // namespace keccak
+}  // namespace evmtools
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+namespace evmtools {
+  namespace mapped_file {
+
+    /**
+     * @brief A read-only memory mapping of a whole file.
+     *
+     * @note The mapping is private to the process, so changes made to the file while it is mapped
+     * may or may not be visible.
+     */
+    class MappedFile {
+    public:
+      /**
+       * @brief Maps the file at `path` into memory.
+       *
+       * @param path Path to the file to be mapped.
+       * @throws std::system_error if the file can't be opened or mapped.
+       */
+      explicit MappedFile(const std::filesystem::path& path);
+
+      ~MappedFile();
+
+      MappedFile(const MappedFile& other) = delete;
+      MappedFile& operator=(const MappedFile& other) = delete;
+      MappedFile(MappedFile&& other) noexcept;
+      MappedFile& operator=(MappedFile&& other) noexcept;
+
+      /** @return The contents of the file. */
+      [[nodiscard]] std::span<const uint8_t> bytes() const noexcept;
+
+      /** @return The contents of the file as text. */
+      [[nodiscard]] std::string_view text() const noexcept;
+
+      /** @return The size of the file in bytes. */
+      [[nodiscard]] size_t size() const noexcept;
+
+      /**
+       * @brief Hints to the OS that the file will be read from start to end, so it can read ahead
+       * aggressively.
+       */
+      void advise_sequential() const noexcept;
+
+    private:
+      const uint8_t* data{nullptr};
+      size_t length{0};
+#ifdef _WIN32
+      void* mapping{nullptr};
+#endif
+
+      void unmap() noexcept;
+    };
+
+  }  // namespace mapped_file
+}  // namespace evmtools
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace evmtools {
+  namespace mpmc_queue {
+
+    /** Assumed size of a cache line, used to keep the two ends of a queue apart. */
+    constexpr size_t CACHE_LINE{64};
+
+    /**
+     * @brief A bounded, lock-free queue for any number of producers and consumers.
+     *
+     * Every slot carries a sequence number that says whether it is ready to be written or read
+     * for the current lap around the ring, so pushing or popping is one compare-and-swap on the
+     * shared position plus an uncontended write to the slot. Neither operation blocks or
+     * allocates; a full or empty queue is reported instead.
+     *
+     * @note All member functions may be called concurrently from any thread.
+     */
+    template <typename T> class MpmcQueue {
+      static_assert(std::is_nothrow_move_constructible_v<T>,
+                    "Items are moved in and out of slots that can't be rolled back");
+
+    public:
+      /**
+       * @param capacity Most items the queue holds, rounded up to a power of two of at least 2.
+       */
+      explicit MpmcQueue(size_t capacity)
+          : mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+            slots(std::make_unique<Slot[]>(this->mask + 1)) {
+        for (size_t i = 0; i <= this->mask; i++) {
+          this->slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+      }
+
+      ~MpmcQueue() {
+        while (this->try_pop()) {
+        }
+      }
+
+      MpmcQueue(const MpmcQueue& other) = delete;
+      MpmcQueue& operator=(const MpmcQueue& other) = delete;
+
+      /**
+       * @brief Moves `item` into the queue, unless it is full.
+       *
+       * @return Whether the item was pushed. If not, `item` is left untouched.
+       */
+      bool try_push(T&& item) noexcept {
+        auto position{this->tail.load(std::memory_order_relaxed)};
+
+        while (true) {
+          auto& slot{this->slots[position & this->mask]};
+          const auto sequence{slot.sequence.load(std::memory_order_acquire)};
+          const auto lag{static_cast<std::ptrdiff_t>(sequence - position)};
+
+          if (lag == 0) {
+            // The slot is free for this lap; claim it.
+            if (this->tail.compare_exchange_weak(position, position + 1,
+                                                 std::memory_order_relaxed)) {
+              std::construct_at(&slot.item, std::move(item));
+              slot.sequence.store(position + 1, std::memory_order_release);
+              return true;
+            }
+          } else if (lag < 0) {
+            // The slot still holds the item from the previous lap.
+            return false;
+          } else {
+            position = this->tail.load(std::memory_order_relaxed);
+          }
+        }
+      }
+
+      /**
+       * @brief Moves the oldest item out of the queue, unless it is empty.
+       *
+       * @return The item, or `std::nullopt` if the queue is empty (or its oldest item is still
+       * being pushed).
+       */
+      std::optional<T> try_pop() noexcept {
+        auto position{this->head.load(std::memory_order_relaxed)};
+
+        while (true) {
+          auto& slot{this->slots[position & this->mask]};
+          const auto sequence{slot.sequence.load(std::memory_order_acquire)};
+          const auto lag{static_cast<std::ptrdiff_t>(sequence - (position + 1))};
+
+          if (lag == 0) {
+            if (this->head.compare_exchange_weak(position, position + 1,
+                                                 std::memory_order_relaxed)) {
+              std::optional<T> item{std::move(slot.item)};
+              std::destroy_at(&slot.item);
+              // Free the slot for the next lap.
+              slot.sequence.store(position + this->mask + 1, std::memory_order_release);
+              return item;
+            }
+          } else if (lag < 0) {
+            return std::nullopt;
+          } else {
+            position = this->head.load(std::memory_order_relaxed);
+          }
+        }
+      }
+
+      /** @return The most items the queue holds. */
+      [[nodiscard]] size_t capacity() const noexcept { return this->mask + 1; }
+
+      /** @return The number of items in the queue. Only a snapshot while others use the queue. */
+      [[nodiscard]] size_t size() const noexcept {
+        const auto pushed{this->tail.load(std::memory_order_acquire)};
+        const auto popped{this->head.load(std::memory_order_acquire)};
+        return pushed > popped ? pushed - popped : 0;
+      }
+
+    private:
+      struct Slot {
+        std::atomic<size_t> sequence{0};
+        // Only holds an item between a push and the matching pop.
+        union {
+          T item;
+        };
+
+        Slot() noexcept {}
+        ~Slot() {}
+      };
+
+      const size_t mask;
+      std::unique_ptr<Slot[]> slots;
+      // Producers and consumers each write their own end, so keep them on separate cache lines.
+      std::atomic<size_t> tail{0};
+      std::byte padding[CACHE_LINE]{};
+      std::atomic<size_t> head{0};
+    };
+
+  }  // namespace mpmc_queue
+}  // namespace evmtools
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief Replays recorded transactions into the decoder at their original (or a scaled) rate,
+   * and measures the end-to-end latency of each decode.
+   */
+  namespace replay {
+
+    /** One recorded transaction. */
+    struct Record {
+      // When the transaction was seen, in microseconds since any fixed epoch.
+      uint64_t timestamp_us{0};
+      // The calldata hex string. Refers into the recording.
+      std::string_view input;
+    };
+
+    /**
+     * @brief Splits a recording into records.
+     *
+     * Each non-empty line is a decimal timestamp in microseconds, whitespace, and then either a hex
+     * string or a JSON object with an `input` field (see `stream_decoder::extract_calldata`).
+     * Lines without calldata are kept with an empty input, so they're replayed as failed decodes.
+     *
+     * @param text The recording, e.g. the text of a memory-mapped file. Lines are never copied.
+     * @return The records, in the order they were recorded.
+     * @throws std::invalid_argument if a line doesn't start with a timestamp.
+     */
+    [[nodiscard]] std::vector<Record> parse_records(std::string_view text);
+
+    /** Tuning knobs for `replay`. */
+    struct ReplayOptions {
+      // How many times faster than recorded to replay, or 0 to replay as fast as possible.
+      double speed{1.0};
+      // Number of decoder threads, or 0 to use one per hardware thread.
+      size_t threads{0};
+      // Most records that are due at once handed to a decoder thread as one task.
+      size_t batch_size{64};
+      // Limits on the work each decode may do.
+      calldata_decoder::DecodeOptions decode{};
+    };
+
+    /** Percentiles of a set of latencies. */
+    struct LatencySummary {
+      std::chrono::nanoseconds p50{0};
+      std::chrono::nanoseconds p99{0};
+      std::chrono::nanoseconds p999{0};
+      std::chrono::nanoseconds max{0};
+      std::chrono::nanoseconds mean{0};
+    };
+
+    /**
+     * @brief Summarizes latencies, using the nearest-rank percentile.
+     *
+     * @param latencies The latencies. May be empty, in which case everything is 0.
+     */
+    [[nodiscard]] LatencySummary summarize(std::vector<std::chrono::nanoseconds> latencies);
+
+    /** Results of `replay`. */
+    struct ReplayReport {
+      size_t inputs{0};
+      size_t decoded{0};
+      // From the start of the replay until the last decode finished.
+      std::chrono::nanoseconds elapsed{0};
+      // Latency of each record, from when it was due until its decode finished, in record order.
+      std::vector<std::chrono::nanoseconds> latencies;
+
+      /** @return Records replayed per second, over the whole replay. */
+      [[nodiscard]] double throughput() const noexcept;
+    };
+
+    /**
+     * @brief Feeds records into a pool of decoder threads, each at its recorded time relative to
+     * the earliest record, divided by the speed.
+     *
+     * Records needn't be sorted: they are handed over in timestamp order, with records of equal
+     * timestamps in the order given, and their latencies are still reported in the order given.
+     *
+     * A record's latency is measured from when it was due, not from when it was handed over, so
+     * time spent waiting behind a backlog counts towards it. Replaying with a speed of 0 makes
+     * every record due at the start, so the throughput of the report is the most the decoder can
+     * sustain.
+     *
+     * @param records The records to be replayed. Their inputs must outlive the call.
+     * @param options Tuning knobs for the replay.
+     * @return The latency of every record and totals over the replay.
+     */
+    [[nodiscard]] ReplayReport replay(std::span<const Record> records,
+                                      const ReplayOptions& options = {});
+
+  }  // namespace replay
+}  // namespace evmtools
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/hex.h>
+#include <evmtools/signature_index.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief Finds known selectors at any byte offset of calldata.
+   *
+   * The decoder only looks for nested calls at the start of a word, and guesses at selectors from
+   * the shape of a word. Calls behind packed or otherwise unaligned encodings are missed, and
+   * words that only look like selectors are not. The scanner instead reads the 4 bytes at every
+   * offset and looks them up in a set of known selectors. A Bloom filter small enough to stay in
+   * cache rejects almost every offset, and the few that pass are checked exactly, so every
+   * candidate is a known selector.
+   */
+  namespace selector_scanner {
+    using calldata_decoder::Selector;
+    // The scanner kernels need the same instruction sets as the hex kernels.
+    using hex::Kernel;
+
+    /** A known selector found in calldata. */
+    struct Candidate {
+      // Byte offset of the selector's first byte.
+      size_t offset{0};
+      Selector selector;
+
+      [[nodiscard]] bool operator==(const Candidate& other) const noexcept = default;
+    };
+
+    /**
+     * @brief An immutable set of known selectors, with a Bloom filter in front.
+     *
+     * @note Lookups are `noexcept`, allocation-free and safe to call from any number of threads.
+     */
+    class SelectorSet {
+    public:
+      /**
+       * @param selectors The known selectors. Duplicates are ignored.
+       */
+      explicit SelectorSet(std::span<const Selector> selectors);
+
+      /**
+       * @brief Holds every selector of a signature index.
+       *
+       * @param index The index whose selectors are known.
+       */
+      explicit SelectorSet(const signature_index::SignatureIndex& index);
+
+      /** @return Whether the selector is known. */
+      [[nodiscard]] bool contains(const Selector selector) const noexcept;
+
+      /**
+       * @return Whether the Bloom filter lets the selector through. Known selectors always pass,
+       * and at most about 2% of unknown ones do too.
+       */
+      [[nodiscard]] bool may_contain(const Selector selector) const noexcept;
+
+      /** @return The number of distinct known selectors. */
+      [[nodiscard]] size_t size() const noexcept;
+
+    private:
+      friend void scan(std::span<const uint8_t> data, const SelectorSet& set,
+                       std::vector<Candidate>& out, const Kernel kernel);
+
+      // Bloom filter bits, a power of two of them, packed into 32-bit words.
+      std::vector<uint32_t> filter;
+      // Right shift that turns a 32-bit hash into a word index of the filter.
+      uint32_t shift{0};
+      // The known selectors, sorted.
+      std::vector<uint32_t> known;
+    };
+
+    /**
+     * @brief Appends every known selector in `data` to `out`, in offset order, using the fastest
+     * supported kernel.
+     *
+     * @note Offset 0 of calldata is its own selector, which is reported too if it is known.
+     *
+     * @param data The bytes to be scanned, e.g. `Calldata::calldata`.
+     * @param set The known selectors.
+     * @param out The vector candidates are appended to.
+     */
+    void scan(std::span<const uint8_t> data, const SelectorSet& set, std::vector<Candidate>& out);
+
+    /**
+     * @brief Appends every known selector in `data` to `out` using a specific kernel.
+     *
+     * @note Kernels without gather instructions (Kernel::Sse4) and kernels the current CPU doesn't
+     * support fall back to Kernel::Scalar.
+     *
+     * @param data The bytes to be scanned.
+     * @param set The known selectors.
+     * @param out The vector candidates are appended to.
+     * @param kernel The kernel to scan with.
+     */
+    void scan(std::span<const uint8_t> data, const SelectorSet& set, std::vector<Candidate>& out,
+              const Kernel kernel);
+
+    /**
+     * @brief Finds every known selector in `data`.
+     *
+     * @return The candidates, in offset order.
+     */
+    [[nodiscard]] std::vector<Candidate> scan(std::span<const uint8_t> data,
+                                              const SelectorSet& set);
+
+  }  // namespace selector_scanner
+}  // namespace evmtools
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/keccak.h>
+#include <evmtools/mapped_file.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief Local lookup of function signatures by selector.
+   *
+   * Indexes are built offline from a text list of signatures and stored in a compact binary
+   * format (all integers little-endian):
+   *
+   * - header: magic `EVMSIG\0\1`, then u32 seed, bucket count, slot count, signature count, blob
+   *   size and a reserved u32
+   * - displacements: one u32 per bucket
+   * - slots: u32 selector, u32 first signature and u32 signature count, one per selector
+   * - offsets: one u32 per signature, plus one, into the blob
+   * - blob: the signature strings, back to back
+   *
+   * Selectors are placed with a minimal perfect hash (hash and displace): a selector's bucket
+   * holds the displacement that, hashed together with the selector, gives its slot. A lookup is
+   * therefore two hashes and a single selector comparison, and never allocates.
+   */
+  namespace signature_index {
+
+    /**
+     * @brief Computes the selector of a function signature, e.g. `transfer(address,uint256)`.
+     *
+     * @param signature The canonical signature, without spaces or parameter names.
+     * @return The first 4 bytes of the Keccak-256 digest of the signature.
+     */
+    [[nodiscard]] constexpr calldata_decoder::Selector selector_from_signature(
+        const std::string_view signature) noexcept {
+      return calldata_decoder::Selector::from_bytes(keccak::keccak256(signature).data());
+    }
+
+    /**
+     * @brief Builds an index from a text list of signatures.
+     *
+     * @note Lines are trimmed, and empty lines or lines starting with `#` are skipped. Signatures
+     * that share a selector are all kept, in the order they're listed.
+     *
+     * @param signature_list One signature per line.
+     * @return The binary index, ready to be written to a file.
+     */
+    [[nodiscard]] std::vector<uint8_t> build_signature_index(std::string_view signature_list);
+
+    /**
+     * @brief A read-only signature index, either memory-mapped from a file or held in memory.
+     *
+     * @note Lookups are `noexcept`, allocation-free and safe to call from any number of threads.
+     */
+    class SignatureIndex {
+    public:
+      /**
+       * @brief Memory-maps an index file. Only the header is read up front.
+       *
+       * @param path Path to the index file.
+       * @throws std::system_error if the file can't be mapped.
+       * @throws std::runtime_error if the file isn't a valid index.
+       */
+      explicit SignatureIndex(const std::filesystem::path& path);
+
+      /**
+       * @brief Uses an index held in memory, e.g. straight from `build_signature_index`.
+       *
+       * @param image The binary index.
+       * @throws std::runtime_error if `image` isn't a valid index.
+       */
+      explicit SignatureIndex(std::vector<uint8_t> image);
+
+      SignatureIndex(const SignatureIndex& other) = delete;
+      SignatureIndex& operator=(const SignatureIndex& other) = delete;
+      SignatureIndex(SignatureIndex&& other) = default;
+      SignatureIndex& operator=(SignatureIndex&& other) = default;
+      ~SignatureIndex() = default;
+
+      /**
+       * @brief Finds the first listed signature of a selector.
+       *
+       * @param selector The selector to be looked up, e.g. `Calldata::selector` or
+       * `Params::selector`.
+       * @return The signature, referring into the index, or `std::nullopt` if it isn't indexed.
+       */
+      [[nodiscard]] std::optional<std::string_view> find(
+          const calldata_decoder::Selector selector) const noexcept;
+
+      /**
+       * @brief Counts the signatures that share a selector.
+       *
+       * @param selector The selector to be looked up.
+       * @return The number of indexed signatures with the selector.
+       */
+      [[nodiscard]] size_t count(const calldata_decoder::Selector selector) const noexcept;
+
+      /**
+       * @brief Gets the n-th listed signature of a selector.
+       *
+       * @param selector The selector to be looked up.
+       * @param n The index of the signature, below `count(selector)`.
+       * @return The signature, or `std::nullopt` if there are no more than `n` signatures.
+       */
+      [[nodiscard]] std::optional<std::string_view> signature(
+          const calldata_decoder::Selector selector, size_t n) const noexcept;
+
+      /** @return The number of distinct selectors in the index. */
+      [[nodiscard]] size_t size() const noexcept;
+
+      /** @return Every distinct selector in the index, in slot order. */
+      [[nodiscard]] std::vector<calldata_decoder::Selector> selectors() const;
+
+    private:
+      std::optional<mapped_file::MappedFile> file;
+      std::vector<uint8_t> owned;
+      std::span<const uint8_t> image;
+
+      uint32_t seed{0};
+      std::span<const uint8_t> displacements;
+      std::span<const uint8_t> slots;
+      std::span<const uint8_t> offsets;
+      std::span<const uint8_t> blob;
+
+      void parse();
+
+      /** @return The slot holding `selector`, if it is indexed. */
+      [[nodiscard]] std::optional<size_t> find_slot(
+          const calldata_decoder::Selector selector) const noexcept;
+    };
+
+  }  // namespace signature_index
+}  // namespace evmtools
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/decode_cache.h>
+#include <evmtools/signature_index.h>
+
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace evmtools {
+  namespace stream_decoder {
+
+    /**
+     * @brief Extracts the calldata of one input line.
+     *
+     * @param line A hex string, or a JSON object with an `input` string field.
+     * @return The calldata hex string, or `std::nullopt` if a JSON object has no `input` field.
+     */
+    [[nodiscard]] std::optional<std::string_view> extract_calldata(std::string_view line) noexcept;
+
+    /**
+     * @brief Appends one decoded input to `out` as tab-separated text.
+     *
+     * The first line holds the index, selector and every word with its candidate types. Each
+     * nested call follows on its own line, indexed as `<index>.<n>`. Inputs that failed to decode
+     * are written as `<index>\terror`.
+     *
+     * @param out The string to append to.
+     * @param index The index of the input.
+     * @param calldata The decoded input, or `std::nullopt` if it failed to decode.
+     * @param signatures If given, known selectors are written as `<selector>:<signature>`.
+     */
+    void format_text(std::string& out, size_t index,
+                     const std::optional<calldata_decoder::Calldata>& calldata,
+                     const signature_index::SignatureIndex* signatures = nullptr);
+
+    /**
+     * @brief Appends one decoded input to `out` as tab-separated text, like the overload above.
+     *
+     * @param calldata The decoded input, or nullptr if it failed to decode.
+     */
+    void format_text(std::string& out, size_t index, const calldata_decoder::Calldata* calldata,
+                     const signature_index::SignatureIndex* signatures = nullptr);
+
+    /**
+     * @brief Appends one decoded input to `out` as tab-separated text, like the overloads above,
+     * named by `label` instead of an index.
+     *
+     * @param label What the input is called in the output, e.g. `<block>:<transaction>`. Nested
+     * calls are named `<label>.<n>`.
+     */
+    void format_text(std::string& out, std::string_view label,
+                     const calldata_decoder::Calldata* calldata,
+                     const signature_index::SignatureIndex* signatures = nullptr);
+
+    /** Formats `decode_stream` can write. */
+    enum class OutputFormat {
+      // Tab-separated text, see `format_text`.
+      Text,
+      // The binary format of `columnar::ColumnWriter`.
+      Columnar,
+      // One JSON object per line, see `json_writer::append_ndjson`.
+      Json
+    };
+
+    /** Tuning knobs for `decode_stream`. */
+    struct StreamOptions {
+      // Number of decoder threads, or 0 to use one per hardware thread.
+      size_t threads{0};
+      // Number of inputs handed from stage to stage at once.
+      size_t batch_size{4096};
+      // Number of batches that may wait between two stages before the earlier one blocks.
+      size_t queue_depth{8};
+      // Index used to name selectors in the output, if any.
+      const signature_index::SignatureIndex* signatures{nullptr};
+      // Cache that repeated inputs are looked up in instead of being decoded again, if any.
+      decode_cache::DecodeCache* cache{nullptr};
+      // Format the results are written in.
+      OutputFormat format{OutputFormat::Text};
+      // Limits on the work each decode may do. Inputs over budget are reported as errors. A cache
+      // decodes with its own options instead.
+      calldata_decoder::DecodeOptions decode{};
+    };
+
+    /** Totals reported by `decode_stream`. */
+    struct StreamStats {
+      size_t inputs{0};
+      size_t decoded{0};
+      size_t bytes{0};
+    };
+
+    /**
+     * @brief Decodes every non-empty line of `input` and writes the results to `out` in input
+     * order, as text (using `format_text`), as NDJSON or in the columnar format.
+     *
+     * Splitting lines, decoding and formatting run as three pipelined stages on their own threads,
+     * connected by bounded queues of batches, with decoding itself spread over a thread pool.
+     *
+     * @param input The input lines, e.g. the text of a memory-mapped file. Lines are never copied.
+     * @param out The stream results are written to, opened in binary mode for columnar output.
+     * @param options Tuning knobs for the pipeline.
+     * @return Totals over the whole input.
+     * @throws std::runtime_error if writing columnar output fails.
+     */
+    StreamStats decode_stream(std::string_view input, std::ostream& out,
+                              const StreamOptions& options = {});
+
+  }  // namespace stream_decoder
+}  // namespace evmtools
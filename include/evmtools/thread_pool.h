@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace evmtools {
+  namespace thread_pool {
+
+    /**
+     * @brief A fixed-size pool of worker threads with per-worker task queues and work stealing.
+     *
+     * Tasks submitted from a worker go to the back of its own queue, and tasks submitted from
+     * elsewhere are spread over the queues round-robin. Workers run their own tasks newest first
+     * and, once their queue is empty, steal the oldest task of another worker.
+     *
+     * @note All member functions may be called concurrently from any thread, including from
+     * within tasks.
+     */
+    class ThreadPool {
+    public:
+      /**
+       * @brief Starts the worker threads.
+       *
+       * @param threads Number of workers, or 0 to use one per hardware thread.
+       */
+      explicit ThreadPool(size_t threads = 0);
+
+      /**
+       * @brief Runs every task that is still queued, then joins the workers.
+       */
+      ~ThreadPool();
+
+      ThreadPool(const ThreadPool& other) = delete;
+      ThreadPool& operator=(const ThreadPool& other) = delete;
+
+      /** @return The number of worker threads. */
+      [[nodiscard]] size_t size() const noexcept;
+
+      /**
+       * @brief Queues a task to be run by one of the workers.
+       *
+       * @note Exceptions thrown by the task are swallowed; use `parallel_for` to observe them.
+       *
+       * @param task The task to be run.
+       */
+      void submit(std::function<void()> task);
+
+      /**
+       * @brief Calls `body(begin, end)` over consecutive chunks of [0, count), of at most `grain`
+       * indices each, and blocks until every chunk is done. The calling thread runs queued tasks
+       * while it waits, and sleeps once there are none left to take.
+       *
+       * @param count Number of indices.
+       * @param grain Maximum number of indices per chunk.
+       * @param body The function called for each chunk.
+       * @throws The first exception thrown by `body`, once every chunk has finished.
+       */
+      void parallel_for(size_t count, size_t grain,
+                        const std::function<void(size_t begin, size_t end)>& body);
+
+    private:
+      struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+      };
+
+      std::vector<std::unique_ptr<Queue>> queues;
+      std::vector<std::thread> workers;
+
+      // Number of queued tasks across every queue, used to put idle workers to sleep.
+      std::atomic<size_t> queued{0};
+      std::atomic<size_t> next_queue{0};
+      std::mutex sleep_mutex;
+      std::condition_variable wake;
+      bool stopping{false};
+
+      /**
+       * @brief Pops a task from queue `home`, or steals one from another queue.
+       *
+       * @return Whether a task was found and run.
+       */
+      bool run_one(size_t home);
+
+      void worker_loop(size_t index);
+    };
+
+  }  // namespace thread_pool
+}  // namespace evmtools
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief Zero-copy decoding of RLP-encoded transactions, as found in blocks.
+   *
+   * Supports legacy transactions (with or without an EIP-155 chain id) and the typed envelopes of
+   * EIP-2930, EIP-1559 and EIP-4844, signed or unsigned. Blob transactions are also accepted in
+   * their network form, with blobs, commitments and proofs attached. Typed transactions may be
+   * wrapped in an RLP string, the way block bodies hold them.
+   *
+   * Decoding only walks the RLP structure: the fields callers need are spans into the encoded
+   * transaction, which must outlive the Transaction. The encoding must be canonical, so corrupt
+   * archives are reported rather than misread.
+   */
+  namespace transaction_decoder {
+    using calldata_decoder::allocator_type;
+    using calldata_decoder::DecodeOptions;
+    using calldata_decoder::DecodeResult;
+
+    /** The EIP-2718 type of a transaction. */
+    enum class TransactionType : uint8_t { Legacy = 0, AccessList = 1, DynamicFee = 2, Blob = 3 };
+
+    /**
+     * @param type TransactionType enum value.
+     * @return The name of the type, e.g. "dynamic_fee".
+     */
+    [[nodiscard]] constexpr std::string_view type_name(const TransactionType type) noexcept {
+      switch (type) {
+        case TransactionType::Legacy:
+          return "legacy";
+        case TransactionType::AccessList:
+          return "access_list";
+        case TransactionType::DynamicFee:
+          return "dynamic_fee";
+        case TransactionType::Blob:
+          return "blob";
+      }
+      return "unknown";
+    }
+
+    /** A decoded transaction. Every span refers into the encoded transaction. */
+    struct Transaction {
+      TransactionType type{TransactionType::Legacy};
+      // Chain id of typed transactions and of EIP-155 legacy transactions.
+      std::optional<uint64_t> chain_id;
+      uint64_t nonce{0};
+      uint64_t gas_limit{0};
+      // The 20-byte recipient, or empty for contract creation.
+      std::span<const uint8_t> to;
+      // The value in wei, as a big-endian integer without leading zero bytes.
+      std::span<const uint8_t> value;
+      // The calldata (or init code for contract creation).
+      std::span<const uint8_t> data;
+      // The whole transaction, from its type byte (if any) to the end of its RLP list.
+      std::span<const uint8_t> encoded;
+
+      /** @return Whether the transaction creates a contract. */
+      [[nodiscard]] bool is_create() const noexcept { return this->to.empty(); }
+
+      /** @return The value in wei. */
+      [[nodiscard]] intx::uint256 value_uint() const noexcept;
+    };
+
+    /**
+     * @brief Decodes one transaction without copying it.
+     *
+     * @param encoded A legacy transaction's RLP list, a typed transaction's envelope (type byte
+     * followed by its RLP list), or either wrapped in an RLP string.
+     * @return The transaction, referring into `encoded`.
+     * @throws std::invalid_argument if the transaction is malformed, non-canonical or of an
+     * unsupported type.
+     */
+    [[nodiscard]] Transaction decode_transaction(std::span<const uint8_t> encoded);
+
+    /**
+     * @brief Decodes one transaction without copying it or throwing.
+     *
+     * @return The transaction, or `std::nullopt` if it is malformed.
+     */
+    [[nodiscard]] std::optional<Transaction> try_decode_transaction(
+        std::span<const uint8_t> encoded) noexcept;
+
+    /**
+     * @brief Splits an RLP list of transactions, such as the transactions of a block body, into
+     * its items.
+     *
+     * @param list The encoded list.
+     * @return One span per transaction, each accepted by `decode_transaction`.
+     * @throws std::invalid_argument if `list` isn't exactly one well-formed RLP list.
+     */
+    [[nodiscard]] std::vector<std::span<const uint8_t>> split_transactions(
+        std::span<const uint8_t> list);
+
+    /** The parts of a block that calldata decoding needs. */
+    struct Block {
+      uint64_t number{0};
+      // Each transaction of the block body, accepted by `decode_transaction`.
+      std::vector<std::span<const uint8_t>> transactions;
+    };
+
+    /**
+     * @brief Reads the number and transactions of an RLP-encoded block, `[header, transactions,
+     * ...]`, without copying it.
+     *
+     * @param encoded Exactly one encoded block.
+     * @return The block, referring into `encoded`.
+     * @throws std::invalid_argument if the block is malformed. Its transactions are only split,
+     * not decoded.
+     */
+    [[nodiscard]] Block decode_block(std::span<const uint8_t> encoded);
+
+    /**
+     * @brief Measures the RLP item at the start of `data`, e.g. to split concatenated blocks.
+     *
+     * @return The size of the item, prefix included.
+     * @throws std::invalid_argument if the item is malformed or runs past the end of `data`.
+     */
+    [[nodiscard]] size_t item_size(std::span<const uint8_t> data);
+
+    /**
+     * @brief Decodes the calldata of a transaction, within the budgets of `options`.
+     *
+     * @note The result refers into the encoded transaction. Transactions without a selector's
+     * worth of data, e.g. plain transfers, are reported as DecodeStatus::Malformed.
+     *
+     * @param transaction The transaction whose `data` is decoded.
+     * @param options Limits on the work the decode may do.
+     * @param alloc Allocator for every container of the decode.
+     * @return The decoded calldata, or why it couldn't be decoded.
+     */
+    [[nodiscard]] DecodeResult decode_calldata(const Transaction& transaction,
+                                               const DecodeOptions& options = {},
+                                               allocator_type alloc = {}) noexcept;
+
+  }  // namespace transaction_decoder
+}  // namespace evmtools
@@ -0,0 +1,461 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/keccak.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <intx/intx.hpp>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace evmtools {
+  /**
+   * @brief Decoders generated at compile time for signatures known up front.
+   *
+   * `decoder<"transfer(address,uint256)">` computes its selector at compile time and decodes the
+   * calldata of that exact signature into typed values, with one fully unrolled read per param.
+   * A Dispatcher picks the decoder matching the selector of some calldata, leaving unknown
+   * selectors (or calldata that doesn't match its signature) to the heuristic Calldata decoder.
+   *
+   * Supported params are the elementary types (`address`, `bool`, `uint<N>`, `int<N>`,
+   * `bytes<N>`), `bytes`, `string`, and dynamic arrays `T[]` of any of those. They decode to:
+   *
+   * - `address`: Address
+   * - `bool`: bool
+   * - `uint<N>` and `int<N>`: intx::uint256 (`int<N>` in two's complement)
+   * - `bytes<N>`: std::array<uint8_t, N>
+   * - `bytes` and `string`: std::span<const uint8_t> and std::string_view into the calldata
+   * - `T[]`: std::vector of the above
+   */
+  namespace typed_decoder {
+    using calldata_decoder::Selector;
+    using calldata_decoder::SELECTOR_SIZE;
+    using calldata_decoder::WORD_SIZE;
+
+    /** A 20-byte account address. */
+    struct Address {
+      std::array<uint8_t, 20> bytes{};
+
+      /** @return The 40-character lower case hex representation of the address. */
+      [[nodiscard]] std::string to_hex() const;
+
+      constexpr bool operator==(const Address& other) const = default;
+    };
+
+    /**
+     * @brief A signature passed as a template argument, e.g. `decoder<"approve(address,uint256)">`.
+     *
+     * @tparam N The size of the string literal, including its null terminator.
+     */
+    template <size_t N> struct Signature {
+      char text[N]{};
+
+      constexpr Signature(const char (&literal)[N]) noexcept { std::copy_n(literal, N, text); }
+
+      [[nodiscard]] constexpr std::string_view view() const noexcept { return {text, N - 1}; }
+    };
+
+    /** Kinds of params a decoder can read. */
+    enum class Kind { Address, Bool, Uint, Int, FixedBytes, Bytes, String, Array };
+
+    /** A parsed param type. */
+    struct Param {
+      Kind kind{Kind::Uint};
+      // Bits of `uint<N>`/`int<N>`, or bytes of `bytes<N>`.
+      unsigned size{0};
+      // Element type of arrays.
+      Kind element{Kind::Uint};
+      unsigned element_size{0};
+    };
+
+    namespace detail {
+      constexpr unsigned parse_number(std::string_view digits) {
+        if (digits.empty() || digits.size() > 3) {
+          throw std::invalid_argument("invalid type size in signature");
+        }
+
+        unsigned value{0};
+        for (auto c : digits) {
+          if (c < '0' || c > '9') {
+            throw std::invalid_argument("invalid type size in signature");
+          }
+          value = value * 10 + static_cast<unsigned>(c - '0');
+        }
+        return value;
+      }
+
+      /** Parses an elementary type, `bytes` or `string`, returning its kind and size. */
+      constexpr std::pair<Kind, unsigned> parse_elementary(std::string_view type) {
+        if (type == "address") return {Kind::Address, 160};
+        if (type == "bool") return {Kind::Bool, 8};
+        if (type == "bytes") return {Kind::Bytes, 0};
+        if (type == "string") return {Kind::String, 0};
+        if (type == "uint") return {Kind::Uint, 256};
+        if (type == "int") return {Kind::Int, 256};
+
+        for (auto [prefix, kind] : {std::pair{std::string_view{"uint"}, Kind::Uint},
+                                    std::pair{std::string_view{"int"}, Kind::Int},
+                                    std::pair{std::string_view{"bytes"}, Kind::FixedBytes}}) {
+          if (!type.starts_with(prefix)) {
+            continue;
+          }
+
+          auto size{parse_number(type.substr(prefix.size()))};
+          bool valid{kind == Kind::FixedBytes ? size >= 1 && size <= 32
+                                              : size >= 8 && size <= 256 && size % 8 == 0};
+          if (!valid) {
+            throw std::invalid_argument("invalid type size in signature");
+          }
+          return {kind, size};
+        }
+
+        throw std::invalid_argument("unsupported type in signature");
+      }
+
+      constexpr Param parse_param(std::string_view type) {
+        if (type.ends_with("[]")) {
+          auto [element, element_size]{parse_elementary(type.substr(0, type.size() - 2))};
+          return Param{Kind::Array, 0, element, element_size};
+        }
+
+        auto [kind, size]{parse_elementary(type)};
+        return Param{kind, size, Kind::Uint, 0};
+      }
+
+      /** `std::string_view::find`, which some sanitizer builds can't evaluate at compile time. */
+      constexpr size_t find(std::string_view text, char c) noexcept {
+        for (size_t i = 0; i < text.size(); i++) {
+          if (text[i] == c) return i;
+        }
+        return std::string_view::npos;
+      }
+
+      /** @return The text between the parentheses of a signature. */
+      constexpr std::string_view param_list(std::string_view signature) {
+        auto open{find(signature, '(')};
+        if (open == 0 || open == std::string_view::npos || !signature.ends_with(')')) {
+          throw std::invalid_argument("signature must look like name(type,...)");
+        }
+        return signature.substr(open + 1, signature.size() - open - 2);
+      }
+
+      constexpr size_t count_params(std::string_view signature) {
+        auto list{param_list(signature)};
+        if (list.empty()) {
+          return 0;
+        }
+        return static_cast<size_t>(std::count(list.begin(), list.end(), ',')) + 1;
+      }
+
+      template <size_t Count> constexpr std::array<Param, Count> parse_params(
+          std::string_view signature) {
+        auto list{param_list(signature)};
+        std::array<Param, Count> params{};
+
+        for (size_t i = 0; i < Count; i++) {
+          auto comma{find(list, ',')};
+          params[i] = parse_param(list.substr(0, comma));
+          list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+        }
+
+        return params;
+      }
+
+      template <Kind K, unsigned Size> struct Value {
+        using type = intx::uint256;
+      };
+      template <unsigned Size> struct Value<Kind::Address, Size> {
+        using type = Address;
+      };
+      template <unsigned Size> struct Value<Kind::Bool, Size> {
+        using type = bool;
+      };
+      template <unsigned Size> struct Value<Kind::FixedBytes, Size> {
+        using type = std::array<uint8_t, Size>;
+      };
+      template <unsigned Size> struct Value<Kind::Bytes, Size> {
+        using type = std::span<const uint8_t>;
+      };
+      template <unsigned Size> struct Value<Kind::String, Size> {
+        using type = std::string_view;
+      };
+
+      template <Param P> struct ParamValue {
+        using type = typename Value<P.kind, P.size>::type;
+      };
+      template <Param P>
+        requires(P.kind == Kind::Array)
+      struct ParamValue<P> {
+        using type = std::vector<typename Value<P.element, P.element_size>::type>;
+      };
+
+      /** @return The value of the word at `pos`, if it fits in 32 bits. */
+      inline std::optional<size_t> read_size(std::span<const uint8_t> data, size_t pos) noexcept {
+        if (pos > data.size() || data.size() - pos < WORD_SIZE) {
+          return std::nullopt;
+        }
+
+        const auto* word{data.data() + pos};
+        for (size_t i = 0; i < WORD_SIZE - 4; i++) {
+          if (word[i] != 0) return std::nullopt;
+        }
+        return Selector::from_bytes(word + WORD_SIZE - 4).value;
+      }
+
+      /** Reads a static value from the word at `pos`, rejecting badly padded words. */
+      template <Kind K, unsigned Size>
+      bool read_static(std::span<const uint8_t> data, size_t pos,
+                       typename Value<K, Size>::type& out) noexcept {
+        if (pos > data.size() || data.size() - pos < WORD_SIZE) {
+          return false;
+        }
+        const auto* word{data.data() + pos};
+
+        if constexpr (K == Kind::Address || K == Kind::Uint || K == Kind::Bool) {
+          // Right-aligned values are padded with zeroes on the left.
+          constexpr size_t padding{K == Kind::Bool ? WORD_SIZE - 1 : WORD_SIZE - Size / 8};
+          if (!std::all_of(word, word + padding, [](uint8_t byte) { return byte == 0; })) {
+            return false;
+          }
+
+          if constexpr (K == Kind::Address) {
+            std::copy_n(word + padding, out.bytes.size(), out.bytes.begin());
+          } else if constexpr (K == Kind::Bool) {
+            if (word[padding] > 1) return false;
+            out = word[padding] == 1;
+          } else {
+            out = intx::be::unsafe::load<intx::uint256>(word);
+          }
+        } else if constexpr (K == Kind::Int) {
+          // Signed values are sign-extended on the left.
+          constexpr size_t padding{WORD_SIZE - Size / 8};
+          if constexpr (padding != 0) {
+            const uint8_t sign{static_cast<uint8_t>(word[padding] & 0x80 ? 0xff : 0x00)};
+            if (!std::all_of(word, word + padding, [&](uint8_t byte) { return byte == sign; })) {
+              return false;
+            }
+          }
+          out = intx::be::unsafe::load<intx::uint256>(word);
+        } else if constexpr (K == Kind::FixedBytes) {
+          // Left-aligned values are padded with zeroes on the right.
+          if (!std::all_of(word + Size, word + WORD_SIZE, [](uint8_t byte) { return byte == 0; })) {
+            return false;
+          }
+          std::copy_n(word, Size, out.begin());
+        }
+
+        return true;
+      }
+
+      /**
+       * Reads a `bytes` or `string` value whose length word is at `pos`, or any other value from
+       * the word at `pos`. Offsets of dynamic values are relative to `base`.
+       */
+      template <Kind K, unsigned Size>
+      bool read_value(std::span<const uint8_t> data, size_t pos,
+                      typename Value<K, Size>::type& out) noexcept {
+        if constexpr (K == Kind::Bytes || K == Kind::String) {
+          auto length{read_size(data, pos)};
+          if (!length || *length > data.size() - pos - WORD_SIZE) {
+            return false;
+          }
+
+          auto bytes{data.subspan(pos + WORD_SIZE, *length)};
+          if constexpr (K == Kind::String) {
+            out = std::string_view{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+          } else {
+            out = bytes;
+          }
+          return true;
+        } else {
+          return read_static<K, Size>(data, pos, out);
+        }
+      }
+
+      constexpr bool is_dynamic(Kind kind) noexcept {
+        return kind == Kind::Bytes || kind == Kind::String || kind == Kind::Array;
+      }
+
+      /** Reads the param whose head is at `head`, with offsets relative to `base`. */
+      template <Param P>
+      bool read_param(std::span<const uint8_t> data, size_t base, size_t head,
+                      typename ParamValue<P>::type& out) {
+        if constexpr (!is_dynamic(P.kind)) {
+          return read_static<P.kind, P.size>(data, head, out);
+        } else {
+          auto offset{read_size(data, head)};
+          if (!offset || *offset > data.size() - base) {
+            return false;
+          }
+          const size_t tail{base + *offset};
+
+          if constexpr (P.kind != Kind::Array) {
+            return read_value<P.kind, P.size>(data, tail, out);
+          } else {
+            auto count{read_size(data, tail)};
+            const size_t elements{tail + WORD_SIZE};
+            // Every element takes at least one word, which also bounds the allocation.
+            if (!count || *count > (data.size() - elements) / WORD_SIZE) {
+              return false;
+            }
+
+            out.resize(*count);
+            for (size_t i = 0; i < *count; i++) {
+              size_t pos{elements + i * WORD_SIZE};
+
+              if constexpr (is_dynamic(P.element)) {
+                auto element_offset{read_size(data, pos)};
+                if (!element_offset || *element_offset > data.size() - elements) {
+                  return false;
+                }
+                pos = elements + *element_offset;
+              }
+
+              if (!read_value<P.element, P.element_size>(data, pos, out[i])) {
+                return false;
+              }
+            }
+            return true;
+          }
+        }
+      }
+    }  // namespace detail
+
+    /**
+     * @brief A decoder for one signature, generated at compile time.
+     *
+     * @tparam S The canonical signature, without spaces or parameter names, e.g.
+     * `"transferFrom(address,address,uint256)"`.
+     */
+    template <Signature S> struct decoder {
+      /** The canonical signature. */
+      static constexpr std::string_view signature{S.view()};
+
+      /** The selector of the signature. */
+      static constexpr Selector selector{
+          Selector::from_bytes(keccak::keccak256(S.view()).data())};
+
+      /** The parsed param types. */
+      static constexpr auto params{
+          detail::parse_params<detail::count_params(S.view())>(S.view())};
+
+    private:
+      template <size_t... I> static auto values_of(std::index_sequence<I...>)
+          -> std::tuple<typename detail::ParamValue<params[I]>::type...>;
+
+    public:
+      /** The decoded params, one tuple element per param. */
+      using values = decltype(values_of(std::make_index_sequence<params.size()>{}));
+
+      /**
+       * @brief Decodes calldata of this signature.
+       *
+       * @param calldata The raw calldata bytes. `bytes` and `string` values refer into them.
+       * @return The decoded params, or `std::nullopt` if the selector differs or the calldata
+       * isn't a valid encoding of the signature.
+       */
+      [[nodiscard]] static std::optional<values> decode(std::span<const uint8_t> calldata) {
+        if (calldata.size() < SELECTOR_SIZE
+            || Selector::from_bytes(calldata.data()) != selector) {
+          return std::nullopt;
+        }
+
+        auto args{calldata.subspan(SELECTOR_SIZE)};
+        if (args.size() < params.size() * WORD_SIZE) {
+          return std::nullopt;
+        }
+
+        values decoded{};
+        if (!read_all(args, decoded, std::make_index_sequence<params.size()>{})) {
+          return std::nullopt;
+        }
+        return decoded;
+      }
+
+    private:
+      template <size_t... I>
+      static bool read_all(std::span<const uint8_t> args, values& decoded,
+                           std::index_sequence<I...>) {
+        return (detail::read_param<params[I]>(args, 0, I * WORD_SIZE, std::get<I>(decoded))
+                && ...);
+      }
+    };
+
+    /**
+     * @brief Dispatches calldata to the decoder of its selector.
+     *
+     * @tparam Decoders `decoder` types with distinct selectors.
+     */
+    template <typename... Decoders> struct Dispatcher {
+    private:
+      static constexpr bool distinct() noexcept {
+        std::array<uint32_t, sizeof...(Decoders)> selectors{Decoders::selector.value...};
+        std::sort(selectors.begin(), selectors.end());
+        return std::adjacent_find(selectors.begin(), selectors.end()) == selectors.end();
+      }
+      static_assert(distinct(), "decoders must have distinct selectors");
+
+    public:
+      /**
+       * @brief Decodes calldata with the decoder of its selector and passes the result on.
+       *
+       * @param calldata The raw calldata bytes.
+       * @param visitor Called as `visitor(Decoder{}, values)` with the matching decoder.
+       * @return Whether a decoder matched and decoded the calldata. If not, fall back to the
+       * heuristic Calldata decoder.
+       */
+      template <typename Visitor>
+      static bool visit(std::span<const uint8_t> calldata, Visitor&& visitor) {
+        if (calldata.size() < SELECTOR_SIZE) {
+          return false;
+        }
+
+        const Selector selector{Selector::from_bytes(calldata.data())};
+        bool handled{false};
+
+        // Compares against each selector constant in turn, which compilers lower like a switch.
+        static_cast<void>(((selector == Decoders::selector
+                            && (handled = dispatch<Decoders>(calldata, visitor), true))
+                           || ...));
+        return handled;
+      }
+
+      /** @return Whether a decoder handles `selector`. */
+      [[nodiscard]] static constexpr bool contains(const Selector selector) noexcept {
+        return ((selector == Decoders::selector) || ...);
+      }
+
+    private:
+      template <typename Decoder, typename Visitor>
+      static bool dispatch(std::span<const uint8_t> calldata, Visitor& visitor) {
+        auto decoded{Decoder::decode(calldata)};
+        if (!decoded) {
+          return false;
+        }
+
+        visitor(Decoder{}, *decoded);
+        return true;
+      }
+    };
+
+    /** Decoders for the most common ERC-20, multicall and Uniswap V2 router calls. */
+    using CommonDecoders = Dispatcher<
+        decoder<"transfer(address,uint256)">, decoder<"approve(address,uint256)">,
+        decoder<"transferFrom(address,address,uint256)">, decoder<"multicall(bytes[])">,
+        decoder<"multicall(uint256,bytes[])">,
+        decoder<"swapExactTokensForTokens(uint256,uint256,address[],address,uint256)">,
+        decoder<"swapTokensForExactTokens(uint256,uint256,address[],address,uint256)">,
+        decoder<"swapExactETHForTokens(uint256,address[],address,uint256)">,
+        decoder<"swapExactTokensForETH(uint256,uint256,address[],address,uint256)">>;
+
+  }  // namespace typed_decoder
+}  // namespace evmtools
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/hex.h>
+
+#include <span>
+
+namespace evmtools {
+  /**
+   * @brief Classifies every word of a calldata at once.
+   *
+   * The words are read as contiguous 32-byte lanes. Each lane is compared against zero, 0xff and
+   * two thresholds in a single pass, and the candidate types are picked from the resulting byte
+   * masks in the same order as `calldata_decoder::get_param_type`, whose results they match bit
+   * for bit.
+   */
+  namespace word_classifier {
+    using calldata_decoder::ParamTypes;
+    using calldata_decoder::Word;
+    // The classifier kernels need the same instruction sets as the hex kernels.
+    using hex::Kernel;
+
+    static_assert(sizeof(Word) == calldata_decoder::WORD_SIZE, "Words must be contiguous lanes");
+
+    /**
+     * @brief Gets the potential types of every word, using the fastest supported kernel.
+     *
+     * @note `out` must hold at least `words.size()` entries.
+     *
+     * @param words The words to be classified.
+     * @param out The buffer the types of each word are written to.
+     */
+    void classify(std::span<const Word> words, std::span<ParamTypes> out) noexcept;
+
+    /**
+     * @brief Gets the potential types of every word using a specific kernel.
+     *
+     * @note Falls back to Kernel::Scalar if `kernel` isn't supported by the current CPU.
+     *
+     * @param words The words to be classified.
+     * @param out The buffer the types of each word are written to.
+     * @param kernel The kernel to classify with.
+     */
+    void classify(std::span<const Word> words, std::span<ParamTypes> out,
+                  const Kernel kernel) noexcept;
+
+  }  // namespace word_classifier
+}  // namespace evmtools
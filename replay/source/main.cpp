@@ -0,0 +1,155 @@
+#include <evmtools/mapped_file.h>
+#include <evmtools/replay.h>
+#include <evmtools/version.h>
+
+#include <chrono>
+#include <cxxopts.hpp>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace evmtools::replay;
+
+namespace {
+  double to_us(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::micro>{duration}.count();
+  }
+
+  void write_text(std::ostream& out, double speed, const ReplayReport& report,
+                  const LatencySummary& latency, std::optional<double> max_throughput) {
+    out.setf(std::ios::fixed);
+    out.precision(1);
+
+    out << "replayed " << report.inputs << " records at ";
+    if (speed > 0) {
+      out << speed << "x";
+    } else {
+      out << "full speed";
+    }
+    out << " in " << std::chrono::duration<double>{report.elapsed}.count() << " s ("
+        << report.throughput() << " records/s), " << report.decoded << " decoded\n";
+
+    out << "latency: p50 " << to_us(latency.p50) << " us, p99 " << to_us(latency.p99)
+        << " us, p999 " << to_us(latency.p999) << " us, max " << to_us(latency.max)
+        << " us, mean " << to_us(latency.mean) << " us\n";
+
+    if (max_throughput) {
+      out << "max throughput: " << *max_throughput << " records/s\n";
+    }
+  }
+
+  void write_json(std::ostream& out, double speed, const ReplayReport& report,
+                  const LatencySummary& latency, std::optional<double> max_throughput) {
+    out.precision(6);
+    out << "{\"version\":\"" << EVMTOOLS_VERSION << "\",\"speed\":" << speed
+        << ",\"records\":" << report.inputs << ",\"decoded\":" << report.decoded
+        << ",\"elapsed_ns\":" << report.elapsed.count()
+        << ",\"throughput\":" << report.throughput() << ",\"latency_ns\":{\"p50\":"
+        << latency.p50.count() << ",\"p99\":" << latency.p99.count()
+        << ",\"p999\":" << latency.p999.count() << ",\"max\":" << latency.max.count()
+        << ",\"mean\":" << latency.mean.count() << "}";
+
+    if (max_throughput) {
+      out << ",\"max_throughput\":" << *max_throughput;
+    }
+    out << "}\n";
+  }
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  cxxopts::Options options(*argv, "Replays recorded transactions into the calldata decoder");
+
+  std::string input;
+  std::string output;
+  std::string format;
+  ReplayOptions replay_options{};
+
+  // clang-format off
+  options.add_options()
+    ("h,help", "Show help")
+    ("i,input", "Recording with a timestamp in microseconds and a hex string or JSON object with "
+     "an `input` field per line", cxxopts::value(input))
+    ("s,speed", "How many times faster than recorded to replay, 0 for as fast as possible",
+     cxxopts::value(replay_options.speed)->default_value("1"))
+    ("t,threads", "Number of decoder threads, 0 for one per hardware thread",
+     cxxopts::value(replay_options.threads)->default_value("0"))
+    ("b,batch", "Most due records handed to a decoder thread at once",
+     cxxopts::value(replay_options.batch_size)->default_value("64"))
+    ("paced-only", "Skip the second, unpaced replay that measures the max throughput")
+    ("max-depth", "Deepest nesting of calls to decode",
+     cxxopts::value(replay_options.decode.max_depth)->default_value("64"))
+    ("max-steps", "Most units of work per input, about one per word; inputs over it are errors",
+     cxxopts::value(replay_options.decode.max_steps))
+    ("max-memory", "Most bytes of decoded data per input; inputs over it are errors",
+     cxxopts::value(replay_options.decode.max_memory))
+    ("steps-per-byte", "Units of work allowed per byte of input, if fewer than --max-steps",
+     cxxopts::value(replay_options.decode.steps_per_byte)->default_value("8"))
+    ("memory-per-byte", "Bytes of decoded data allowed per byte of input, if fewer than "
+     "--max-memory", cxxopts::value(replay_options.decode.memory_per_byte)->default_value("128"))
+    ("f,format", "Output format: text or json", cxxopts::value(format)->default_value("text"))
+    ("o,output", "File to write results to, instead of stdout", cxxopts::value(output))
+  ;
+  // clang-format on
+
+  options.parse_positional({"input"});
+  options.positional_help("<recording>");
+
+  auto result = options.parse(argc, argv);
+
+  if (result["help"].as<bool>()) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  if (input.empty()) {
+    std::cerr << options.help() << std::endl;
+    return 1;
+  }
+
+  if (format != "text" && format != "json") {
+    std::cerr << "unknown format " << format << std::endl;
+    return 1;
+  }
+
+  try {
+    evmtools::mapped_file::MappedFile file{input};
+    auto records{parse_records(file.text())};
+    if (records.empty()) {
+      std::cerr << "no records in " << input << std::endl;
+      return 1;
+    }
+
+    auto report{replay(records, replay_options)};
+    auto latency{summarize(report.latencies)};
+
+    // A replay at full speed already measured the most the decoder sustains.
+    std::optional<double> max_throughput;
+    if (replay_options.speed > 0 && !result["paced-only"].as<bool>()) {
+      ReplayOptions unpaced{replay_options};
+      unpaced.speed = 0;
+      max_throughput = replay(records, unpaced).throughput();
+    }
+
+    std::ofstream output_file;
+    if (!output.empty()) {
+      output_file.open(output);
+      if (!output_file) {
+        std::cerr << "failed to open " << output << std::endl;
+        return 1;
+      }
+    }
+    std::ostream& out{output.empty() ? std::cout : output_file};
+
+    if (format == "json") {
+      write_json(out, replay_options.speed, report, latency, max_throughput);
+    } else {
+      write_text(out, replay_options.speed, report, latency, max_throughput);
+    }
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
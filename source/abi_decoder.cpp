@@ -0,0 +1,708 @@
+#include <evmtools/abi_decoder.h>
+#include <evmtools/mapped_file.h>
+#include <evmtools/signature_index.h>
+#include <evmtools/typed_decoder.h>
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+namespace evmtools {
+  namespace abi_decoder {
+    using calldata_decoder::SELECTOR_SIZE;
+    using calldata_decoder::WORD_SIZE;
+
+    namespace {
+      // Deepest nesting of JSON arrays and objects. Each tuple in a type takes two levels.
+      constexpr unsigned MAX_JSON_DEPTH{4 * AbiDecoder::MAX_DEPTH};
+
+      // Largest head of a static type, which bounds the fixed array lengths we accept.
+      constexpr uint64_t MAX_HEAD{uint64_t{1} << 24};
+
+      // ---- JSON ----
+
+      /** A parsed JSON value. Numbers are kept as their text, since ABIs don't need them. */
+      struct Json {
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        Type type{Type::Null};
+        std::string text;
+        std::vector<Json> items;
+        std::vector<std::pair<std::string, Json>> members;
+
+        /** @return The member called `key` of an object, or nullptr. */
+        [[nodiscard]] const Json* get(std::string_view key) const noexcept {
+          for (const auto& [name, value] : this->members) {
+            if (name == key) return &value;
+          }
+          return nullptr;
+        }
+
+        /** @return The string member called `key` of an object, or `fallback`. */
+        [[nodiscard]] std::string_view get_string(std::string_view key,
+                                                  std::string_view fallback = {}) const noexcept {
+          const auto* value{this->get(key)};
+          return value != nullptr && value->type == Type::String ? value->text : fallback;
+        }
+      };
+
+      /** A strict recursive descent JSON parser. */
+      class JsonParser {
+      public:
+        explicit JsonParser(std::string_view text) noexcept : text(text) {}
+
+        Json parse_document() {
+          auto value{this->parse_value(0)};
+          this->skip_whitespace();
+          if (this->pos != this->text.size()) {
+            this->fail("unexpected trailing characters");
+          }
+          return value;
+        }
+
+      private:
+        std::string_view text;
+        size_t pos{0};
+
+        [[noreturn]] void fail(const char* what) const {
+          throw std::invalid_argument("invalid ABI JSON: " + std::string{what} + " at offset "
+                                      + std::to_string(this->pos));
+        }
+
+        void skip_whitespace() noexcept {
+          while (this->pos < this->text.size()
+                 && (this->text[this->pos] == ' ' || this->text[this->pos] == '\t'
+                     || this->text[this->pos] == '\n' || this->text[this->pos] == '\r')) {
+            this->pos++;
+          }
+        }
+
+        bool consume(char c) noexcept {
+          this->skip_whitespace();
+          if (this->pos < this->text.size() && this->text[this->pos] == c) {
+            this->pos++;
+            return true;
+          }
+          return false;
+        }
+
+        void expect(char c) {
+          if (!this->consume(c)) {
+            this->fail(c == ':' ? "expected ':'" : "expected ',' or a closing bracket");
+          }
+        }
+
+        void expect_literal(std::string_view literal) {
+          if (this->text.substr(this->pos, literal.size()) != literal) {
+            this->fail("invalid literal");
+          }
+          this->pos += literal.size();
+        }
+
+        Json parse_value(unsigned depth) {
+          if (depth > MAX_JSON_DEPTH) {
+            this->fail("nested too deeply");
+          }
+
+          this->skip_whitespace();
+          if (this->pos == this->text.size()) {
+            this->fail("unexpected end of input");
+          }
+
+          Json value{};
+          switch (this->text[this->pos]) {
+            case '{':
+              this->pos++;
+              value.type = Json::Type::Object;
+              if (this->consume('}')) break;
+              do {
+                this->skip_whitespace();
+                auto key{this->parse_string()};
+                this->expect(':');
+                value.members.emplace_back(std::move(key), this->parse_value(depth + 1));
+              } while (this->consume(','));
+              this->expect('}');
+              break;
+            case '[':
+              this->pos++;
+              value.type = Json::Type::Array;
+              if (this->consume(']')) break;
+              do {
+                value.items.push_back(this->parse_value(depth + 1));
+              } while (this->consume(','));
+              this->expect(']');
+              break;
+            case '"':
+              value.type = Json::Type::String;
+              value.text = this->parse_string();
+              break;
+            case 't':
+              value.type = Json::Type::Bool;
+              this->expect_literal("true");
+              value.text = "true";
+              break;
+            case 'f':
+              value.type = Json::Type::Bool;
+              this->expect_literal("false");
+              break;
+            case 'n':
+              this->expect_literal("null");
+              break;
+            default:
+              value.type = Json::Type::Number;
+              value.text = this->parse_number();
+          }
+
+          return value;
+        }
+
+        std::string parse_number() {
+          auto start{this->pos};
+          while (this->pos < this->text.size()
+                 && std::string_view{"+-0123456789.eE"}.find(this->text[this->pos])
+                        != std::string_view::npos) {
+            this->pos++;
+          }
+          if (this->pos == start) {
+            this->fail("unexpected character");
+          }
+          return std::string{this->text.substr(start, this->pos - start)};
+        }
+
+        uint32_t parse_hex4() {
+          if (this->text.size() - this->pos < 4) {
+            this->fail("invalid unicode escape");
+          }
+
+          uint32_t value{0};
+          for (size_t i = 0; i < 4; i++) {
+            char c{this->text[this->pos++]};
+            if (!std::isxdigit(static_cast<unsigned char>(c))) {
+              this->fail("invalid unicode escape");
+            }
+            value = value << 4 | calldata_decoder::nibble_from_hex(c);
+          }
+          return value;
+        }
+
+        static void append_utf8(std::string& out, uint32_t code_point) {
+          if (code_point < 0x80) {
+            out += static_cast<char>(code_point);
+          } else if (code_point < 0x800) {
+            out += static_cast<char>(0xc0 | code_point >> 6);
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+          } else if (code_point < 0x10000) {
+            out += static_cast<char>(0xe0 | code_point >> 12);
+            out += static_cast<char>(0x80 | (code_point >> 6 & 0x3f));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+          } else {
+            out += static_cast<char>(0xf0 | code_point >> 18);
+            out += static_cast<char>(0x80 | (code_point >> 12 & 0x3f));
+            out += static_cast<char>(0x80 | (code_point >> 6 & 0x3f));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+          }
+        }
+
+        std::string parse_string() {
+          if (this->pos == this->text.size() || this->text[this->pos] != '"') {
+            this->fail("expected a string");
+          }
+          this->pos++;
+
+          std::string out;
+          while (true) {
+            if (this->pos == this->text.size()) {
+              this->fail("unterminated string");
+            }
+
+            char c{this->text[this->pos++]};
+            if (c == '"') {
+              return out;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+              this->fail("control character in string");
+            }
+            if (c != '\\') {
+              out += c;
+              continue;
+            }
+
+            if (this->pos == this->text.size()) {
+              this->fail("unterminated string");
+            }
+            switch (this->text[this->pos++]) {
+              case '"':
+                out += '"';
+                break;
+              case '\\':
+                out += '\\';
+                break;
+              case '/':
+                out += '/';
+                break;
+              case 'b':
+                out += '\b';
+                break;
+              case 'f':
+                out += '\f';
+                break;
+              case 'n':
+                out += '\n';
+                break;
+              case 'r':
+                out += '\r';
+                break;
+              case 't':
+                out += '\t';
+                break;
+              case 'u': {
+                auto code_point{this->parse_hex4()};
+                // Combine surrogate pairs; lone surrogates are kept as they are.
+                if (code_point >= 0xd800 && code_point < 0xdc00
+                    && this->text.substr(this->pos, 2) == "\\u") {
+                  auto saved{this->pos};
+                  this->pos += 2;
+                  auto low{this->parse_hex4()};
+                  if (low >= 0xdc00 && low < 0xe000) {
+                    code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+                  } else {
+                    this->pos = saved;
+                  }
+                }
+                append_utf8(out, code_point);
+                break;
+              }
+              default:
+                this->fail("invalid escape");
+            }
+          }
+        }
+      };
+
+      // ---- Compilation ----
+
+      [[noreturn]] void unsupported(std::string_view what, std::string_view type) {
+        throw std::invalid_argument("invalid ABI: " + std::string{what} + " in type "
+                                    + std::string{type});
+      }
+
+      /** Compiles an elementary type, `bytes` or `string` into `node`. */
+      std::string compile_elementary(std::string_view type, Instruction& node) {
+        using typed_decoder::Kind;
+
+        // Function pointers are an address followed by a selector.
+        if (type == "function") {
+          node.op = Op::FixedBytes;
+          node.size = 24;
+          return "function";
+        }
+
+        auto [kind, size]{typed_decoder::detail::parse_elementary(type)};
+        node.size = static_cast<uint16_t>(size);
+
+        switch (kind) {
+          case Kind::Address:
+            node.op = Op::Address;
+            return "address";
+          case Kind::Bool:
+            node.op = Op::Bool;
+            return "bool";
+          case Kind::Uint:
+            node.op = Op::Uint;
+            return "uint" + std::to_string(size);
+          case Kind::Int:
+            node.op = Op::Int;
+            return "int" + std::to_string(size);
+          case Kind::FixedBytes:
+            node.op = Op::FixedBytes;
+            return "bytes" + std::to_string(size);
+          case Kind::Bytes:
+            node.op = Op::Bytes;
+            return "bytes";
+          case Kind::String:
+            node.op = Op::String;
+            return "string";
+          case Kind::Array:
+            break;
+        }
+        unsupported("unsupported type", type);
+      }
+
+      std::string compile_param(Function& function, const Json& param, uint32_t depth);
+
+      /**
+       * Appends the subtree of a type to the plan, the array dimensions outermost first.
+       *
+       * @return The canonical type.
+       */
+      std::string compile_type(Function& function, std::string_view type, const Json& param,
+                               std::span<const std::optional<uint32_t>> dimensions,
+                               std::string name, uint32_t depth) {
+        if (depth > AbiDecoder::MAX_DEPTH) {
+          unsupported("nesting too deep", type);
+        }
+        function.depth = std::max(function.depth, depth);
+
+        const auto index{static_cast<uint32_t>(function.plan.size())};
+        function.plan.emplace_back();
+        function.names.push_back(std::move(name));
+
+        Instruction node{};
+        std::string canonical;
+
+        if (!dimensions.empty()) {
+          // `T[2][]` is a dynamic array of `T[2]`.
+          auto length{dimensions.back()};
+          auto element{compile_type(function, type, param, dimensions.first(dimensions.size() - 1),
+                                    {}, depth + 1)};
+          const auto& element_node{function.plan[index + 1]};
+
+          if (length) {
+            node.op = Op::FixedArray;
+            node.count = *length;
+            node.dynamic = element_node.dynamic;
+            uint64_t head{uint64_t{node.count} * std::max<uint64_t>(element_node.head, WORD_SIZE)};
+            if (head > MAX_HEAD) {
+              unsupported("fixed array too large", type);
+            }
+            node.head = node.dynamic ? WORD_SIZE : node.count * element_node.head;
+            canonical = element + "[" + std::to_string(*length) + "]";
+          } else {
+            node.op = Op::Array;
+            node.dynamic = true;
+            node.head = WORD_SIZE;
+            canonical = element + "[]";
+          }
+        } else if (type == "tuple") {
+          const auto* components{param.get("components")};
+          if (components == nullptr || components->type != Json::Type::Array
+              || components->items.empty()) {
+            unsupported("tuple without components", type);
+          }
+
+          node.op = Op::Tuple;
+          node.count = static_cast<uint32_t>(components->items.size());
+          canonical = "(";
+          uint64_t head{0};
+          for (const auto& component : components->items) {
+            auto child{static_cast<uint32_t>(function.plan.size())};
+            canonical += compile_param(function, component, depth + 1);
+            canonical += ',';
+            node.dynamic = node.dynamic || function.plan[child].dynamic;
+            head += function.plan[child].head;
+          }
+          canonical.back() = ')';
+
+          if (head > MAX_HEAD) {
+            unsupported("tuple too large", type);
+          }
+          node.head = node.dynamic ? WORD_SIZE : static_cast<uint32_t>(head);
+        } else {
+          canonical = compile_elementary(type, node);
+          node.dynamic = node.op == Op::Bytes || node.op == Op::String;
+          node.head = WORD_SIZE;
+        }
+
+        node.end = static_cast<uint32_t>(function.plan.size());
+        function.plan[index] = node;
+        return canonical;
+      }
+
+      /** Appends the subtree of an ABI param, e.g. `{"name":"to","type":"address"}`. */
+      std::string compile_param(Function& function, const Json& param, uint32_t depth) {
+        if (param.type != Json::Type::Object) {
+          throw std::invalid_argument("invalid ABI: param must be an object");
+        }
+
+        auto type{param.get_string("type")};
+        auto bracket{type.find('[')};
+        auto base{type.substr(0, bracket)};
+
+        std::vector<std::optional<uint32_t>> dimensions;
+        for (auto rest{type.substr(std::min(bracket, type.size()))}; !rest.empty();) {
+          auto close{rest.find(']')};
+          if (rest.front() != '[' || close == std::string_view::npos) {
+            unsupported("invalid array dimension", type);
+          }
+
+          auto digits{rest.substr(1, close - 1)};
+          if (digits.empty()) {
+            dimensions.emplace_back();
+          } else {
+            uint64_t length{0};
+            for (auto c : digits) {
+              if (c < '0' || c > '9' || length > MAX_HEAD) {
+                unsupported("invalid array dimension", type);
+              }
+              length = length * 10 + static_cast<uint64_t>(c - '0');
+            }
+            if (length == 0 || length > MAX_HEAD) {
+              unsupported("invalid array dimension", type);
+            }
+            dimensions.emplace_back(static_cast<uint32_t>(length));
+          }
+          rest.remove_prefix(close + 1);
+        }
+
+        return compile_type(function, base, param, dimensions,
+                            std::string{param.get_string("name")}, depth);
+      }
+
+      /** Compiles an ABI function entry. */
+      Function compile_function(const Json& entry) {
+        Function function{};
+        function.name = entry.get_string("name");
+        if (function.name.empty()) {
+          throw std::invalid_argument("invalid ABI: function without a name");
+        }
+
+        // The params form the root tuple, which unlike other tuples may be empty.
+        function.plan.emplace_back();
+        function.names.emplace_back();
+
+        Instruction root{Op::Tuple};
+        std::string params{"("};
+        uint64_t head{0};
+
+        if (const auto* inputs{entry.get("inputs")}; inputs != nullptr) {
+          if (inputs->type != Json::Type::Array) {
+            throw std::invalid_argument("invalid ABI: inputs must be an array");
+          }
+
+          for (const auto& input : inputs->items) {
+            auto child{static_cast<uint32_t>(function.plan.size())};
+            params += compile_param(function, input, 1);
+            params += ',';
+            root.dynamic = root.dynamic || function.plan[child].dynamic;
+            head += function.plan[child].head;
+          }
+          root.count = static_cast<uint32_t>(inputs->items.size());
+        }
+
+        if (params.size() > 1) {
+          params.pop_back();
+        }
+        params += ')';
+
+        root.head = static_cast<uint32_t>(std::min(head, MAX_HEAD));
+        root.end = static_cast<uint32_t>(function.plan.size());
+        function.plan[0] = root;
+
+        function.signature = function.name + params;
+        function.selector = signature_index::selector_from_signature(function.signature);
+        return function;
+      }
+
+      // ---- Decoding ----
+
+      /** @return The value of the word at `pos`, if it is within `data` and fits in 32 bits. */
+      std::optional<size_t> read_size(std::span<const uint8_t> data, size_t pos) noexcept {
+        if (pos > data.size() || data.size() - pos < WORD_SIZE) {
+          return std::nullopt;
+        }
+
+        const auto* word{data.data() + pos};
+        if (!std::all_of(word, word + WORD_SIZE - 4, [](uint8_t byte) { return byte == 0; })) {
+          return std::nullopt;
+        }
+        return Selector::from_bytes(word + WORD_SIZE - 4).value;
+      }
+
+      /** @return Whether `word` is a valid encoding of an elementary value of `node`. */
+      bool is_valid_word(const Instruction& node, const uint8_t* word) noexcept {
+        auto is_zero{[](uint8_t byte) { return byte == 0; }};
+
+        switch (node.op) {
+          case Op::Address:
+          case Op::Uint:
+            return std::all_of(word, word + WORD_SIZE - node.size / 8, is_zero);
+          case Op::Bool:
+            return std::all_of(word, word + WORD_SIZE - 1, is_zero) && word[WORD_SIZE - 1] <= 1;
+          case Op::Int: {
+            const size_t padding{WORD_SIZE - node.size / 8};
+            if (padding == 0) return true;
+            const uint8_t sign{static_cast<uint8_t>(word[padding] & 0x80 ? 0xff : 0x00)};
+            return std::all_of(word, word + padding, [&](uint8_t byte) { return byte == sign; });
+          }
+          case Op::FixedBytes:
+            return std::all_of(word + node.size, word + WORD_SIZE, is_zero);
+          default:
+            return false;
+        }
+      }
+
+      /** Runs a decode plan over the arguments of some calldata. */
+      class Interpreter {
+      public:
+        Interpreter(const Function& function, std::span<const uint8_t> args,
+                    std::pmr::vector<Value>& values) noexcept
+            : function(function),
+              args(args),
+              values(values),
+              // Valid encodings spend a word on each elementary value, length and offset, so
+              // this only stops offsets that point many heads at the same tail.
+              limit((args.size() / WORD_SIZE + 1) * (function.depth + 1)) {}
+
+        /**
+         * Decodes the node at `ip` whose head is at `head`, where offsets are relative to `base`.
+         * Heads of dynamic values are followed when `indirect`.
+         */
+        bool run(uint32_t ip, uint32_t parent, size_t base, size_t head, bool indirect) {
+          const auto& node{this->function.plan[ip]};
+          if (this->values.size() >= this->limit) {
+            return false;
+          }
+
+          size_t pos{head};
+          if (indirect) {
+            auto offset{read_size(this->args, head)};
+            if (!offset || base > this->args.size() || *offset > this->args.size() - base) {
+              return false;
+            }
+            pos = base + *offset;
+          }
+
+          const auto self{static_cast<uint32_t>(this->values.size())};
+          this->values.push_back(Value{ip, parent, node.op, this->function.names[ip], {}, 0});
+
+          switch (node.op) {
+            case Op::Bytes:
+            case Op::String: {
+              auto length{read_size(this->args, pos)};
+              if (!length || *length > this->args.size() - pos - WORD_SIZE) {
+                return false;
+              }
+              this->values[self].data = this->args.subspan(pos + WORD_SIZE, *length);
+              this->values[self].count = *length;
+              return true;
+            }
+            case Op::Array: {
+              auto count{read_size(this->args, pos)};
+              const size_t elements{pos + WORD_SIZE};
+              // Every element takes at least one word.
+              if (!count || *count > (this->args.size() - elements) / WORD_SIZE) {
+                return false;
+              }
+              this->values[self].count = *count;
+              return this->run_elements(ip, self, elements, *count);
+            }
+            case Op::FixedArray:
+              this->values[self].count = node.count;
+              return this->run_elements(ip, self, pos, node.count);
+            case Op::Tuple: {
+              this->values[self].count = node.count;
+              uint32_t child{ip + 1};
+              size_t offset{0};
+              for (uint32_t i = 0; i < node.count; i++) {
+                const auto& child_node{this->function.plan[child]};
+                if (!this->run(child, self, pos, pos + offset, child_node.dynamic)) {
+                  return false;
+                }
+                offset += child_node.head;
+                child = child_node.end;
+              }
+              return true;
+            }
+            default:
+              if (pos > this->args.size() || this->args.size() - pos < WORD_SIZE
+                  || !is_valid_word(node, this->args.data() + pos)) {
+                return false;
+              }
+              this->values[self].data = this->args.subspan(pos, WORD_SIZE);
+              return true;
+          }
+        }
+
+      private:
+        const Function& function;
+        std::span<const uint8_t> args;
+        std::pmr::vector<Value>& values;
+        size_t limit;
+
+        bool run_elements(uint32_t ip, uint32_t self, size_t base, size_t count) {
+          const auto& element{this->function.plan[ip + 1]};
+          for (size_t i = 0; i < count; i++) {
+            if (!this->run(ip + 1, self, base, base + i * element.head, element.dynamic)) {
+              return false;
+            }
+          }
+          return true;
+        }
+      };
+    }  // namespace
+
+    size_t AbiDecoder::load_json(std::string_view abi_json) {
+      auto document{JsonParser{abi_json}.parse_document()};
+
+      // Build artifacts (e.g. from Hardhat or Truffle) hold the ABI in their `abi` field.
+      const Json* abi{&document};
+      if (document.type == Json::Type::Object) {
+        abi = document.get("abi");
+      }
+      if (abi == nullptr || abi->type != Json::Type::Array) {
+        throw std::invalid_argument("invalid ABI: expected an array of entries");
+      }
+
+      // Compile everything before adding anything, so a bad ABI leaves the decoder unchanged.
+      std::vector<Function> compiled;
+      for (const auto& entry : abi->items) {
+        if (entry.type != Json::Type::Object) {
+          throw std::invalid_argument("invalid ABI: entries must be objects");
+        }
+        if (entry.get_string("type", "function") == "function") {
+          compiled.push_back(compile_function(entry));
+        }
+      }
+
+      size_t added{0};
+      for (auto& function : compiled) {
+        auto index{static_cast<uint32_t>(this->functions.size())};
+        if (this->by_selector.try_emplace(function.selector.value, index).second) {
+          this->functions.push_back(std::move(function));
+          added++;
+        }
+      }
+      return added;
+    }
+
+    size_t AbiDecoder::load_file(const std::filesystem::path& path) {
+      mapped_file::MappedFile file{path};
+      return this->load_json(file.text());
+    }
+
+    const Function* AbiDecoder::find(const Selector selector) const noexcept {
+      auto found{this->by_selector.find(selector.value)};
+      return found == this->by_selector.end() ? nullptr : &this->functions[found->second];
+    }
+
+    std::optional<DecodedCall> AbiDecoder::decode(std::span<const uint8_t> calldata,
+                                                  allocator_type alloc) const {
+      if (calldata.size() < SELECTOR_SIZE) {
+        return std::nullopt;
+      }
+
+      const auto* function{this->find(Selector::from_bytes(calldata.data()))};
+      if (function == nullptr) {
+        return std::nullopt;
+      }
+
+      DecodedCall decoded{function, std::pmr::vector<Value>(alloc)};
+      decoded.values.reserve(function->plan.size());
+
+      Interpreter interpreter{*function, calldata.subspan(SELECTOR_SIZE), decoded.values};
+      if (!interpreter.run(0, Value::NO_PARENT, 0, 0, false)) {
+        return std::nullopt;
+      }
+      return decoded;
+    }
+
+    std::optional<DecodedCall> AbiDecoder::decode(const calldata_decoder::Calldata& calldata,
+                                                  allocator_type alloc) const {
+      return this->decode(calldata.calldata, alloc);
+    }
+
+    size_t AbiDecoder::size() const noexcept { return this->functions.size(); }
+
+  }  // namespace abi_decoder
+}  // namespace evmtools
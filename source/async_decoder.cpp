@@ -0,0 +1,205 @@
+#include <evmtools/async_decoder.h>
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+namespace evmtools {
+  namespace async_decoder {
+    namespace {
+      // The decoder whose thread this is, if any.
+      thread_local const AsyncDecoder* current_decoder{nullptr};
+    }  // namespace
+
+    AsyncDecoder::AsyncDecoder(const AsyncOptions& options)
+        : decode_options(options.decode),
+          jobs(options.queue_capacity),
+          completions(options.completion_capacity) {
+      size_t threads{options.threads};
+      if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+      }
+
+      this->workers.reserve(threads);
+      for (size_t i = 0; i < threads; i++) {
+        this->workers.emplace_back([this] { this->worker_loop(); });
+      }
+    }
+
+    AsyncDecoder::~AsyncDecoder() {
+      this->stopping.store(true, std::memory_order_release);
+      this->epoch.fetch_add(1, std::memory_order_release);
+      this->epoch.notify_all();
+      this->completion_room.fetch_add(1, std::memory_order_release);
+      this->completion_room.notify_all();
+
+      for (auto& worker : this->workers) {
+        worker.join();
+      }
+    }
+
+    bool AsyncDecoder::try_submit(std::vector<uint8_t>&& input, Callback&& callback) {
+      Job job{std::move(input), std::move(callback), 0};
+      if (this->try_push(std::move(job))) {
+        return true;
+      }
+
+      // Hand the input back, as if it was never taken.
+      input = std::move(job.input);
+      callback = std::move(job.callback);
+      return false;
+    }
+
+    void AsyncDecoder::submit(std::vector<uint8_t> input, Callback callback) {
+      this->push(Job{std::move(input), std::move(callback), 0});
+    }
+
+    std::future<Decoded> AsyncDecoder::submit(std::vector<uint8_t> input) {
+      // Callbacks must be copyable, so the promise is shared.
+      auto promise{std::make_shared<std::promise<Decoded>>()};
+      auto future{promise->get_future()};
+      this->submit(std::move(input), [promise](Decoded&& decoded) {
+        promise->set_value(std::move(decoded));
+      });
+      return future;
+    }
+
+    AsyncDecoder::Awaitable AsyncDecoder::decode(std::vector<uint8_t> input) {
+      return Awaitable{*this, std::move(input)};
+    }
+
+    void AsyncDecoder::Awaitable::await_suspend(std::coroutine_handle<> handle) {
+      this->decoder.submit(std::move(this->input), [this, handle](Decoded&& result) {
+        this->decoded = std::move(result);
+        handle.resume();
+      });
+    }
+
+    bool AsyncDecoder::try_submit_tagged(std::vector<uint8_t>&& input, uint64_t tag) {
+      Job job{std::move(input), {}, tag};
+      if (this->try_push(std::move(job))) {
+        return true;
+      }
+
+      input = std::move(job.input);
+      return false;
+    }
+
+    void AsyncDecoder::submit_tagged(std::vector<uint8_t> input, uint64_t tag) {
+      this->push(Job{std::move(input), {}, tag});
+    }
+
+    size_t AsyncDecoder::poll(std::vector<Completion>& out, size_t max) {
+      size_t count{0};
+      for (; count < max; count++) {
+        auto completion{this->completions.try_pop()};
+        if (!completion) {
+          break;
+        }
+        out.push_back(std::move(*completion));
+      }
+
+      if (count != 0) {
+        this->completion_room.fetch_add(1, std::memory_order_release);
+        this->completion_room.notify_all();
+      }
+      return count;
+    }
+
+    size_t AsyncDecoder::pending() const noexcept {
+      return this->queued.load(std::memory_order_relaxed);
+    }
+
+    bool AsyncDecoder::try_push(Job&& job) {
+      // Count the job first, so `pending` never drops below zero.
+      this->queued.fetch_add(1, std::memory_order_relaxed);
+      if (!this->jobs.try_push(std::move(job))) {
+        this->queued.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+      }
+
+      this->epoch.fetch_add(1, std::memory_order_release);
+      this->epoch.notify_one();
+      return true;
+    }
+
+    void AsyncDecoder::push(Job&& job) {
+      while (true) {
+        // Read before trying, so a job taken after a failed try still wakes the wait below.
+        const auto seen{this->job_room.load(std::memory_order_acquire)};
+        if (this->try_push(std::move(job))) {
+          return;
+        }
+
+        // A decoder thread (e.g. a resumed coroutine) that waited for room could wait forever if
+        // every decoder thread did, so it makes room itself.
+        if (current_decoder == this) {
+          if (auto queued_job = this->try_pop()) {
+            this->run(std::move(*queued_job));
+            continue;
+          }
+        }
+        this->job_room.wait(seen, std::memory_order_acquire);
+      }
+    }
+
+    std::optional<AsyncDecoder::Job> AsyncDecoder::try_pop() {
+      auto job{this->jobs.try_pop()};
+      if (job) {
+        this->job_room.fetch_add(1, std::memory_order_release);
+        this->job_room.notify_all();
+      }
+      return job;
+    }
+
+    void AsyncDecoder::run(Job&& job) {
+      auto result{calldata_decoder::try_decode(std::span<const uint8_t>{job.input},
+                                               this->decode_options)};
+      // Moving the input keeps its buffer, so the calldata still refers into it.
+      Decoded decoded{std::move(job.input), std::move(result)};
+
+      if (job.callback) {
+        try {
+          job.callback(std::move(decoded));
+        } catch (...) {
+          // Callbacks report their own errors.
+        }
+      } else {
+        Completion completion{job.tag, std::move(decoded)};
+        while (true) {
+          const auto seen{this->completion_room.load(std::memory_order_acquire)};
+          if (this->completions.try_push(std::move(completion))) {
+            break;
+          }
+          if (this->stopping.load(std::memory_order_acquire)) {
+            // Nobody may be left to poll.
+            break;
+          }
+          this->completion_room.wait(seen, std::memory_order_acquire);
+        }
+      }
+
+      this->queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void AsyncDecoder::worker_loop() {
+      current_decoder = this;
+
+      while (true) {
+        const auto seen{this->epoch.load(std::memory_order_acquire)};
+
+        if (auto job = this->try_pop()) {
+          this->run(std::move(*job));
+          continue;
+        }
+
+        if (this->stopping.load(std::memory_order_acquire)) {
+          return;
+        }
+
+        this->epoch.wait(seen, std::memory_order_acquire);
+      }
+    }
+
+  }  // namespace async_decoder
+}  // namespace evmtools
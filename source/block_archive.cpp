@@ -0,0 +1,266 @@
+#include <evmtools/block_archive.h>
+#include <evmtools/columnar.h>
+#include <evmtools/json_writer.h>
+#include <evmtools/thread_pool.h>
+#include <evmtools/transaction_decoder.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace evmtools {
+  namespace block_archive {
+    using calldata_decoder::Calldata;
+    using stream_decoder::OutputFormat;
+
+    namespace {
+      constexpr size_t LENGTH_PREFIX_SIZE{4};
+
+      /** What a task made of one block, waiting to be written. */
+      struct BlockResult {
+        bool malformed{false};
+        size_t transactions{0};
+        size_t decoded{0};
+        size_t skipped{0};
+        // The formatted text or NDJSON lines of the block.
+        std::string text;
+        // For columnar output, each transaction's position in the block and its calldata.
+        std::vector<std::pair<size_t, std::optional<Calldata>>> calls;
+        // Set if the task failed, e.g. ran out of memory.
+        std::exception_ptr error;
+      };
+
+      /**
+       * Holds the results of the `window` blocks after the last one written, so blocks that
+       * finish early wait for the ones before them.
+       */
+      class ReorderBuffer {
+      public:
+        explicit ReorderBuffer(size_t window) : slots(window) {}
+
+        void put(size_t sequence, BlockResult result) {
+          {
+            std::lock_guard lock{this->mutex};
+            this->slots[sequence % this->slots.size()] = std::move(result);
+          }
+          this->ready.notify_all();
+        }
+
+        /** Blocks until the result of block `sequence` is in. */
+        BlockResult take(size_t sequence) {
+          auto& slot{this->slots[sequence % this->slots.size()]};
+          std::unique_lock lock{this->mutex};
+          this->ready.wait(lock, [&] { return slot.has_value(); });
+          auto result{std::move(*slot)};
+          slot.reset();
+          return result;
+        }
+
+      private:
+        std::vector<std::optional<BlockResult>> slots;
+        std::mutex mutex;
+        std::condition_variable ready;
+      };
+
+      BlockResult decode_block(std::span<const uint8_t> encoded, const ArchiveOptions& options) {
+        BlockResult result{};
+
+        transaction_decoder::Block block;
+        try {
+          block = transaction_decoder::decode_block(encoded);
+        } catch (const std::invalid_argument&) {
+          result.malformed = true;
+          return result;
+        }
+        result.transactions = block.transactions.size();
+
+        // Text and NDJSON are formatted right away, so their decodes can share an arena.
+        const bool columnar{options.format == OutputFormat::Columnar};
+        thread_local calldata_decoder::DecodeArena arena{};
+        const std::string prefix{std::to_string(block.number) + ':'};
+        std::string label;
+
+        for (size_t i = 0; i < block.transactions.size(); i++) {
+          auto transaction{transaction_decoder::try_decode_transaction(block.transactions[i])};
+          if (transaction
+              && (transaction->is_create()
+                  || transaction->data.size() < calldata_decoder::SELECTOR_SIZE)) {
+            result.skipped++;
+            continue;
+          }
+
+          {
+            calldata_decoder::DecodeResult decoded{};
+            if (transaction) {
+              decoded = transaction_decoder::decode_calldata(
+                  *transaction, options.decode,
+                  columnar ? calldata_decoder::allocator_type{} : arena.allocator());
+            }
+            const Calldata* calldata{decoded.calldata ? &*decoded.calldata : nullptr};
+            result.decoded += calldata != nullptr ? 1 : 0;
+
+            if (options.format == OutputFormat::Json) {
+              json_writer::append_transaction_ndjson(result.text, block.number, i, calldata,
+                                                     options.signatures);
+            } else if (options.format == OutputFormat::Text) {
+              label = prefix + std::to_string(i);
+              stream_decoder::format_text(result.text, label, calldata, options.signatures);
+            } else {
+              result.calls.emplace_back(i, std::move(decoded.calldata));
+            }
+          }
+          arena.reset();
+        }
+
+        return result;
+      }
+    }  // namespace
+
+    BlockArchive::BlockArchive(const std::filesystem::path& path, ArchiveFormat format)
+        : format(format) {
+      std::vector<std::filesystem::path> paths;
+      if (std::filesystem::is_directory(path)) {
+        for (const auto& entry : std::filesystem::directory_iterator{path}) {
+          if (entry.is_regular_file()) {
+            paths.push_back(entry.path());
+          }
+        }
+        std::sort(paths.begin(), paths.end());
+      } else {
+        paths.push_back(path);
+      }
+
+      this->files.reserve(paths.size());
+      for (const auto& file_path : paths) {
+        this->files.emplace_back(file_path).advise_sequential();
+      }
+    }
+
+    std::optional<std::span<const uint8_t>> BlockArchive::next() {
+      while (this->file < this->files.size()
+             && this->offset == this->files[this->file].size()) {
+        this->file++;
+        this->offset = 0;
+      }
+      if (this->file == this->files.size()) {
+        return std::nullopt;
+      }
+
+      auto rest{this->files[this->file].bytes().subspan(this->offset)};
+      size_t header{0};
+      size_t length{0};
+
+      if (this->format == ArchiveFormat::LengthPrefixed) {
+        if (rest.size() < LENGTH_PREFIX_SIZE) {
+          throw std::invalid_argument("truncated block length");
+        }
+        for (size_t i = LENGTH_PREFIX_SIZE; i-- != 0;) {
+          length = length << 8 | rest[i];
+        }
+        header = LENGTH_PREFIX_SIZE;
+        if (length > rest.size() - header) {
+          throw std::invalid_argument("block runs past the end of its file");
+        }
+      } else {
+        length = transaction_decoder::item_size(rest);
+      }
+
+      this->offset += header + length;
+      return rest.subspan(header, length);
+    }
+
+    void BlockArchive::rewind() noexcept {
+      this->file = 0;
+      this->offset = 0;
+    }
+
+    size_t BlockArchive::file_count() const noexcept { return this->files.size(); }
+
+    size_t BlockArchive::size() const noexcept {
+      size_t size{0};
+      for (const auto& file : this->files) size += file.size();
+      return size;
+    }
+
+    ArchiveStats decode_archive(BlockArchive& archive, std::ostream& out,
+                                const ArchiveOptions& options) {
+      ArchiveStats stats{};
+
+      std::optional<columnar::ColumnWriter> columns;
+      if (options.format == OutputFormat::Columnar) {
+        columns.emplace(out);
+      }
+
+      // Declared before the pool, so it outlives the tasks the pool's destructor still runs if
+      // writing fails.
+      std::optional<ReorderBuffer> reorder;
+      thread_pool::ThreadPool pool{options.threads};
+      const size_t window{options.window != 0 ? options.window : pool.size() * 4};
+      reorder.emplace(window);
+
+      size_t read{0};
+      size_t written{0};
+      size_t first_transaction{0};
+      bool more{true};
+
+      while (true) {
+        // Keep the pool busy without reading further ahead than the reorder buffer holds.
+        while (more && read < written + window) {
+          auto block{archive.next()};
+          if (!block) {
+            more = false;
+            break;
+          }
+
+          stats.bytes += block->size();
+          pool.submit([&reorder, &options, block = *block, sequence = read] {
+            BlockResult result{};
+            try {
+              result = decode_block(block, options);
+            } catch (...) {
+              result.error = std::current_exception();
+            }
+            reorder->put(sequence, std::move(result));
+          });
+          read++;
+        }
+
+        if (written == read) {
+          break;
+        }
+
+        auto result{reorder->take(written++)};
+        if (result.error) {
+          std::rethrow_exception(result.error);
+        }
+
+        stats.blocks++;
+        stats.malformed_blocks += result.malformed ? 1 : 0;
+        stats.transactions += result.transactions;
+        stats.decoded += result.decoded;
+        stats.skipped += result.skipped;
+
+        if (columns) {
+          for (const auto& [position, calldata] : result.calls) {
+            columns->append(first_transaction + position, calldata);
+          }
+        } else {
+          out.write(result.text.data(), static_cast<std::streamsize>(result.text.size()));
+        }
+        first_transaction += result.transactions;
+      }
+
+      if (columns) {
+        columns->flush();
+      }
+      out.flush();
+
+      return stats;
+    }
+
+  }  // namespace block_archive
+}  // namespace evmtools
@@ -1,311 +1,597 @@
 #include <evmtools/calldata_decoder.h>
+#include <evmtools/decode_stats.h>
+#include <evmtools/word_classifier.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <new>
+#include <stdexcept>
 
 // using namespace evmtools::calldata_decoder;
 
 namespace evmtools {
   namespace calldata_decoder {
-    ParamTypes::ParamTypes(std::vector<Types> types) : types(types) {}
+    namespace {
+      /** A run of ABI head words, whose offsets are relative to the first one. */
+      struct Region {
+        // Byte offset into the calldata of the first head word.
+        size_t begin;
+        // Byte offset into the calldata that no word of the region may extend past.
+        size_t end;
+        // Number of head words, if known.
+        size_t heads;
+        // Index into `nested_details` of the call whose params hold the region, or NO_PARENT for
+        // the main call.
+        uint32_t call;
+        // Depth of that call.
+        uint32_t depth;
+      };
+
+      // Flags kept by parse_raw_params for each 4-byte position of the calldata.
+      constexpr uint8_t SCANNED{1};
+      constexpr uint8_t RESOLVED{2};
+
+      /**
+       * @return The word at byte `pos` as a size, if the word ends before `end` and its value fits
+       * in 32 bits.
+       */
+      std::optional<size_t> read_size(std::span<const uint8_t> data, size_t pos,
+                                      size_t end) noexcept {
+        if (pos > end || end - pos < WORD_SIZE) {
+          return std::nullopt;
+        }
 
-    ParamTypes::ParamTypes(std::initializer_list<Types> types) : types(types) {}
+        const auto* word{data.data() + pos};
+        for (size_t i = 0; i < WORD_SIZE - SELECTOR_SIZE; i++) {
+          if (word[i] != 0) return std::nullopt;
+        }
 
-    ParamTypes::ParamTypes() = default;
+        return Selector::from_bytes(word + WORD_SIZE - SELECTOR_SIZE).value;
+      }
+
+      /** End of each nested call found so far, keyed by the index of its parent and its start. */
+      using CallSpans = std::pmr::map<std::pair<uint32_t, size_t>, size_t>;
 
-    ParamTypes::ParamTypes(const ParamTypes& other) = default;
+      /** @return Whether bytes `[begin, end)` overlap a call already found in `parent`. */
+      bool overlaps_sibling(const CallSpans& spans, uint32_t parent, size_t begin,
+                            size_t end) noexcept {
+        auto next{spans.lower_bound({parent, begin})};
+        if (next != spans.end() && next->first.first == parent && next->first.second < end) {
+          return true;
+        }
+        if (next != spans.begin()) {
+          auto previous{std::prev(next)};
+          return previous->first.first == parent && previous->second > begin;
+        }
+        return false;
+      }
 
-    ParamTypes::ParamTypes(ParamTypes&& other) = default;
+      /** @return `per_byte` for each byte of a `size`-byte input, capped at `max`. */
+      size_t scaled_budget(size_t max, size_t per_byte, size_t size) noexcept {
+        size = std::max(size, MIN_BUDGET_BYTES);
+        return per_byte > max / size ? max : per_byte * size;
+      }
 
-    ParamTypes& ParamTypes::operator=(const ParamTypes& other) = default;
-    ParamTypes& ParamTypes::operator=(ParamTypes&& other) = default;
+      bool is_plausible_selector(const Selector selector) noexcept {
+        return selector != constants::EMPTY_4_SELECTOR && selector != constants::MASK_4_SELECTOR;
+      }
 
-    ParamTypes::~ParamTypes() = default;
+      /** Replaces `words` with the 32-byte words of `data`, like `split_calldata`. */
+      void split_into(std::span<const uint8_t> data, std::pmr::vector<Word>& words) {
+        words.clear();
+        words.reserve((data.size() + WORD_SIZE - 1) / WORD_SIZE);
+        for (size_t i = 0; i < data.size(); i += WORD_SIZE) {
+          words.push_back(Word::from_bytes(data.subspan(i)));
+        }
+      }
 
-    Params::Params(const std::string_view selector, std::vector<std::string> params)
-        : selector(selector), params(params), param_types() {}
+      /** Decodes a hex string, with or without a `0x` prefix, into `bytes`. */
+      template <typename Bytes> void decode_hex_into(std::string_view hex, Bytes& bytes) {
+        size_t prefix{0};
+
+        // Remove the '0x' prefix
+        if (hex.starts_with("0x") || hex.starts_with("0X")) {
+          prefix = 2;
+          hex.remove_prefix(prefix);
+        }
+
+        if (hex.size() % 2 != 0) {
+          throw std::invalid_argument("hex string has an odd number of characters");
+        }
+
+        bytes.resize(hex.size() / 2);
+
+        if (auto invalid = hex::decode(hex, bytes)) {
+          throw std::invalid_argument("invalid hex character at index "
+                                      + std::to_string(*invalid + prefix));
+        }
+      }
+    }  // namespace
+
+    Params::Params(const Selector selector, std::span<const Word> params, allocator_type alloc)
+        : selector(selector),
+          params(params.begin(), params.end(), alloc),
+          offsets(alloc),
+          param_types(alloc) {}
 
     Params::Params() = default;
 
     Params::Params(const Params& other) = default;
 
-    Params::Params(Params&& other) = default;
+    Params::Params(Params&& other) noexcept = default;
 
     Params& Params::operator=(const Params& other) = default;
     Params& Params::operator=(Params&& other) = default;
 
     Params::~Params() = default;
 
-    Calldata::Calldata(const std::string_view calldata) : calldata(calldata) {
+    Params::Params(allocator_type alloc) : params(alloc), offsets(alloc), param_types(alloc) {}
+
+    Params::Params(const Params& other, allocator_type alloc)
+        : selector(other.selector),
+          params(other.params, alloc),
+          offsets(other.offsets, alloc),
+          param_types(other.param_types, alloc),
+          data(other.data),
+          parent(other.parent),
+          depth(other.depth) {}
+
+    Params::Params(Params&& other, allocator_type alloc)
+        : selector(other.selector),
+          params(std::move(other.params), alloc),
+          offsets(std::move(other.offsets), alloc),
+          param_types(std::move(other.param_types), alloc),
+          data(other.data),
+          parent(other.parent),
+          depth(other.depth) {}
+
+    Params::allocator_type Params::get_allocator() const noexcept {
+      return this->params.get_allocator();
+    }
+
+    ParamColumns Params::columns() const noexcept {
+      return ParamColumns{this->params, this->offsets, this->param_types};
+    }
+
+    Word Word::from_bytes(std::span<const uint8_t> data) noexcept {
+      Word word{};
+      std::copy_n(data.begin(), std::min(data.size(), WORD_SIZE), word.bytes.begin());
+      return word;
+    }
+
+    std::string Word::to_hex() const {
+      std::string hex(WORD_SIZE * 2, '0');
+      hex::encode(this->bytes, hex);
+      return hex;
+    }
+
+    std::string Selector::to_hex() const {
+      constexpr std::string_view digits{"0123456789abcdef"};
+      std::string hex(SELECTOR_SIZE * 2, '0');
+
+      for (size_t i = 0; i < SELECTOR_SIZE * 2; i++) {
+        hex[i] = digits[(this->value >> (28 - i * 4)) & 0x0f];
+      }
+
+      return hex;
+    }
+
+    Calldata::Calldata(const std::string_view calldata, allocator_type alloc)
+        : Calldata(calldata, DecodeOptions{}, alloc) {}
+
+    Calldata::Calldata(const std::string_view calldata, const DecodeOptions& options,
+                       allocator_type alloc)
+        : storage(alloc),
+          main_details(alloc),
+          raw_params(alloc),
+          params(alloc),
+          nested_details(alloc),
+          steps_left(scaled_budget(options.max_steps, options.steps_per_byte, calldata.size() / 2)),
+          memory_left(
+              scaled_budget(options.max_memory, options.memory_per_byte, calldata.size() / 2)) {
+      // Check the budget before decoding the hex, so huge inputs fail early.
+      this->charge(calldata.size() / (WORD_SIZE * 2), calldata.size() / 2);
+      decode_hex_into(calldata, this->storage);
+      this->calldata = this->storage;
+
       this->parse_selector();
-      this->parse_raw_params();
+      this->parse_raw_params(options);
       this->get_param_types();
     }
 
+    Calldata::Calldata(std::span<const uint8_t> calldata, allocator_type alloc)
+        : Calldata(calldata, DecodeOptions{}, alloc) {}
+
+    Calldata::Calldata(std::span<const uint8_t> calldata, const DecodeOptions& options,
+                       allocator_type alloc)
+        : storage(alloc),
+          calldata(calldata),
+          main_details(alloc),
+          raw_params(alloc),
+          params(alloc),
+          nested_details(alloc),
+          steps_left(scaled_budget(options.max_steps, options.steps_per_byte, calldata.size())),
+          memory_left(scaled_budget(options.max_memory, options.memory_per_byte, calldata.size())) {
+      this->parse_selector();
+      this->parse_raw_params(options);
+      this->get_param_types();
+    }
+
+    Calldata::Calldata(std::span<const std::byte> calldata, allocator_type alloc)
+        : Calldata(std::span<const uint8_t>{reinterpret_cast<const uint8_t*>(calldata.data()),
+                                            calldata.size()},
+                   alloc) {}
+
+    Calldata::Calldata(const Calldata& other)
+        : storage(other.storage),
+          calldata(other.calldata),
+          selector(other.selector),
+          main_details(other.main_details),
+          raw_params(other.raw_params),
+          params(other.params),
+          nested_details(other.nested_details),
+          truncated(other.truncated) {
+      this->rebase_views(other.storage.data());
+    }
+
+    Calldata::Calldata(Calldata&& other) noexcept = default;
+
+    Calldata& Calldata::operator=(const Calldata& other) {
+      if (this != &other) {
+        *this = Calldata{other};
+      }
+      return *this;
+    }
+
+    Calldata& Calldata::operator=(Calldata&& other) {
+      if (this != &other) {
+        // With different memory resources, `storage` is copied rather than taken over.
+        const uint8_t* old_base{other.storage.data()};
+
+        this->storage = std::move(other.storage);
+        this->calldata = other.calldata;
+        this->selector = other.selector;
+        this->main_details = std::move(other.main_details);
+        this->raw_params = std::move(other.raw_params);
+        this->params = std::move(other.params);
+        this->nested_details = std::move(other.nested_details);
+        this->truncated = other.truncated;
+
+        this->rebase_views(old_base);
+      }
+      return *this;
+    }
+
+    Calldata::~Calldata() = default;
+
+    void Calldata::rebase_views(const uint8_t* old_base) {
+      // Views into the caller's buffer stay valid as they are.
+      if (this->storage.empty()) {
+        return;
+      }
+
+      auto rebase{[&](std::span<const uint8_t>& view) {
+        view = {this->storage.data() + (view.data() - old_base), view.size()};
+      }};
+
+      rebase(this->calldata);
+      rebase(this->main_details.data);
+      for (auto& nested_params : this->nested_details) {
+        rebase(nested_params.data);
+      }
+    }
+
     void Calldata::parse_selector() {
-      // Remove the '0x' prefix
-      if (this->calldata.contains("0x")) {
-        this->calldata.erase(0, 2);
+      std::span<const uint8_t> bytes{this->calldata};
+      decode_stats::Scope stats{decode_stats::Phase::ParseSelector, bytes.size()};
+
+      if (bytes.size() < SELECTOR_SIZE) {
+        throw std::out_of_range("calldata is shorter than a method selector");
       }
 
-      // If calldata is of even length.
-      if (this->calldata.size() % 64 == 0) {
-        // Separate the calldata into 32-byte chunks.
-        this->raw_params = split_calldata(this->calldata, 64);
-        // Get function selector from the calldata as the first 4 bytes from the first chunk.
-        this->selector = this->raw_params.at(0).substr(0, 8);
-        // Remove the first 4 bytes from the first chunk.
-        this->raw_params.at(0).erase(0, 8);
+      const size_t words{(bytes.size() + WORD_SIZE - 1) / WORD_SIZE};
+      this->charge(words, words * (sizeof(Word) + sizeof(uint32_t)));
+
+      // Get function selector from the calldata as the first 4 bytes.
+      this->selector = Selector::from_bytes(bytes.data());
+      this->main_details.selector = this->selector;
+      this->main_details.data = bytes;
+
+      // If calldata is a whole number of words, keep the 32-byte grid of the calldata and only
+      // remove the selector from the first word.
+      const bool whole_words{bytes.size() % WORD_SIZE == 0};
+      if (whole_words) {
+        split_into(bytes, this->raw_params);
+        this->raw_params.at(0)
+            = Word::from_bytes(bytes.subspan(SELECTOR_SIZE, WORD_SIZE - SELECTOR_SIZE));
       }
-      // If calldata is of odd length.
+      // Otherwise, separate the params after the selector into 32-byte words.
       else {
-        // Separate the calldata into 1-byte chunks.
-        auto chunks{split_calldata(this->calldata, 2)};
-
-        // Manually create the 4-byte selector using the first 4 chunks.
-        this->selector = chunks.at(0) + chunks.at(1) + chunks.at(2) + chunks.at(3);
-
-        // Remove the first 4 chunks.
-        chunks.erase(chunks.begin(), chunks.begin() + 4);
-
-        // Create a new vector for the params, without the selector.
-        std::vector<std::string> param_list{""};
-
-        for (auto chunk : chunks) {
-          auto len{param_list.size() - 1};
-          // Check if we have the param.
-          if (param_list.at(len).size() == 64) {
-            // Add new param.
-            param_list.push_back("");
-            // Make sure we're pushing to new param.
-            len++;
-          }
-          param_list.at(len).append(chunk);
-        }
+        split_into(bytes.subspan(SELECTOR_SIZE), this->raw_params);
+      }
 
-        this->raw_params = param_list;
+      auto& offsets{this->main_details.offsets};
+      offsets.resize(this->raw_params.size());
+      for (size_t i = 0; i < offsets.size(); i++) {
+        offsets[i] = static_cast<uint32_t>(whole_words ? std::max(i * WORD_SIZE, SELECTOR_SIZE)
+                                                       : SELECTOR_SIZE + i * WORD_SIZE);
       }
     }
 
-    void Calldata::parse_raw_params() {
-      size_t i{0};
-      size_t skipping{0};
-      std::tuple<std::vector<std::string>, bool> params_to_parse{
-          std::make_tuple(std::vector<std::string>{this->raw_params}, false)};
-
-      // TODO...CREATE OFFSET STRUCT
-      // TODO...CREATE PC counter/offset identifier for when we reach it to set length
-      // ...
-      // - PC of offset (e.g.2nd param)
-      // - Offset value (e.g. 0x40)
-      // - Length       (e.g. 0x02); Default 0 until we reach the offset
-      using Offset = std::tuple<size_t, intx::uint256, size_t>;
-      std::vector<Offset> offsets;  // pc of offset + offset
-
-      while (i != this->raw_params.size()) {
-        if (skipping != 0) {
-          i += skipping;
-          skipping = 0;
-        }
+    void Calldata::parse_raw_params(const DecodeOptions& options) {
+      const std::span<const uint8_t> data{this->calldata};
+      decode_stats::Scope stats{decode_stats::Phase::ParseRawParams, data.size()};
+
+      // Flags for every 4-byte position of the calldata, so each word is scanned as a head and
+      // resolved as a tail at most once, however many offsets point at it.
+      this->charge(0, data.size() / SELECTOR_SIZE + 1);
+      std::pmr::vector<uint8_t> flags(data.size() / SELECTOR_SIZE + 1, 0, this->get_allocator());
+
+      // Regions are only ever appended, so this walks the offset graph breadth-first, and every
+      // nested call is recorded after the call it was found in.
+      std::pmr::vector<Region> regions(this->get_allocator());
+      regions.push_back({SELECTOR_SIZE, data.size(), SIZE_MAX, NO_PARENT, 0});
+
+      // Calls found in the same call never overlap, so each byte is copied into at most one
+      // nested call per level, however the offsets point.
+      CallSpans spans(this->get_allocator());
+
+      for (size_t r = 0; r < regions.size(); r++) {
+        const Region region{regions[r]};
+        // The heads end where the first tail starts.
+        size_t tail{region.end};
+
+        for (size_t head = 0; head < region.heads; head++) {
+          const size_t pos{region.begin + head * WORD_SIZE};
+          if (pos >= tail || tail - pos < WORD_SIZE || (flags[pos / SELECTOR_SIZE] & SCANNED)) {
+            break;
+          }
+          flags[pos / SELECTOR_SIZE] |= SCANNED;
+          this->charge(1, 0);
+
+          // Offsets are non-zero multiples of 32 pointing forward, at a length word.
+          auto offset{read_size(data, pos, region.end)};
+          if (!offset || *offset == 0 || *offset % WORD_SIZE != 0
+              || *offset >= region.end - region.begin) {
+            continue;
+          }
 
-        auto& params_vec{std::get<0>(params_to_parse)};
-        if (params_vec.at(i) == constants::EMPTY_32) {
-          params_vec = pad_chunk_left(params_vec, i);
-          i++;
-        }
+          const size_t target{region.begin + *offset};
+          auto length{read_size(data, target, region.end)};
+          if (target <= pos || !length) {
+            continue;
+          }
 
-        auto& raw_param{params_vec.at(i)};
-        auto trimmed{trim_zeroes(raw_param)};
-
-        // Check if param has selector in it.
-        auto parsed{try_parse_selector(raw_param)};
-        auto parsed_selector{std::get<0>(parsed)};
-
-        // If selector found.
-        if (parsed_selector != constants::EMPTY_4 && parsed_selector != constants::MASK_4) {
-          // Check if last param was a length type.
-          // They indicate the start of a dynamic type (string, bytes, or array).
-          if (auto last = previous_chunk(params_vec, i)) {
-            intx::uint256 value{uint_from_hex_str<256>(*last)};
-            // Extract selector + params.
-            if (auto skip = this->parse_len(params_vec, i, size_t(value))) {
-              auto rearranged{rearrange_chunks(params_vec, i, std::get<1>(parsed))};
-              params_to_parse = std::make_tuple(std::get<0>(rearranged), true);
-
-              // How many chars we skip next loop.
-              skipping = *skip;
-            }
+          tail = std::min(tail, target);
+          if (flags[target / SELECTOR_SIZE] & RESOLVED) {
+            continue;
           }
-        }
+          flags[target / SELECTOR_SIZE] |= RESOLVED;
+
+          const size_t payload{target + WORD_SIZE};
+          const size_t available{region.end - payload};
 
-        // Offsets/lengths never have selectors.
-        // Therefore, we check common offset/length sizes.
-        else if (trimmed.size() <= 4) {
-          // Check if value is for dynamic type.
-          intx::uint256 value{uint_from_hex_str<256>(raw_param)};
-          // Check if offset by checking if
-          // - below safety net length, since they probably wont go that high.
-          // - divisible by 32 bytes (0x20).
-          if (value < intx::uint256{i * 64 + 1920} && value % 64 == intx::uint256{0}) {
-            offsets.push_back(std::make_tuple(i, value / 64, 0));
+          // Bytes holding a selector and whole words are a nested call, whose own args may hold
+          // further offsets.
+          if (*length % WORD_SIZE == SELECTOR_SIZE && *length <= available
+              && is_plausible_selector(Selector::from_bytes(data.data() + payload))) {
+            if (overlaps_sibling(spans, region.call, payload, payload + *length)) {
+              continue;
+            }
+            if (region.depth >= options.max_depth
+                || this->nested_details.size() >= options.max_nested_calls) {
+              this->truncated = true;
+              continue;
+            }
+
+            // The checks above guarantee that parse_len records the call.
+            this->parse_len(payload, *length);
+            auto& call{this->nested_details.back()};
+            call.parent = region.call;
+            call.depth = region.depth + 1;
+            spans.emplace(std::pair{region.call, payload}, payload + *length);
+
+            this->charge(1, sizeof(Region) + sizeof(CallSpans::value_type));
+            regions.push_back({payload + SELECTOR_SIZE, payload + *length, *length / WORD_SIZE,
+                               static_cast<uint32_t>(this->nested_details.size() - 1),
+                               call.depth});
+          }
+          // Otherwise it may be an array, whose elements are heads relative to its first element.
+          else if (*length != 0 && *length <= available / WORD_SIZE) {
+            this->charge(1, sizeof(Region));
+            regions.push_back({payload, region.end, *length, region.call, region.depth});
           }
         }
-
-        i++;
       }
 
-      this->params = std::get<0>(params_to_parse);
+      // Nested calls are decoded from their own bytes, so the main params keep the ABI grid.
+      this->charge(this->raw_params.size(), this->raw_params.size() * sizeof(Word));
+      this->params = this->raw_params;
     }
 
     void Calldata::get_param_types() {
-      // If our main method calls other methods:
-      if (this->nested_details.size() > 0) {
-        for (auto& nested_params : this->nested_details) {
-          std::vector<ParamTypes> types;
+      decode_stats::Scope stats{decode_stats::Phase::GetParamTypes, 0};
 
-          for (auto param : nested_params.params) {
-            auto param_types{get_param_type(param)};
-            types.push_back(param_types);
-          }
+      auto get_types{[&](const std::pmr::vector<Word>& params,
+                         std::pmr::vector<ParamTypes>& types) {
+        this->charge(params.size(), params.size() * sizeof(ParamTypes));
+        types.resize(params.size());
+        stats.add_bytes(params.size() * WORD_SIZE);
 
-          nested_params.param_types = types;
-        }
+        // Every word of the call is classified in one pass.
+        word_classifier::classify(params, types);
+        for (auto param_types : types) decode_stats::count_types(param_types);
+      }};
+
+      // Every call gets its types, so the columns of each stay parallel.
+      get_types(this->params, this->main_details.param_types);
+
+      // If our main method calls other methods:
+      for (auto& nested_params : this->nested_details) {
+        get_types(nested_params.params, nested_params.param_types);
       }
-      // Else, our main method doesn't call anything else.
-      else {
-        std::vector<ParamTypes> types;
+    }
 
-        for (auto param : this->params) {
-          auto param_types{get_param_type(param)};
-          types.push_back(param_types);
-        }
+    ParamColumns Calldata::columns() const noexcept {
+      return ParamColumns{this->params, this->main_details.offsets,
+                          this->main_details.param_types};
+    }
 
-        this->main_details.param_types = types;
+    void Calldata::charge(size_t steps, size_t bytes) {
+      if (steps > this->steps_left) {
+        throw BudgetExceeded("decode exceeds its step budget");
       }
+      if (bytes > this->memory_left) {
+        throw BudgetExceeded("decode exceeds its memory budget");
+      }
+
+      this->steps_left -= steps;
+      this->memory_left -= bytes;
     }
 
-    std::optional<size_t> Calldata::parse_len(const std::vector<std::string>& params_64,
-                                              size_t from, size_t len) {
-      auto relevant_params{std::vector<std::string>{params_64.begin() + from, params_64.end()}};
-      auto relevant_calldata{join_strings(relevant_params)};
-      auto cut{relevant_calldata.substr(0, len * 2)};
-      size_t remainder{(len * 2) % 64};
+    Calldata::allocator_type Calldata::get_allocator() const noexcept {
+      return this->params.get_allocator();
+    }
+
+    std::optional<size_t> Calldata::parse_len(size_t offset, size_t len) {
+      decode_stats::Scope stats{decode_stats::Phase::ParseLen, len};
+
+      // If the length leaves 4 bytes after the last full word, we know it's a function.
+      if (len % WORD_SIZE == SELECTOR_SIZE) {
+        auto cut{this->calldata.subspan(std::min(offset, this->calldata.size()))};
+        cut = cut.first(std::min(len, cut.size()));
 
-      // If remainder is 8, we know it's a function.
-      if (remainder == 8) {
-        auto first_cut{cut.substr(0, 8)};
-        auto second_cut{cut.substr(8)};
-        auto new_params{split_calldata(second_cut, 64)};
+        if (cut.size() < SELECTOR_SIZE) {
+          return std::nullopt;
+        }
+
+        auto first_cut{Selector::from_bytes(cut.data())};
+
+        const size_t words{(cut.size() - SELECTOR_SIZE + WORD_SIZE - 1) / WORD_SIZE};
+        this->charge(words, sizeof(Params) + words * (sizeof(Word) + sizeof(uint32_t)));
 
         // Record params.
-        this->nested_details.push_back(Params{first_cut, new_params});
+        auto& nested_params{this->nested_details.emplace_back(first_cut, std::span<const Word>{})};
+        decode_stats::count_nested_call();
+        split_into(cut.subspan(SELECTOR_SIZE), nested_params.params);
+        nested_params.data = cut;
+
+        const size_t first_param{offset + SELECTOR_SIZE};
+        nested_params.offsets.resize(nested_params.params.size());
+        for (size_t i = 0; i < nested_params.offsets.size(); i++) {
+          nested_params.offsets[i] = static_cast<uint32_t>(first_param + i * WORD_SIZE);
+        }
 
         // If extracting only function.
-        if (len == 4) {
+        if (len == SELECTOR_SIZE) {
           return std::nullopt;
         }
 
-        return (len - 8) * 2 / 64;
+        return (len - 8) / WORD_SIZE;
       }
 
-      // TODO..FINISH THIS OFF
-      // How to cut out strings????
-      // If remainder is 56, probably a string/fn selector.
-      // else if (remainder == 56) {
-      //     let cut = cut.0.split_at(8);
-      //     let _new_params = chunkify(cut.1, 64);
-      // }
-
       return std::nullopt;
     }
 
-    std::vector<std::string> split_calldata(const std::string_view calldata, size_t chunk_size) {
-      std::vector<std::string> chunks;
-      for (size_t i = 0; i < calldata.size(); i += chunk_size) {
-        chunks.push_back(std::string(calldata.substr(i, chunk_size)));
-      }
-      return chunks;
-    }
+    namespace {
+      template <typename Input>
+      DecodeResult try_decode_input(Input calldata, const DecodeOptions& options,
+                                    allocator_type alloc) noexcept {
+        DecodeResult result{};
+
+        try {
+          result.calldata.emplace(calldata, options, alloc);
+        } catch (const BudgetExceeded&) {
+          result.status = DecodeStatus::BudgetExceeded;
+        } catch (const std::bad_alloc&) {
+          result.status = DecodeStatus::BudgetExceeded;
+        } catch (const std::exception&) {
+          result.status = DecodeStatus::Malformed;
+        }
 
-    std::vector<std::string> pad_chunk_left(std::vector<std::string> chunks, size_t chunk_index) {
-      chunks[chunk_index] = std::string{constants::EMPTY_4} + chunks[chunk_index];
+        return result;
+      }
+    }  // namespace
 
-      chunks[chunks.size() - 1].erase(56);
+    DecodeResult try_decode(std::string_view calldata, const DecodeOptions& options,
+                            allocator_type alloc) noexcept {
+      return try_decode_input(calldata, options, alloc);
+    }
 
-      return split_calldata(join_strings(chunks), 64);
+    DecodeResult try_decode(std::span<const uint8_t> calldata, const DecodeOptions& options,
+                            allocator_type alloc) noexcept {
+      return try_decode_input(calldata, options, alloc);
     }
 
-    SelectorAndCalldata try_parse_selector(const std::string_view calldata) {
-      auto chunks{split_calldata(calldata, 8)};
+    DecodeArena::DecodeArena(size_t size)
+        : buffer(std::make_unique<std::byte[]>(std::max<size_t>(size, 1))),
+          resource(this->buffer.get(), std::max<size_t>(size, 1),
+                   std::pmr::new_delete_resource()) {}
 
-      // Extract and replace the function selector if it exists.
-      if (chunks.at(0) != constants::EMPTY_4 && chunks.at(1) == constants::EMPTY_4
-          && chunks.at(0) != constants::MASK_4) {
-        auto selector{chunks.at(0)};
-        chunks.erase(chunks.begin());
-        return std::make_tuple(selector, join_strings(chunks));
-      }
+    DecodeArena::~DecodeArena() = default;
 
-      return std::make_tuple(std::string{constants::EMPTY_4}, join_strings(chunks));
-    }
+    allocator_type DecodeArena::allocator() noexcept { return allocator_type{&this->resource}; }
 
-    ChunksAndCalldata rearrange_chunks(std::vector<std::string> chunks, size_t chunk_index,
-                                       const std::string_view replacement) {
-      chunks[chunk_index] = replacement;
+    void DecodeArena::reset() noexcept { this->resource.release(); }
 
-      std::string calldata{join_strings(chunks)};
-      calldata.append(constants::EMPTY_4);
-
-      return std::make_tuple(split_calldata(calldata, 64), calldata);
+    std::vector<uint8_t> bytes_from_hex(std::string_view hex) {
+      std::vector<uint8_t> bytes;
+      decode_hex_into(hex, bytes);
+      return bytes;
     }
 
-    std::optional<std::string> previous_chunk(std::vector<std::string> chunks, size_t chunk_index) {
-      if (chunk_index == 0) {
-        return std::nullopt;
+    std::vector<Word> split_calldata(std::span<const uint8_t> calldata) {
+      std::vector<Word> chunks;
+      chunks.reserve((calldata.size() + WORD_SIZE - 1) / WORD_SIZE);
+      for (size_t i = 0; i < calldata.size(); i += WORD_SIZE) {
+        chunks.push_back(Word::from_bytes(calldata.subspan(i)));
       }
-
-      return chunks.at(chunk_index - 1);
+      return chunks;
     }
 
-    std::optional<std::string> next_chunk(std::vector<std::string> chunks, size_t chunk_index) {
-      if (chunk_index == chunks.size() - 1) {
-        return std::nullopt;
+    std::optional<Selector> try_parse_selector(const Word& word) {
+      auto selector{Selector::from_bytes(word.bytes.data())};
+      auto following{Selector::from_bytes(word.bytes.data() + SELECTOR_SIZE)};
+
+      // Extract the function selector if it exists.
+      if (selector != constants::EMPTY_4_SELECTOR && following == constants::EMPTY_4_SELECTOR
+          && selector != constants::MASK_4_SELECTOR) {
+        return selector;
       }
 
-      return chunks.at(chunk_index + 1);
+      return std::nullopt;
     }
 
-    ParamTypes get_param_type(const std::string_view param) {
-      if (param == constants::EMPTY_32) {
+    ParamTypes get_param_type(const Word& param) {
+      if (param == constants::EMPTY_32_WORD) {
         return ParamTypes{Types::AnyZero};
-      } else if (param == constants::MAX_U128) {
+      } else if (param == constants::MAX_U128_WORD) {
         return ParamTypes{Types::MaxUint128};
-      } else if (param == constants::MAX_U256) {
+      } else if (param == constants::MAX_U256_WORD) {
         return ParamTypes{Types::AnyMax};
       }
 
-      // Break the param into 4 byte chunks.
-      auto chunks{split_calldata(param, 8)};
-
       // Selector detection:
       // if: !00000000... && !FFFFFFFF... && ________00000000
-      if (chunks.at(0) != constants::EMPTY_4 && chunks.at(0) != constants::MASK_4
-          && chunks.at(1) == constants::EMPTY_4) {
+      if (try_parse_selector(param)) {
         return ParamTypes{Types::Selector, Types::String, Types::Bytes};
       }
 
       // Check if it's an Int by: if FFFFFFFF
       // Ints replace 0s with 1s in bitwise
-      if (chunks.at(0) == constants::MASK_4) {
+      if (Selector::from_bytes(param.bytes.data()) == constants::MASK_4_SELECTOR) {
         return ParamTypes{Types::Int};
       }
 
-      // Check if we found an address:
+      // Check if we found an address (40 significant hex chars):
       // Todo:
       // - Check for optimised addresses via heuristics
-      auto trimmed{trim_zeroes(param)};
-      if (trimmed.size() == 40) {
+      if (param.leading_zero_nibbles() == WORD_SIZE * 2 - 40) {
         return ParamTypes{Types::Address, Types::Bytes20, Types::Uint};
       }
 
-      intx::uint256 value{uint_from_hex_str<256>(param)};
+      intx::uint256 value{param.to_uint()};
       // If value is 0 or 1
       if (value < 1) {
         return ParamTypes{Types::Uint8, Types::Bytes1, Types::Bool};
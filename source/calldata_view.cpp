@@ -0,0 +1,91 @@
+#include <evmtools/calldata_view.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace evmtools {
+  namespace calldata_decoder {
+
+    CalldataView::CalldataView(std::span<const uint8_t> calldata, allocator_type alloc) noexcept
+        : calldata(calldata), alloc(alloc), param_types(alloc) {}
+
+    CalldataView::CalldataView(std::span<const std::byte> calldata, allocator_type alloc) noexcept
+        : CalldataView(std::span<const uint8_t>{reinterpret_cast<const uint8_t*>(calldata.data()),
+                                                calldata.size()},
+                       alloc) {}
+
+    std::optional<Selector> CalldataView::selector() const noexcept {
+      if (this->calldata.size() < SELECTOR_SIZE) {
+        return std::nullopt;
+      }
+
+      return Selector::from_bytes(this->calldata.data());
+    }
+
+    std::span<const uint8_t> CalldataView::bytes() const noexcept { return this->calldata; }
+
+    size_t CalldataView::size() const noexcept {
+      const size_t size{this->calldata.size()};
+      if (size < SELECTOR_SIZE) {
+        return 0;
+      }
+
+      // Whole-word calldata keeps its grid, with the selector cut from the first word.
+      if (size % WORD_SIZE == 0) {
+        return size / WORD_SIZE;
+      }
+
+      return (size - SELECTOR_SIZE + WORD_SIZE - 1) / WORD_SIZE;
+    }
+
+    std::span<const uint8_t> CalldataView::word_bytes(size_t index) const {
+      if (index >= this->size()) {
+        throw std::out_of_range("param index out of range");
+      }
+
+      if (this->calldata.size() % WORD_SIZE == 0) {
+        return index == 0 ? this->calldata.subspan(SELECTOR_SIZE, WORD_SIZE - SELECTOR_SIZE)
+                          : this->calldata.subspan(index * WORD_SIZE, WORD_SIZE);
+      }
+
+      auto rest{this->calldata.subspan(SELECTOR_SIZE + index * WORD_SIZE)};
+      return rest.first(std::min(rest.size(), WORD_SIZE));
+    }
+
+    Word CalldataView::word(size_t index) const {
+      return Word::from_bytes(this->word_bytes(index));
+    }
+
+    ParamTypes CalldataView::types(size_t index) const {
+      auto param{this->word(index)};
+
+      if (this->full) {
+        return this->full->main_details.param_types.at(index);
+      }
+
+      if (this->param_types.empty()) {
+        this->param_types.resize(this->size());
+      }
+
+      auto& types{this->param_types[index]};
+      if (types.empty()) {
+        types = get_param_type(param);
+      }
+
+      return types;
+    }
+
+    const Calldata& CalldataView::decoded() const {
+      if (!this->full) {
+        this->full.emplace(this->calldata, this->alloc);
+      }
+
+      return *this->full;
+    }
+
+    std::span<const Params> CalldataView::nested() const { return this->decoded().nested_details; }
+
+    bool CalldataView::is_decoded() const noexcept { return this->full.has_value(); }
+
+  }  // namespace calldata_decoder
+}  // namespace evmtools
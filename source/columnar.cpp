@@ -0,0 +1,307 @@
+#include <evmtools/columnar.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace evmtools {
+  namespace columnar {
+    namespace {
+      constexpr std::string_view MAGIC{"EVMCOL\0\1", 8};
+      constexpr size_t HEADER_SIZE{32};
+      constexpr size_t GROUP_HEADER_SIZE{64};
+      // Every column starts at a multiple of this, counted from the start of the file.
+      constexpr size_t ALIGNMENT{32};
+
+      void check_endian() {
+        if constexpr (std::endian::native != std::endian::little) {
+          throw std::runtime_error("columnar files need a little-endian host");
+        }
+      }
+
+      constexpr size_t align_up(size_t size) noexcept {
+        return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+      }
+
+      template <typename T> void store(uint8_t* out, T value) noexcept {
+        std::memcpy(out, &value, sizeof(value));
+      }
+
+      template <typename T> T load(const uint8_t* in) noexcept {
+        T value;
+        std::memcpy(&value, in, sizeof(value));
+        return value;
+      }
+
+      /** Byte offsets of the columns of a group, from the start of the group. */
+      struct Layout {
+        size_t call_inputs, selectors, word_ends, words, offsets, types, parents, children, size;
+
+        Layout(size_t call_count, size_t word_count, size_t nested_count) noexcept {
+          size_t at{GROUP_HEADER_SIZE};
+          auto next{[&](size_t bytes) { return std::exchange(at, align_up(at + bytes)); }};
+
+          this->call_inputs = next(call_count * sizeof(uint64_t));
+          this->selectors = next(call_count * sizeof(Selector));
+          this->word_ends = next(call_count * sizeof(uint32_t));
+          this->words = next(word_count * sizeof(Word));
+          this->offsets = next(word_count * sizeof(uint32_t));
+          this->types = next(word_count * sizeof(ParamTypes));
+          this->parents = next(nested_count * sizeof(uint32_t));
+          this->children = next(nested_count * sizeof(uint32_t));
+          this->size = at;
+        }
+      };
+
+      template <typename T>
+      std::span<const T> column(std::span<const uint8_t> group, size_t offset, size_t count) {
+        return {reinterpret_cast<const T*>(group.data() + offset), count};
+      }
+    }  // namespace
+
+    ParamColumns RowGroup::call_words(size_t call) const noexcept {
+      if (call >= this->word_ends.size()) {
+        return {};
+      }
+
+      const size_t begin{call == 0 ? 0 : this->word_ends[call - 1]};
+      const size_t end{this->word_ends[call]};
+      if (begin > end || end > this->words.size()) {
+        return {};
+      }
+
+      return ParamColumns{this->words.subspan(begin, end - begin),
+                          this->offsets.subspan(begin, end - begin),
+                          this->types.subspan(begin, end - begin)};
+    }
+
+    ColumnWriter::ColumnWriter(std::ostream& out, size_t group_words)
+        : out(out), group_words(std::max<size_t>(group_words, 1)) {
+      check_endian();
+
+      std::array<uint8_t, HEADER_SIZE> header{};
+      std::copy(MAGIC.begin(), MAGIC.end(), header.begin());
+      store(header.data() + MAGIC.size(), FORMAT_VERSION);
+
+      this->out.write(reinterpret_cast<const char*>(header.data()), header.size());
+      if (!this->out) {
+        throw std::runtime_error("failed to write columnar header");
+      }
+    }
+
+    ColumnWriter::~ColumnWriter() {
+      try {
+        this->flush();
+      } catch (const std::exception&) {
+        // Destructors can't report errors.
+      }
+    }
+
+    void ColumnWriter::append(uint64_t index, const std::optional<Calldata>& calldata) {
+      this->append(index, calldata ? &*calldata : nullptr);
+    }
+
+    void ColumnWriter::append(uint64_t index, const Calldata* calldata) {
+      this->inputs++;
+
+      if (calldata != nullptr) {
+        const size_t first_call{this->selectors.size()};
+
+        auto add_call{[&](Selector selector, ParamColumns columns) {
+          if (this->words.size() + columns.words.size() > UINT32_MAX) {
+            throw std::length_error("too many words for a row group");
+          }
+
+          this->call_inputs.push_back(index);
+          this->selectors.push_back(selector);
+          this->words.insert(this->words.end(), columns.words.begin(), columns.words.end());
+          this->offsets.insert(this->offsets.end(), columns.offsets.begin(),
+                               columns.offsets.end());
+          this->types.insert(this->types.end(), columns.types.begin(), columns.types.end());
+          // Words without types (or offsets) still get a row, so the columns stay parallel.
+          this->offsets.resize(this->words.size(), 0);
+          this->types.resize(this->words.size());
+          this->word_ends.push_back(static_cast<uint32_t>(this->words.size()));
+        }};
+
+        add_call(calldata->selector, calldata->columns());
+        for (const auto& nested : calldata->nested_details) {
+          add_call(nested.selector, nested.columns());
+        }
+
+        // The main call comes first, so nested call `n` is call `n + 1` of the input.
+        const auto& nested{calldata->nested_details};
+        for (size_t n = 0; n < nested.size(); n++) {
+          const size_t parent{nested[n].parent == calldata_decoder::NO_PARENT
+                                  ? 0
+                                  : size_t{nested[n].parent} + 1};
+          this->parents.push_back(static_cast<uint32_t>(first_call + parent));
+          this->children.push_back(static_cast<uint32_t>(first_call + 1 + n));
+        }
+      }
+
+      if (std::max(this->words.size(), this->selectors.size()) >= this->group_words) {
+        this->write_group();
+      }
+    }
+
+    void ColumnWriter::flush() {
+      if (this->inputs != 0) {
+        this->write_group();
+      }
+
+      this->out.flush();
+      if (!this->out) {
+        throw std::runtime_error("failed to write columnar output");
+      }
+    }
+
+    void ColumnWriter::write_group() {
+      const size_t call_count{this->selectors.size()};
+      const size_t word_count{this->words.size()};
+      const size_t nested_count{this->parents.size()};
+      const Layout layout{call_count, word_count, nested_count};
+
+      std::array<uint8_t, GROUP_HEADER_SIZE> header{};
+      store(header.data(), uint64_t{layout.size});
+      store(header.data() + 8, this->inputs);
+      store(header.data() + 16, static_cast<uint32_t>(call_count));
+      store(header.data() + 20, static_cast<uint32_t>(word_count));
+      store(header.data() + 24, static_cast<uint32_t>(nested_count));
+
+      size_t written{0};
+      auto write{[&](size_t at, const void* data, size_t bytes) {
+        // Pad up to the start of the column.
+        constexpr std::array<char, ALIGNMENT> padding{};
+        this->out.write(padding.data(), static_cast<std::streamsize>(at - written));
+        this->out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written = at + bytes;
+      }};
+
+      write(0, header.data(), header.size());
+      write(layout.call_inputs, this->call_inputs.data(), call_count * sizeof(uint64_t));
+      write(layout.selectors, this->selectors.data(), call_count * sizeof(Selector));
+      write(layout.word_ends, this->word_ends.data(), call_count * sizeof(uint32_t));
+      write(layout.words, this->words.data(), word_count * sizeof(Word));
+      write(layout.offsets, this->offsets.data(), word_count * sizeof(uint32_t));
+      write(layout.types, this->types.data(), word_count * sizeof(ParamTypes));
+      write(layout.parents, this->parents.data(), nested_count * sizeof(uint32_t));
+      write(layout.children, this->children.data(), nested_count * sizeof(uint32_t));
+      write(layout.size, nullptr, 0);
+
+      if (!this->out) {
+        throw std::runtime_error("failed to write columnar output");
+      }
+
+      this->inputs = 0;
+      this->call_inputs.clear();
+      this->selectors.clear();
+      this->word_ends.clear();
+      this->words.clear();
+      this->offsets.clear();
+      this->types.clear();
+      this->parents.clear();
+      this->children.clear();
+    }
+
+    ColumnReader::ColumnReader(const std::filesystem::path& path) : file(std::in_place, path) {
+      this->image = this->file->bytes();
+      this->parse();
+    }
+
+    ColumnReader::ColumnReader(std::vector<uint8_t> image) : owned(std::move(image)) {
+      this->image = this->owned;
+      this->parse();
+    }
+
+    void ColumnReader::parse() {
+      auto fail{[](const char* what) {
+        return std::runtime_error(std::string{"invalid columnar file: "} + what);
+      }};
+
+      check_endian();
+
+      if (this->image.size() < HEADER_SIZE
+          || std::memcmp(this->image.data(), MAGIC.data(), MAGIC.size()) != 0) {
+        throw fail("bad magic");
+      }
+      if (load<uint32_t>(this->image.data() + MAGIC.size()) != FORMAT_VERSION) {
+        throw fail("unsupported version");
+      }
+
+      // Columns are only aligned if the file is; a mapped file always is.
+      if (reinterpret_cast<uintptr_t>(this->image.data()) % alignof(uint64_t) != 0) {
+        throw fail("misaligned image");
+      }
+
+      auto rest{this->image.subspan(HEADER_SIZE)};
+      while (!rest.empty()) {
+        if (rest.size() < GROUP_HEADER_SIZE) {
+          throw fail("truncated row group");
+        }
+
+        const auto size{load<uint64_t>(rest.data())};
+        const size_t call_count{load<uint32_t>(rest.data() + 16)};
+        const size_t word_count{load<uint32_t>(rest.data() + 20)};
+        const size_t nested_count{load<uint32_t>(rest.data() + 24)};
+        const Layout layout{call_count, word_count, nested_count};
+
+        if (size != layout.size || size > rest.size()) {
+          throw fail("truncated or corrupt row group");
+        }
+
+        auto group{rest.first(layout.size)};
+        rest = rest.subspan(layout.size);
+
+        RowGroup row_group{};
+        row_group.inputs = load<uint64_t>(group.data() + 8);
+        row_group.call_inputs = column<uint64_t>(group, layout.call_inputs, call_count);
+        row_group.selectors = column<Selector>(group, layout.selectors, call_count);
+        row_group.word_ends = column<uint32_t>(group, layout.word_ends, call_count);
+        row_group.words = column<Word>(group, layout.words, word_count);
+        row_group.offsets = column<uint32_t>(group, layout.offsets, word_count);
+        row_group.types = column<ParamTypes>(group, layout.types, word_count);
+        row_group.parents = column<uint32_t>(group, layout.parents, nested_count);
+        row_group.children = column<uint32_t>(group, layout.children, nested_count);
+
+        // Check every call index up front, so readers can follow them without checking.
+        if (!std::is_sorted(row_group.word_ends.begin(), row_group.word_ends.end())
+            || (call_count != 0 && row_group.word_ends.back() != word_count)) {
+          throw fail("corrupt word ends");
+        }
+        auto in_group{[&](uint32_t call) { return call < call_count; }};
+        if (!std::all_of(row_group.parents.begin(), row_group.parents.end(), in_group)
+            || !std::all_of(row_group.children.begin(), row_group.children.end(), in_group)) {
+          throw fail("corrupt nested calls");
+        }
+
+        this->row_groups.push_back(row_group);
+      }
+    }
+
+    std::span<const RowGroup> ColumnReader::groups() const noexcept { return this->row_groups; }
+
+    uint64_t ColumnReader::inputs() const noexcept {
+      uint64_t total{0};
+      for (const auto& group : this->row_groups) total += group.inputs;
+      return total;
+    }
+
+    uint64_t ColumnReader::calls() const noexcept {
+      uint64_t total{0};
+      for (const auto& group : this->row_groups) total += group.selectors.size();
+      return total;
+    }
+
+    uint64_t ColumnReader::words() const noexcept {
+      uint64_t total{0};
+      for (const auto& group : this->row_groups) total += group.words.size();
+      return total;
+    }
+
+  }  // namespace columnar
+}  // namespace evmtools
@@ -0,0 +1,202 @@
+#include <evmtools/decode_cache.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+namespace evmtools {
+  namespace decode_cache {
+
+    namespace {
+      constexpr uint64_t PRIME_1{0x9e3779b97f4a7c15};
+      constexpr uint64_t PRIME_2{0xbf58476d1ce4e5b9};
+      constexpr uint64_t PRIME_3{0x94d049bb133111eb};
+
+      // Mixed into the hash of hex inputs, so they don't share slots with raw inputs.
+      constexpr uint64_t HEX_SEED{0x2545f4914f6cdd1d};
+
+      // Shards per hardware thread, to keep the odds of two threads sharing a lock low.
+      constexpr size_t SHARDS_PER_THREAD{4};
+
+      constexpr uint64_t absorb(uint64_t hash, uint64_t value) noexcept {
+        return std::rotl(hash ^ (value * PRIME_2), 31) * PRIME_1;
+      }
+    }  // namespace
+
+    uint64_t hash_bytes(std::span<const uint8_t> bytes) noexcept {
+      uint64_t hash{PRIME_1 ^ (bytes.size() * PRIME_2)};
+
+      size_t i{0};
+      for (; i + 8 <= bytes.size(); i += 8) {
+        uint64_t value;
+        std::memcpy(&value, bytes.data() + i, sizeof(value));
+        hash = absorb(hash, value);
+      }
+
+      if (i < bytes.size()) {
+        uint64_t value{0};
+        std::memcpy(&value, bytes.data() + i, bytes.size() - i);
+        hash = absorb(hash, value);
+      }
+
+      // SplitMix64 finaliser
+      hash ^= hash >> 30;
+      hash *= PRIME_2;
+      hash ^= hash >> 27;
+      hash *= PRIME_3;
+      hash ^= hash >> 31;
+      return hash;
+    }
+
+    /** A cached input and its decode, which may refer into `key`. */
+    struct DecodeCache::Entry {
+      std::vector<uint8_t> key;
+      bool hex{false};
+      std::optional<Calldata> calldata;
+
+      [[nodiscard]] bool matches(std::span<const uint8_t> other, bool other_hex) const noexcept {
+        return this->hex == other_hex && std::ranges::equal(this->key, other);
+      }
+    };
+
+    DecodeCache::DecodeCache(size_t capacity, size_t shards,
+                             const calldata_decoder::DecodeOptions& options)
+        : options(options) {
+      if (capacity == 0) {
+        throw std::invalid_argument("decode cache capacity must not be 0");
+      }
+
+      if (shards == 0) {
+        shards = std::bit_ceil(std::max<size_t>(std::thread::hardware_concurrency(), 1)
+                               * SHARDS_PER_THREAD);
+      }
+      shards = std::min(shards, capacity);
+      this->slots_per_shard = (capacity + shards - 1) / shards;
+
+      this->shards.reserve(shards);
+      for (size_t i = 0; i < shards; i++) {
+        auto shard{std::make_unique<Shard>()};
+        shard->slots.resize(this->slots_per_shard);
+        shard->index.reserve(this->slots_per_shard);
+        this->shards.push_back(std::move(shard));
+      }
+    }
+
+    DecodeCache::~DecodeCache() = default;
+
+    std::shared_ptr<const Calldata> DecodeCache::get(std::string_view hex) {
+      std::span<const uint8_t> key{reinterpret_cast<const uint8_t*>(hex.data()), hex.size()};
+      return this->get(key, true, [this](Entry& entry) {
+        entry.calldata.emplace(std::string_view{reinterpret_cast<const char*>(entry.key.data()),
+                                                entry.key.size()},
+                               this->options);
+      });
+    }
+
+    std::shared_ptr<const Calldata> DecodeCache::get(std::span<const uint8_t> bytes) {
+      return this->get(bytes, false, [this](Entry& entry) {
+        entry.calldata.emplace(std::span<const uint8_t>{entry.key}, this->options);
+      });
+    }
+
+    template <typename Decode>
+    std::shared_ptr<const Calldata> DecodeCache::get(std::span<const uint8_t> key, bool hex,
+                                                     Decode&& decode) {
+      const uint64_t hash{hash_bytes(key) ^ (hex ? HEX_SEED : 0)};
+      // The high bits pick the shard, so they don't correlate with buckets of the shard's index.
+      auto& shard{*this->shards[(hash >> 32) % this->shards.size()]};
+
+      auto result{[](const std::shared_ptr<const Entry>& entry) {
+        return std::shared_ptr<const Calldata>{entry, &*entry->calldata};
+      }};
+
+      {
+        std::lock_guard lock{shard.mutex};
+        if (auto found{shard.index.find(hash)}; found != shard.index.end()) {
+          auto& slot{shard.slots[found->second]};
+          if (slot.entry->matches(key, hex)) {
+            slot.referenced = true;
+            shard.hits++;
+            return result(slot.entry);
+          }
+        }
+        shard.misses++;
+      }
+
+      // Decode without holding the lock; failures throw before anything is cached.
+      auto entry{std::make_shared<Entry>()};
+      entry->key.assign(key.begin(), key.end());
+      entry->hex = hex;
+      decode(*entry);
+
+      std::lock_guard lock{shard.mutex};
+      // Another thread may have cached the same input in the meantime.
+      if (auto found{shard.index.find(hash)}; found != shard.index.end()) {
+        const auto& slot{shard.slots[found->second]};
+        if (slot.entry->matches(key, hex)) {
+          return result(slot.entry);
+        }
+      }
+
+      this->insert(shard, hash, entry);
+      return result(entry);
+    }
+
+    void DecodeCache::insert(Shard& shard, uint64_t hash, std::shared_ptr<const Entry> entry) {
+      // A different input with the same hash is replaced in place.
+      if (auto found{shard.index.find(hash)}; found != shard.index.end()) {
+        shard.slots[found->second] = Slot{hash, std::move(entry), false};
+        shard.evictions++;
+        return;
+      }
+
+      // Advance the clock hand to a free slot, or to one not used since the hand last passed.
+      while (true) {
+        auto& slot{shard.slots[shard.hand]};
+        if (!slot.entry) {
+          break;
+        }
+        if (!slot.referenced) {
+          shard.index.erase(slot.hash);
+          shard.evictions++;
+          break;
+        }
+        slot.referenced = false;
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+      }
+
+      shard.slots[shard.hand] = Slot{hash, std::move(entry), false};
+      shard.index.emplace(hash, shard.hand);
+      shard.hand = (shard.hand + 1) % shard.slots.size();
+    }
+
+    CacheStats DecodeCache::stats() const {
+      CacheStats stats{};
+      for (const auto& shard : this->shards) {
+        std::lock_guard lock{shard->mutex};
+        stats.hits += shard->hits;
+        stats.misses += shard->misses;
+        stats.evictions += shard->evictions;
+        stats.size += shard->index.size();
+      }
+      return stats;
+    }
+
+    size_t DecodeCache::capacity() const noexcept {
+      return this->slots_per_shard * this->shards.size();
+    }
+
+    void DecodeCache::clear() {
+      for (const auto& shard : this->shards) {
+        std::lock_guard lock{shard->mutex};
+        std::fill(shard->slots.begin(), shard->slots.end(), Slot{});
+        shard->index.clear();
+        shard->hand = 0;
+      }
+    }
+
+  }  // namespace decode_cache
+}  // namespace evmtools
@@ -0,0 +1,176 @@
+#include <evmtools/decode_stats.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace evmtools {
+  namespace decode_stats {
+
+    namespace {
+      enum Field : size_t { CALLS, BYTES, ALLOCATIONS, ALLOCATED_BYTES, NANOSECONDS, FIELD_COUNT };
+
+      /** The counters of one thread. Only the owning thread writes them. */
+      struct Counters {
+        std::array<std::array<std::atomic<uint64_t>, FIELD_COUNT>, PHASE_COUNT> phases{};
+        std::atomic<uint64_t> nested_calls{0};
+        std::array<std::atomic<uint64_t>, TYPES_COUNT> types{};
+        std::atomic<uint64_t> untyped{0};
+
+        // The innermost phase running on the thread, if any.
+        Phase current{};
+        bool in_phase{false};
+      };
+
+      /** Adds to a counter that only the calling thread writes, without a locked instruction. */
+      void add(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+      }
+
+      void add_to(Snapshot& snapshot, const Counters& counters) noexcept {
+        auto load{[](const std::atomic<uint64_t>& counter) {
+          return counter.load(std::memory_order_relaxed);
+        }};
+
+        for (size_t i = 0; i < PHASE_COUNT; i++) {
+          auto& phase{snapshot.phases[i]};
+          const auto& fields{counters.phases[i]};
+          phase.calls += load(fields[CALLS]);
+          phase.bytes += load(fields[BYTES]);
+          phase.allocations += load(fields[ALLOCATIONS]);
+          phase.allocated_bytes += load(fields[ALLOCATED_BYTES]);
+          phase.nanoseconds += load(fields[NANOSECONDS]);
+        }
+
+        snapshot.nested_calls += load(counters.nested_calls);
+        for (size_t i = 0; i < TYPES_COUNT; i++) {
+          snapshot.types[i] += load(counters.types[i]);
+        }
+        snapshot.untyped += load(counters.untyped);
+      }
+
+      /** The counters of every live thread, and the totals of threads that have exited. */
+      struct Registry {
+        std::mutex mutex;
+        std::vector<Counters*> live;
+        Snapshot retired{};
+      };
+
+      Registry& registry() {
+        // Constructed before, and so destroyed after, any thread's Registration.
+        static Registry instance;
+        return instance;
+      }
+
+      /** Registers the counters of a thread for as long as the thread runs. */
+      struct Registration {
+        Counters counters;
+
+        Registration() {
+          auto& registry{decode_stats::registry()};
+          std::lock_guard lock{registry.mutex};
+          registry.live.push_back(&this->counters);
+        }
+
+        ~Registration() {
+          auto& registry{decode_stats::registry()};
+          std::lock_guard lock{registry.mutex};
+          add_to(registry.retired, this->counters);
+          std::erase(registry.live, &this->counters);
+        }
+
+        Registration(const Registration& other) = delete;
+        Registration& operator=(const Registration& other) = delete;
+      };
+
+      Counters& local() {
+        thread_local Registration registration;
+        return registration.counters;
+      }
+    }  // namespace
+
+    Snapshot snapshot() {
+      auto& registry{decode_stats::registry()};
+      std::lock_guard lock{registry.mutex};
+
+      Snapshot snapshot{registry.retired};
+      for (const auto* counters : registry.live) {
+        add_to(snapshot, *counters);
+      }
+      return snapshot;
+    }
+
+    void reset() {
+      auto& registry{decode_stats::registry()};
+      std::lock_guard lock{registry.mutex};
+
+      registry.retired = Snapshot{};
+      for (auto* counters : registry.live) {
+        for (auto& fields : counters->phases) {
+          for (auto& field : fields) field.store(0, std::memory_order_relaxed);
+        }
+        counters->nested_calls.store(0, std::memory_order_relaxed);
+        for (auto& type : counters->types) type.store(0, std::memory_order_relaxed);
+        counters->untyped.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    void* CountingResource::do_allocate(size_t bytes, size_t alignment) {
+      auto& counters{local()};
+      if (counters.in_phase) {
+        auto& fields{counters.phases[static_cast<size_t>(counters.current)]};
+        add(fields[ALLOCATIONS], 1);
+        add(fields[ALLOCATED_BYTES], bytes);
+      }
+      return this->upstream->allocate(bytes, alignment);
+    }
+
+    void CountingResource::do_deallocate(void* memory, size_t bytes, size_t alignment) {
+      this->upstream->deallocate(memory, bytes, alignment);
+    }
+
+    bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+      return this == &other;
+    }
+
+    namespace detail {
+      void begin_phase(Phase phase, size_t bytes, Phase& previous, bool& nested) noexcept {
+        auto& counters{local()};
+        previous = counters.current;
+        nested = counters.in_phase;
+        counters.current = phase;
+        counters.in_phase = true;
+
+        auto& fields{counters.phases[static_cast<size_t>(phase)]};
+        add(fields[CALLS], 1);
+        add(fields[BYTES], bytes);
+      }
+
+      void end_phase(Phase phase, Phase previous, bool nested, uint64_t nanoseconds) noexcept {
+        auto& counters{local()};
+        add(counters.phases[static_cast<size_t>(phase)][NANOSECONDS], nanoseconds);
+        counters.current = previous;
+        counters.in_phase = nested;
+      }
+
+      void record_bytes(Phase phase, size_t bytes) noexcept {
+        add(local().phases[static_cast<size_t>(phase)][BYTES], bytes);
+      }
+
+      void record_nested_call() noexcept { add(local().nested_calls, 1); }
+
+      void record_types(calldata_decoder::ParamTypes types) noexcept {
+        auto& counters{local()};
+        if (types.empty()) {
+          add(counters.untyped, 1);
+          return;
+        }
+        for (auto type : types) {
+          add(counters.types[static_cast<size_t>(type)], 1);
+        }
+      }
+    }  // namespace detail
+
+  }  // namespace decode_stats
+}  // namespace evmtools
@@ -0,0 +1,314 @@
+#include <evmtools/hex.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define EVMTOOLS_HEX_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#    define EVMTOOLS_HEX_TARGET(isa)
+#  else
+#    define EVMTOOLS_HEX_TARGET(isa) __attribute__((target(isa)))
+#  endif
+#endif
+
+namespace evmtools {
+  namespace hex {
+    namespace {
+      constexpr uint8_t INVALID{0xff};
+
+      // Maps every character to its nibble value, or INVALID if it isn't a hex character.
+      constexpr std::array<uint8_t, 256> NIBBLES{[] {
+        std::array<uint8_t, 256> table{};
+        table.fill(INVALID);
+        for (uint8_t c = 0; c < 10; c++) table['0' + c] = c;
+        for (uint8_t c = 0; c < 6; c++) {
+          table['a' + c] = static_cast<uint8_t>(10 + c);
+          table['A' + c] = static_cast<uint8_t>(10 + c);
+        }
+        return table;
+      }()};
+
+      std::optional<size_t> decode_scalar(const std::string_view hex, uint8_t* out,
+                                          size_t from) noexcept {
+        for (size_t i = from; i + 1 < hex.size(); i += 2) {
+          auto high{NIBBLES[static_cast<uint8_t>(hex[i])]};
+          auto low{NIBBLES[static_cast<uint8_t>(hex[i + 1])]};
+
+          if (high == INVALID) return i;
+          if (low == INVALID) return i + 1;
+
+          out[i / 2] = static_cast<uint8_t>(high << 4 | low);
+        }
+
+        return std::nullopt;
+      }
+
+      constexpr char DIGITS[]{"0123456789abcdef"};
+
+      void encode_scalar(std::span<const uint8_t> bytes, char* out) noexcept {
+        for (auto byte : bytes) {
+          *out++ = DIGITS[byte >> 4];
+          *out++ = DIGITS[byte & 0x0f];
+        }
+      }
+
+#ifdef EVMTOOLS_HEX_X86
+      /** Sets every byte of `chars` that lies within [low, high] to 0xff, and the others to 0. */
+      EVMTOOLS_HEX_TARGET("sse4.1")
+      inline __m128i in_range_sse4(__m128i chars, char low, char high) noexcept {
+        return _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(chars, _mm_set1_epi8(low)), chars),
+                             _mm_cmpeq_epi8(_mm_min_epu8(chars, _mm_set1_epi8(high)), chars));
+      }
+
+      /**
+       * Converts 16 hex characters into nibbles, returning a mask with a bit set for every valid
+       * character.
+       */
+      EVMTOOLS_HEX_TARGET("sse4.1")
+      inline uint32_t nibbles_sse4(__m128i chars, __m128i& nibbles) noexcept {
+        // '0'-'9' are validated on the raw characters, 'a'-'f' after folding to lower case.
+        auto lower{_mm_or_si128(chars, _mm_set1_epi8(0x20))};
+        auto is_digit{in_range_sse4(chars, '0', '9')};
+        auto is_alpha{in_range_sse4(lower, 'a', 'f')};
+
+        auto digits{_mm_sub_epi8(chars, _mm_set1_epi8('0'))};
+        auto alphas{_mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))};
+        nibbles = _mm_blendv_epi8(alphas, digits, is_digit);
+
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)));
+      }
+
+      EVMTOOLS_HEX_TARGET("sse4.1")
+      std::optional<size_t> decode_sse4(const std::string_view hex, uint8_t* out) noexcept {
+        // Multiplies the high nibble of every pair by 16 and adds the low one.
+        const auto pair_weights{_mm_set1_epi16(0x0110)};
+        size_t i{0};
+
+        for (; i + 32 <= hex.size(); i += 32) {
+          __m128i first, second;
+          auto valid_first{nibbles_sse4(
+              _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex.data() + i)), first)};
+          auto valid_second{nibbles_sse4(
+              _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex.data() + i + 16)), second)};
+
+          if ((valid_first & valid_second) != 0xffff) {
+            return decode_scalar(hex.substr(0, i + 32), out, i);
+          }
+
+          auto bytes{_mm_packus_epi16(_mm_maddubs_epi16(first, pair_weights),
+                                      _mm_maddubs_epi16(second, pair_weights))};
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 2), bytes);
+        }
+
+        return decode_scalar(hex, out, i);
+      }
+
+      EVMTOOLS_HEX_TARGET("sse4.1")
+      void encode_sse4(std::span<const uint8_t> bytes, char* out) noexcept {
+        // Looks up the character of every nibble with a byte shuffle.
+        const auto digits{_mm_loadu_si128(reinterpret_cast<const __m128i*>(DIGITS))};
+        const auto low_nibbles{_mm_set1_epi8(0x0f)};
+        size_t i{0};
+
+        for (; i + 16 <= bytes.size(); i += 16) {
+          auto chunk{_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data() + i))};
+          auto high{_mm_shuffle_epi8(digits,
+                                     _mm_and_si128(_mm_srli_epi16(chunk, 4), low_nibbles))};
+          auto low{_mm_shuffle_epi8(digits, _mm_and_si128(chunk, low_nibbles))};
+
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi8(high, low));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16),
+                           _mm_unpackhi_epi8(high, low));
+        }
+
+        encode_scalar(bytes.subspan(i), out + i * 2);
+      }
+
+      EVMTOOLS_HEX_TARGET("avx2")
+      inline __m256i in_range_avx2(__m256i chars, char low, char high) noexcept {
+        auto above{_mm256_cmpeq_epi8(_mm256_max_epu8(chars, _mm256_set1_epi8(low)), chars)};
+        auto below{_mm256_cmpeq_epi8(_mm256_min_epu8(chars, _mm256_set1_epi8(high)), chars)};
+        return _mm256_and_si256(above, below);
+      }
+
+      EVMTOOLS_HEX_TARGET("avx2")
+      inline uint32_t nibbles_avx2(__m256i chars, __m256i& nibbles) noexcept {
+        auto lower{_mm256_or_si256(chars, _mm256_set1_epi8(0x20))};
+        auto is_digit{in_range_avx2(chars, '0', '9')};
+        auto is_alpha{in_range_avx2(lower, 'a', 'f')};
+
+        auto digits{_mm256_sub_epi8(chars, _mm256_set1_epi8('0'))};
+        auto alphas{_mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))};
+        nibbles = _mm256_blendv_epi8(alphas, digits, is_digit);
+
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)));
+      }
+
+      EVMTOOLS_HEX_TARGET("avx2")
+      std::optional<size_t> decode_avx2(const std::string_view hex, uint8_t* out) noexcept {
+        const auto pair_weights{_mm256_set1_epi16(0x0110)};
+        size_t i{0};
+
+        for (; i + 64 <= hex.size(); i += 64) {
+          __m256i first, second;
+          auto valid_first{nibbles_avx2(
+              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex.data() + i)), first)};
+          auto valid_second{nibbles_avx2(
+              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex.data() + i + 32)), second)};
+
+          if ((valid_first & valid_second) != 0xffffffff) {
+            return decode_scalar(hex.substr(0, i + 64), out, i);
+          }
+
+          // packus works per 128-bit lane, so the 64-bit quarters come out as 0, 2, 1, 3.
+          auto packed{_mm256_packus_epi16(_mm256_maddubs_epi16(first, pair_weights),
+                                          _mm256_maddubs_epi16(second, pair_weights))};
+          auto bytes{_mm256_permute4x64_epi64(packed, 0b11'01'10'00)};
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 2), bytes);
+        }
+
+        // Finish the tail with the SSE4 kernel, reporting positions relative to the whole input.
+        auto invalid{decode_sse4(hex.substr(i), out + i / 2)};
+        return invalid ? std::optional<size_t>{*invalid + i} : std::nullopt;
+      }
+
+      EVMTOOLS_HEX_TARGET("avx2")
+      void encode_avx2(std::span<const uint8_t> bytes, char* out) noexcept {
+        const auto digits{_mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(DIGITS)))};
+        const auto low_nibbles{_mm256_set1_epi8(0x0f)};
+        size_t i{0};
+
+        for (; i + 32 <= bytes.size(); i += 32) {
+          auto chunk{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes.data() + i))};
+          auto high{_mm256_shuffle_epi8(
+              digits, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), low_nibbles))};
+          auto low{_mm256_shuffle_epi8(digits, _mm256_and_si256(chunk, low_nibbles))};
+
+          // unpack works per 128-bit lane, so the lanes hold bytes 0-7 and 16-23, then 8-15 and
+          // 24-31.
+          auto first{_mm256_unpacklo_epi8(high, low)};
+          auto second{_mm256_unpackhi_epi8(high, low)};
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2),
+                              _mm256_permute2x128_si256(first, second, 0x20));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2 + 32),
+                              _mm256_permute2x128_si256(first, second, 0x31));
+        }
+
+        encode_sse4(bytes.subspan(i), out + i * 2);
+      }
+
+      struct CpuFeatures {
+        bool sse4;
+        bool avx2;
+      };
+
+      CpuFeatures detect_features() noexcept {
+#  if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        const int max_leaf{info[0]};
+
+        __cpuid(info, 1);
+        const bool sse4{(info[2] & (1 << 19)) != 0};
+        const bool os_avx{(info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6};
+
+        bool avx2{false};
+        if (max_leaf >= 7 && os_avx) {
+          __cpuidex(info, 7, 0);
+          avx2 = (info[1] & (1 << 5)) != 0;
+        }
+
+        return CpuFeatures{sse4, avx2};
+#  else
+        __builtin_cpu_init();
+        return CpuFeatures{__builtin_cpu_supports("sse4.1") != 0,
+                           __builtin_cpu_supports("avx2") != 0};
+#  endif
+      }
+
+      const CpuFeatures& cpu_features() noexcept {
+        static const CpuFeatures features{detect_features()};
+        return features;
+      }
+#endif
+    }  // namespace
+
+    bool is_supported(const Kernel kernel) noexcept {
+      switch (kernel) {
+        case Kernel::Scalar:
+          return true;
+#ifdef EVMTOOLS_HEX_X86
+        case Kernel::Sse4:
+          return cpu_features().sse4;
+        case Kernel::Avx2:
+          // The AVX2 kernel finishes its tail with the SSE4 one.
+          return cpu_features().avx2 && cpu_features().sse4;
+#endif
+        default:
+          return false;
+      }
+    }
+
+    Kernel best_kernel() noexcept {
+      static const Kernel kernel{is_supported(Kernel::Avx2)   ? Kernel::Avx2
+                                 : is_supported(Kernel::Sse4) ? Kernel::Sse4
+                                                              : Kernel::Scalar};
+      return kernel;
+    }
+
+    std::optional<size_t> decode(const std::string_view hex, std::span<uint8_t> out) noexcept {
+      return decode(hex, out, best_kernel());
+    }
+
+    std::optional<size_t> decode(const std::string_view hex, std::span<uint8_t> out,
+                                 const Kernel kernel) noexcept {
+      // Never write past the output buffer.
+      auto input{hex.substr(0, out.size() * 2)};
+
+      if (!is_supported(kernel)) {
+        return decode_scalar(input, out.data(), 0);
+      }
+
+      switch (kernel) {
+#ifdef EVMTOOLS_HEX_X86
+        case Kernel::Avx2:
+          return decode_avx2(input, out.data());
+        case Kernel::Sse4:
+          return decode_sse4(input, out.data());
+#endif
+        default:
+          return decode_scalar(input, out.data(), 0);
+      }
+    }
+
+    void encode(std::span<const uint8_t> bytes, std::span<char> out) noexcept {
+      encode(bytes, out, best_kernel());
+    }
+
+    void encode(std::span<const uint8_t> bytes, std::span<char> out, const Kernel kernel) noexcept {
+      // Never write past the output buffer.
+      auto input{bytes.first(std::min(bytes.size(), out.size() / 2))};
+
+      if (!is_supported(kernel)) {
+        return encode_scalar(input, out.data());
+      }
+
+      switch (kernel) {
+#ifdef EVMTOOLS_HEX_X86
+        case Kernel::Avx2:
+          return encode_avx2(input, out.data());
+        case Kernel::Sse4:
+          return encode_sse4(input, out.data());
+#endif
+        default:
+          return encode_scalar(input, out.data());
+      }
+    }
+
+  }  // namespace hex
+}  // namespace evmtools
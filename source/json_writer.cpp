@@ -0,0 +1,250 @@
+#include <evmtools/hex.h>
+#include <evmtools/json_writer.h>
+
+#include <charconv>
+#include <cstring>
+
+namespace evmtools {
+  namespace json_writer {
+    using calldata_decoder::NO_PARENT;
+    using calldata_decoder::ParamColumns;
+    using calldata_decoder::Selector;
+    using calldata_decoder::WORD_SIZE;
+
+    namespace {
+      // Most characters a size_t or uint32_t is written with.
+      constexpr size_t SIZE_DIGITS{20};
+      constexpr size_t U32_DIGITS{10};
+
+      // Most characters a set of types is written with: every name quoted, with separators.
+      constexpr size_t TYPES_MAX{[] {
+        size_t size{2};
+        for (auto name : TYPE_NAMES) size += name.size() + 3;
+        return size;
+      }()};
+
+      // Most characters one param is written with.
+      constexpr size_t PARAM_MAX{std::string_view{R"({"word":"0x","offset":,"types":},)"}.size()
+                                 + WORD_SIZE * 2 + U32_DIGITS + TYPES_MAX};
+
+      // Most characters one call is written with, leaving out its signature and params.
+      constexpr size_t CALL_MAX{
+          std::string_view{
+              R"({"block":,"index":,"selector":"0x","signature":"","truncated":false,)"
+              R"("parent":,"depth":,"params":[],"nested":[]},)"}
+              .size()
+          + SIZE_DIGITS * 2 + calldata_decoder::SELECTOR_SIZE * 2 + U32_DIGITS * 2 + 1};
+
+      // Every character of a signature is written as at most 6 (`\u00XX`).
+      constexpr size_t ESCAPE_MAX{6};
+
+      /** Writes JSON into memory that is known to be large enough. */
+      struct Cursor {
+        char* at;
+
+        void put(char c) noexcept { *this->at++ = c; }
+
+        void put(std::string_view text) noexcept {
+          std::memcpy(this->at, text.data(), text.size());
+          this->at += text.size();
+        }
+
+        void number(size_t value) noexcept {
+          this->at = std::to_chars(this->at, this->at + SIZE_DIGITS, value).ptr;
+        }
+
+        void hex(std::span<const uint8_t> bytes) noexcept {
+          hex::encode(bytes, {this->at, bytes.size() * 2});
+          this->at += bytes.size() * 2;
+        }
+
+        void selector(const Selector selector) noexcept {
+          const uint8_t bytes[]{static_cast<uint8_t>(selector.value >> 24),
+                                static_cast<uint8_t>(selector.value >> 16),
+                                static_cast<uint8_t>(selector.value >> 8),
+                                static_cast<uint8_t>(selector.value)};
+          this->put(R"("selector":"0x)");
+          this->hex(bytes);
+          this->put('"');
+        }
+
+        void escaped(std::string_view text) noexcept {
+          constexpr char digits[]{"0123456789abcdef"};
+          for (char c : text) {
+            const auto byte{static_cast<uint8_t>(c)};
+            if (c == '"' || c == '\\') {
+              this->put('\\');
+              this->put(c);
+            } else if (byte < 0x20) {
+              this->put("\\u00");
+              this->put(digits[byte >> 4]);
+              this->put(digits[byte & 0x0f]);
+            } else {
+              this->put(c);
+            }
+          }
+        }
+
+        void params(const ParamColumns& columns) noexcept {
+          this->put(R"("params":[)");
+          for (size_t i = 0; i < columns.words.size(); i++) {
+            if (i != 0) this->put(',');
+
+            this->put(R"({"word":"0x)");
+            this->hex(columns.words[i].bytes);
+            this->put('"');
+
+            if (i < columns.offsets.size()) {
+              this->put(R"(,"offset":)");
+              this->number(columns.offsets[i]);
+            }
+
+            this->put(R"(,"types":[)");
+            if (i < columns.types.size()) {
+              std::string_view separator{"\""};
+              for (auto type : columns.types[i]) {
+                this->put(separator);
+                this->put(TYPE_NAMES[static_cast<size_t>(type)]);
+                this->put('"');
+                separator = ",\"";
+              }
+            }
+            this->put("]}");
+          }
+          this->put(']');
+        }
+      };
+
+      /**
+       * Grows `out` once by at most `bound` characters and lets `write` fill them in place,
+       * keeping only what it wrote.
+       */
+      template <typename Write> void append_bounded(std::string& out, size_t bound, Write write) {
+        const size_t size{out.size()};
+        out.resize_and_overwrite(size + bound, [&](char* data, size_t) noexcept {
+          Cursor cursor{data + size};
+          write(cursor);
+          return static_cast<size_t>(cursor.at - data);
+        });
+      }
+
+      std::optional<std::string_view> find_signature(
+          const Selector selector, const signature_index::SignatureIndex* signatures) noexcept {
+        return signatures != nullptr ? signatures->find(selector) : std::nullopt;
+      }
+
+      /**
+       * Appends a call's object up to and including its params, leaving it open, between `before`
+       * and `after`.
+       */
+      void append_call(std::string& out, std::string_view before, std::string_view after,
+                       const std::optional<uint64_t> block, const std::optional<size_t> index,
+                       const Selector selector, const ParamColumns& columns,
+                       const std::optional<bool> truncated, const uint32_t parent,
+                       const std::optional<uint32_t> depth,
+                       const signature_index::SignatureIndex* signatures) {
+        const auto signature{find_signature(selector, signatures)};
+        const size_t bound{before.size() + after.size() + CALL_MAX
+                           + columns.words.size() * PARAM_MAX
+                           + (signature ? signature->size() * ESCAPE_MAX : 0)};
+
+        append_bounded(out, bound, [&](Cursor& cursor) {
+          cursor.put(before);
+          cursor.put('{');
+          if (block) {
+            cursor.put(R"("block":)");
+            cursor.number(*block);
+            cursor.put(',');
+          }
+          if (index) {
+            cursor.put(R"("index":)");
+            cursor.number(*index);
+            cursor.put(',');
+          }
+
+          cursor.selector(selector);
+          if (signature) {
+            cursor.put(R"(,"signature":")");
+            cursor.escaped(*signature);
+            cursor.put('"');
+          }
+
+          if (truncated) {
+            cursor.put(*truncated ? R"(,"truncated":true)" : R"(,"truncated":false)");
+          }
+          if (parent != NO_PARENT) {
+            cursor.put(R"(,"parent":)");
+            cursor.number(parent);
+          }
+          if (depth) {
+            cursor.put(R"(,"depth":)");
+            cursor.number(*depth);
+          }
+
+          cursor.put(',');
+          cursor.params(columns);
+          cursor.put(after);
+        });
+      }
+
+      void append_calldata(std::string& out, const std::optional<uint64_t> block,
+                           const std::optional<size_t> index, const Calldata& calldata,
+                           const signature_index::SignatureIndex* signatures) {
+        append_call(out, "", R"(,"nested":[)", block, index, calldata.selector, calldata.columns(),
+                    calldata.truncated, NO_PARENT, std::nullopt, signatures);
+
+        for (size_t n = 0; n < calldata.nested_details.size(); n++) {
+          const auto& nested{calldata.nested_details[n]};
+          append_call(out, n != 0 ? "," : "", "}", std::nullopt, std::nullopt, nested.selector,
+                      nested.columns(), std::nullopt, nested.parent, nested.depth, signatures);
+        }
+      }
+
+      /** Appends one NDJSON line, with a `block` field if given. */
+      void append_line(std::string& out, const std::optional<uint64_t> block, size_t index,
+                       const Calldata* calldata,
+                       const signature_index::SignatureIndex* signatures) {
+        if (calldata == nullptr) {
+          append_bounded(out, CALL_MAX, [&](Cursor& cursor) {
+            cursor.put('{');
+            if (block) {
+              cursor.put(R"("block":)");
+              cursor.number(*block);
+              cursor.put(',');
+            }
+            cursor.put(R"("index":)");
+            cursor.number(index);
+            cursor.put(",\"error\":true}\n");
+          });
+          return;
+        }
+
+        append_calldata(out, block, index, *calldata, signatures);
+        out += "]}\n";
+      }
+    }  // namespace
+
+    void append_json(std::string& out, const Calldata& calldata,
+                     const signature_index::SignatureIndex* signatures) {
+      append_calldata(out, std::nullopt, std::nullopt, calldata, signatures);
+      out += "]}";
+    }
+
+    void append_ndjson(std::string& out, size_t index, const Calldata* calldata,
+                       const signature_index::SignatureIndex* signatures) {
+      append_line(out, std::nullopt, index, calldata, signatures);
+    }
+
+    void append_ndjson(std::string& out, size_t index, const std::optional<Calldata>& calldata,
+                       const signature_index::SignatureIndex* signatures) {
+      append_ndjson(out, index, calldata ? &*calldata : nullptr, signatures);
+    }
+
+    void append_transaction_ndjson(std::string& out, uint64_t block, size_t index,
+                                   const Calldata* calldata,
+                                   const signature_index::SignatureIndex* signatures) {
+      append_line(out, block, index, calldata, signatures);
+    }
+
+  }  // namespace json_writer
+}  // namespace evmtools
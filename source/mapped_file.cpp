@@ -0,0 +1,169 @@
+#include <evmtools/mapped_file.h>
+
+#include <string>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+
+#  include <cerrno>
+#endif
+
+namespace evmtools {
+  namespace mapped_file {
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+      auto fail{[&](const char* what) {
+        return std::system_error(static_cast<int>(GetLastError()), std::system_category(),
+                                 std::string{what} + " " + path.string());
+      }};
+
+      HANDLE file{CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr)};
+      if (file == INVALID_HANDLE_VALUE) {
+        throw fail("failed to open");
+      }
+
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(file, &size)) {
+        auto error{fail("failed to stat")};
+        CloseHandle(file);
+        throw error;
+      }
+      this->length = static_cast<size_t>(size.QuadPart);
+
+      // Empty files can't be mapped.
+      if (this->length != 0) {
+        this->mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (this->mapping != nullptr) {
+          this->data = static_cast<const uint8_t*>(
+              MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, this->length));
+        }
+
+        if (this->data == nullptr) {
+          auto error{fail("failed to map")};
+          if (this->mapping != nullptr) CloseHandle(this->mapping);
+          CloseHandle(file);
+          throw error;
+        }
+      }
+
+      CloseHandle(file);
+    }
+
+    void MappedFile::unmap() noexcept {
+      if (this->data != nullptr) {
+        UnmapViewOfFile(this->data);
+      }
+      if (this->mapping != nullptr) {
+        CloseHandle(this->mapping);
+      }
+      this->data = nullptr;
+      this->mapping = nullptr;
+      this->length = 0;
+    }
+
+    void MappedFile::advise_sequential() const noexcept {
+      // Requested through FILE_FLAG_SEQUENTIAL_SCAN when opening the file.
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data(std::exchange(other.data, nullptr)),
+          length(std::exchange(other.length, 0)),
+          mapping(std::exchange(other.mapping, nullptr)) {}
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+      if (this != &other) {
+        this->unmap();
+        this->data = std::exchange(other.data, nullptr);
+        this->length = std::exchange(other.length, 0);
+        this->mapping = std::exchange(other.mapping, nullptr);
+      }
+      return *this;
+    }
+#else
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+      auto fail{[&](const char* what) {
+        return std::system_error(errno, std::generic_category(),
+                                 std::string{what} + " " + path.string());
+      }};
+
+      int fd{::open(path.c_str(), O_RDONLY)};
+      if (fd < 0) {
+        throw fail("failed to open");
+      }
+
+      struct stat info {};
+      if (::fstat(fd, &info) != 0) {
+        auto error{fail("failed to stat")};
+        ::close(fd);
+        throw error;
+      }
+      this->length = static_cast<size_t>(info.st_size);
+
+      // Empty files can't be mapped.
+      if (this->length != 0) {
+        void* mapped{::mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0)};
+        if (mapped == MAP_FAILED) {
+          auto error{fail("failed to map")};
+          ::close(fd);
+          throw error;
+        }
+        this->data = static_cast<const uint8_t*>(mapped);
+      }
+
+      // The mapping stays valid after the descriptor is closed.
+      ::close(fd);
+    }
+
+    void MappedFile::unmap() noexcept {
+      if (this->data != nullptr) {
+        ::munmap(const_cast<uint8_t*>(this->data), this->length);
+      }
+      this->data = nullptr;
+      this->length = 0;
+    }
+
+    void MappedFile::advise_sequential() const noexcept {
+      if (this->data != nullptr) {
+        ::madvise(const_cast<uint8_t*>(this->data), this->length, MADV_SEQUENTIAL);
+      }
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0)) {}
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+      if (this != &other) {
+        this->unmap();
+        this->data = std::exchange(other.data, nullptr);
+        this->length = std::exchange(other.length, 0);
+      }
+      return *this;
+    }
+#endif
+
+    MappedFile::~MappedFile() { this->unmap(); }
+
+    std::span<const uint8_t> MappedFile::bytes() const noexcept {
+      return {this->data, this->length};
+    }
+
+    std::string_view MappedFile::text() const noexcept {
+      return {reinterpret_cast<const char*>(this->data), this->length};
+    }
+
+    size_t MappedFile::size() const noexcept { return this->length; }
+
+  }  // namespace mapped_file
+}  // namespace evmtools
@@ -0,0 +1,190 @@
+#include <evmtools/replay.h>
+#include <evmtools/stream_decoder.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace evmtools {
+  namespace replay {
+    using clock = std::chrono::steady_clock;
+    using std::chrono::nanoseconds;
+
+    std::vector<Record> parse_records(std::string_view text) {
+      std::vector<Record> records;
+      size_t line_number{0};
+
+      while (!text.empty()) {
+        auto end{text.find('\n')};
+        auto line{text.substr(0, end)};
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        line_number++;
+
+        auto begin{line.find_first_not_of(" \t\r")};
+        if (begin == std::string_view::npos) {
+          continue;
+        }
+        line.remove_prefix(begin);
+
+        Record record{};
+        auto [rest, error]{std::from_chars(line.data(), line.data() + line.size(),
+                                           record.timestamp_us)};
+        if (error != std::errc{} || (rest != line.data() + line.size() && *rest != ' '
+                                     && *rest != '\t' && *rest != '\r')) {
+          throw std::invalid_argument("line " + std::to_string(line_number)
+                                      + " doesn't start with a timestamp");
+        }
+
+        line.remove_prefix(static_cast<size_t>(rest - line.data()));
+        record.input = stream_decoder::extract_calldata(line).value_or(std::string_view{});
+        records.push_back(record);
+      }
+
+      return records;
+    }
+
+    LatencySummary summarize(std::vector<nanoseconds> latencies) {
+      LatencySummary summary{};
+      if (latencies.empty()) {
+        return summary;
+      }
+
+      std::sort(latencies.begin(), latencies.end());
+      const auto count{static_cast<double>(latencies.size())};
+      auto rank{[&](double quantile) {
+        // The smallest latency at least `quantile` of the latencies are at or below.
+        auto index{static_cast<size_t>(std::ceil(quantile * count))};
+        return latencies[std::clamp<size_t>(index, 1, latencies.size()) - 1];
+      }};
+
+      summary.p50 = rank(0.5);
+      summary.p99 = rank(0.99);
+      summary.p999 = rank(0.999);
+      summary.max = latencies.back();
+
+      double total{0};
+      for (auto latency : latencies) total += static_cast<double>(latency.count());
+      summary.mean = nanoseconds{static_cast<nanoseconds::rep>(total / count)};
+
+      return summary;
+    }
+
+    double ReplayReport::throughput() const noexcept {
+      if (this->elapsed.count() <= 0) {
+        return 0;
+      }
+      return static_cast<double>(this->inputs)
+             / std::chrono::duration<double>{this->elapsed}.count();
+    }
+
+    ReplayReport replay(std::span<const Record> records, const ReplayOptions& options) {
+      ReplayReport report{};
+      report.inputs = records.size();
+      report.latencies.resize(records.size());
+
+      if (records.empty()) {
+        return report;
+      }
+
+      // Records are released in timestamp order, so a late record recorded early doesn't hold
+      // back the ones due before it. Ties keep their recorded order.
+      std::vector<size_t> order(records.size());
+      std::iota(order.begin(), order.end(), size_t{0});
+      std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return records[a].timestamp_us < records[b].timestamp_us;
+      });
+
+      const uint64_t origin{records[order.front()].timestamp_us};
+      const size_t batch_size{std::max<size_t>(options.batch_size, 1)};
+      const size_t thread_count{options.threads != 0
+                                    ? options.threads
+                                    : std::max(1u, std::thread::hardware_concurrency())};
+
+      // Records before `released` in `order` are due, and the workers claim them in order from
+      // `next`, so the oldest record waiting is always decoded first.
+      std::mutex mutex;
+      std::condition_variable wake;
+      size_t released{0};
+      size_t next{0};
+      std::atomic<size_t> decoded{0};
+      clock::time_point start{};
+
+      auto due{[&](size_t i) {
+        if (options.speed <= 0) {
+          return start;
+        }
+        std::chrono::duration<double, std::micro> offset{
+            static_cast<double>(records[order[i]].timestamp_us - origin) / options.speed};
+        return start + std::chrono::duration_cast<clock::duration>(offset);
+      }};
+
+      auto work{[&] {
+        while (true) {
+          size_t begin{0};
+          size_t end{0};
+          {
+            std::unique_lock lock{mutex};
+            wake.wait(lock, [&] { return next < released || next == records.size(); });
+            if (next == records.size()) {
+              return;
+            }
+            begin = next;
+            end = std::min(released, begin + batch_size);
+            next = end;
+          }
+
+          for (size_t i = begin; i < end; i++) {
+            auto result{calldata_decoder::try_decode(records[order[i]].input, options.decode)};
+            report.latencies[order[i]]
+                = std::chrono::duration_cast<nanoseconds>(clock::now() - due(i));
+            if (result) {
+              decoded.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        }
+      }};
+
+      // Start the workers before the clock, so starting threads isn't measured.
+      std::vector<std::thread> workers;
+      workers.reserve(thread_count);
+      {
+        std::lock_guard lock{mutex};
+        for (size_t i = 0; i < thread_count; i++) workers.emplace_back(work);
+        start = clock::now();
+      }
+
+      for (size_t i = 0; i < records.size();) {
+        // Release every record that is due, then sleep until the next one is.
+        auto now{clock::now()};
+        size_t end{i};
+        while (end < records.size() && due(end) <= now) end++;
+
+        if (end == i) {
+          std::this_thread::sleep_until(due(i));
+          continue;
+        }
+
+        {
+          std::lock_guard lock{mutex};
+          released = end;
+        }
+        wake.notify_all();
+        i = end;
+      }
+
+      for (auto& worker : workers) worker.join();
+
+      report.elapsed = std::chrono::duration_cast<nanoseconds>(clock::now() - start);
+      report.decoded = decoded.load();
+      return report;
+    }
+
+  }  // namespace replay
+}  // namespace evmtools
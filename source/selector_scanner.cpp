@@ -0,0 +1,175 @@
+#include <evmtools/selector_scanner.h>
+
+#include <algorithm>
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define EVMTOOLS_SCANNER_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    define EVMTOOLS_SCANNER_TARGET(isa)
+#  else
+#    define EVMTOOLS_SCANNER_TARGET(isa) __attribute__((target(isa)))
+#  endif
+#endif
+
+namespace evmtools {
+  namespace selector_scanner {
+    namespace {
+      // Filter bits per known selector. The filter is blocked: both bits of a selector are in
+      // the same 32-bit word, so a lookup is one load (or one gather lane). About 2% of unknown
+      // selectors pass a filter this full, and fewer once the size is rounded up to a power of two.
+      constexpr size_t BITS_PER_SELECTOR{16};
+      constexpr size_t MIN_FILTER_BITS{1024};
+
+      // Selectors come from Keccak, so multiplying is enough to get two independent hashes: the
+      // first picks the word, the second the two bits in it. The offset keeps the common all-zero
+      // window from always landing on word 0.
+      constexpr uint32_t HASH_OFFSET{0x7f4a7c15};
+      constexpr uint32_t HASH_1{0x9e3779b1};
+      constexpr uint32_t HASH_2{0x85ebca77};
+
+      constexpr uint32_t filter_word(uint32_t shift, uint32_t value) noexcept {
+        return ((value + HASH_OFFSET) * HASH_1) >> shift;
+      }
+
+      constexpr uint32_t filter_mask(uint32_t value) noexcept {
+        const uint32_t bits{(value + HASH_OFFSET) * HASH_2};
+        return uint32_t{1} << (bits >> 27) | uint32_t{1} << (bits >> 22 & 31);
+      }
+
+      constexpr bool filter_test(const uint32_t* filter, uint32_t shift, uint32_t value) noexcept {
+        const uint32_t mask{filter_mask(value)};
+        return (filter[filter_word(shift, value)] & mask) == mask;
+      }
+
+      /** Checks the windows starting at offsets [begin, end) one at a time. */
+      void scan_scalar(std::span<const uint8_t> data, size_t begin, size_t end,
+                       const SelectorSet& set, std::vector<Candidate>& out) {
+        if (begin >= end) {
+          return;
+        }
+
+        // The 4 bytes starting at `offset`, shifted in one byte at a time.
+        uint32_t window{uint32_t{data[begin]} << 16 | uint32_t{data[begin + 1]} << 8
+                        | uint32_t{data[begin + 2]}};
+        for (size_t offset = begin; offset < end; offset++) {
+          window = window << 8 | data[offset + 3];
+          if (set.may_contain(Selector{window}) && set.contains(Selector{window})) {
+            out.push_back(Candidate{offset, Selector{window}});
+          }
+        }
+      }
+
+#ifdef EVMTOOLS_SCANNER_X86
+      /**
+       * Checks 8 windows per step: each 128-bit half of a register reads 4 big-endian windows out
+       * of the same 16 bytes, then the filter words of all 8 are gathered at once. Returns the
+       * offset it stopped at.
+       */
+      EVMTOOLS_SCANNER_TARGET("avx2")
+      size_t scan_avx2(std::span<const uint8_t> data, size_t end, const uint32_t* filter,
+                       uint32_t shift, const SelectorSet& set, std::vector<Candidate>& out) {
+        const __m256i windows{_mm256_setr_epi8(3, 2, 1, 0, 4, 3, 2, 1, 5, 4, 3, 2, 6, 5, 4, 3,  //
+                                               7, 6, 5, 4, 8, 7, 6, 5, 9, 8, 7, 6, 10, 9, 8, 7)};
+        const __m256i offset{_mm256_set1_epi32(static_cast<int>(HASH_OFFSET))};
+        const __m256i hash_1{_mm256_set1_epi32(static_cast<int>(HASH_1))};
+        const __m256i hash_2{_mm256_set1_epi32(static_cast<int>(HASH_2))};
+        const __m256i one{_mm256_set1_epi32(1)};
+        const __m256i low_bits{_mm256_set1_epi32(31)};
+        const __m128i word_shift{_mm_cvtsi32_si128(static_cast<int>(shift))};
+        const auto* words{reinterpret_cast<const int*>(filter)};
+
+        size_t at{0};
+        // Each step reads 16 bytes.
+        for (; at + 8 <= end && at + 16 <= data.size(); at += 8) {
+          const __m128i bytes{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + at))};
+          const __m256i values{_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(bytes), windows)};
+          const __m256i biased{_mm256_add_epi32(values, offset)};
+
+          const __m256i index{_mm256_srl_epi32(_mm256_mullo_epi32(biased, hash_1), word_shift)};
+          const __m256i bits{_mm256_mullo_epi32(biased, hash_2)};
+          const __m256i mask{_mm256_or_si256(
+              _mm256_sllv_epi32(one, _mm256_srli_epi32(bits, 27)),
+              _mm256_sllv_epi32(one, _mm256_and_si256(_mm256_srli_epi32(bits, 22), low_bits)))};
+          const __m256i word{_mm256_i32gather_epi32(words, index, 4)};
+          const __m256i passed{_mm256_cmpeq_epi32(_mm256_and_si256(word, mask), mask)};
+          auto hits{static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(passed)))};
+          while (hits != 0) {
+            const auto lane{static_cast<unsigned>(std::countr_zero(hits))};
+            hits &= hits - 1;
+
+            const auto selector{Selector::from_bytes(data.data() + at + lane)};
+            if (set.contains(selector)) {
+              out.push_back(Candidate{at + lane, selector});
+            }
+          }
+        }
+
+        return at;
+      }
+#endif
+    }  // namespace
+
+    SelectorSet::SelectorSet(std::span<const Selector> selectors) {
+      this->known.reserve(selectors.size());
+      for (auto selector : selectors) this->known.push_back(selector.value);
+      std::sort(this->known.begin(), this->known.end());
+      this->known.erase(std::unique(this->known.begin(), this->known.end()), this->known.end());
+
+      const size_t bits{std::bit_ceil(std::max(MIN_FILTER_BITS,
+                                               this->known.size() * BITS_PER_SELECTOR))};
+      this->filter.assign(bits / 32, 0);
+      this->shift = static_cast<uint32_t>(32 - std::countr_zero(bits / 32));
+
+      for (auto value : this->known) {
+        this->filter[filter_word(this->shift, value)] |= filter_mask(value);
+      }
+    }
+
+    SelectorSet::SelectorSet(const signature_index::SignatureIndex& index)
+        : SelectorSet(index.selectors()) {}
+
+    bool SelectorSet::contains(const Selector selector) const noexcept {
+      return std::binary_search(this->known.begin(), this->known.end(), selector.value);
+    }
+
+    bool SelectorSet::may_contain(const Selector selector) const noexcept {
+      return filter_test(this->filter.data(), this->shift, selector.value);
+    }
+
+    size_t SelectorSet::size() const noexcept { return this->known.size(); }
+
+    void scan(std::span<const uint8_t> data, const SelectorSet& set, std::vector<Candidate>& out) {
+      scan(data, set, out, hex::best_kernel());
+    }
+
+    void scan(std::span<const uint8_t> data, const SelectorSet& set, std::vector<Candidate>& out,
+              const Kernel kernel) {
+      if (data.size() < calldata_decoder::SELECTOR_SIZE || set.known.empty()) {
+        return;
+      }
+
+      // Offsets a whole selector fits after.
+      const size_t end{data.size() - calldata_decoder::SELECTOR_SIZE + 1};
+      size_t done{0};
+
+#ifdef EVMTOOLS_SCANNER_X86
+      if (kernel == Kernel::Avx2 && hex::is_supported(kernel)) {
+        done = scan_avx2(data, end, set.filter.data(), set.shift, set, out);
+      }
+#else
+      (void)kernel;
+#endif
+
+      scan_scalar(data, done, end, set, out);
+    }
+
+    std::vector<Candidate> scan(std::span<const uint8_t> data, const SelectorSet& set) {
+      std::vector<Candidate> out;
+      scan(data, set, out);
+      return out;
+    }
+
+  }  // namespace selector_scanner
+}  // namespace evmtools
@@ -0,0 +1,325 @@
+#include <evmtools/signature_index.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace evmtools {
+  namespace signature_index {
+    using calldata_decoder::Selector;
+
+    namespace {
+      constexpr std::string_view MAGIC{"EVMSIG\0\1", 8};
+      constexpr size_t HEADER_SIZE{32};
+      constexpr size_t SLOT_SIZE{12};
+
+      // Average number of selectors per bucket. Higher means a smaller index but a slower build.
+      constexpr size_t BUCKET_LOAD{4};
+
+      // Displacements tried per bucket before giving up on a seed.
+      constexpr uint32_t MAX_DISPLACEMENT{1u << 24};
+
+      uint32_t load_u32(std::span<const uint8_t> bytes, size_t index) noexcept {
+        const auto* p{bytes.data() + index * 4};
+        return uint32_t{p[0]} | uint32_t{p[1]} << 8 | uint32_t{p[2]} << 16 | uint32_t{p[3]} << 24;
+      }
+
+      void store_u32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+          out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+      }
+
+      /** A 32-bit integer finaliser; selectors are already uniform, so this only mixes in seeds. */
+      constexpr uint32_t mix(uint32_t value, uint32_t seed) noexcept {
+        value ^= seed;
+        value ^= value >> 16;
+        value *= 0x7feb352d;
+        value ^= value >> 15;
+        value *= 0x846ca68b;
+        value ^= value >> 16;
+        return value;
+      }
+
+      constexpr size_t bucket_of(uint32_t selector, uint32_t seed, size_t buckets) noexcept {
+        return mix(selector, seed) % buckets;
+      }
+
+      constexpr size_t slot_of(uint32_t selector, uint32_t seed, uint32_t displacement,
+                               size_t slots) noexcept {
+        return mix(selector + displacement * 0x9e3779b9u, seed ^ 0x85ebca6bu) % slots;
+      }
+
+      std::string_view trim(std::string_view text) noexcept {
+        constexpr std::string_view whitespace{" \t\r\n"};
+        auto begin{text.find_first_not_of(whitespace)};
+        if (begin == std::string_view::npos) {
+          return {};
+        }
+        return text.substr(begin, text.find_last_not_of(whitespace) - begin + 1);
+      }
+
+      /**
+       * Finds a displacement for every bucket so that all selectors land in distinct slots.
+       * Returns an empty vector if some bucket can't be placed with this seed.
+       */
+      std::vector<uint32_t> place(const std::vector<uint32_t>& selectors, uint32_t seed,
+                                  size_t bucket_count) {
+        const size_t slot_count{selectors.size()};
+        std::vector<std::vector<uint32_t>> buckets(bucket_count);
+        for (auto selector : selectors) {
+          buckets[bucket_of(selector, seed, bucket_count)].push_back(selector);
+        }
+
+        // Place the largest buckets first, while most slots are still free.
+        std::vector<size_t> order(bucket_count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+          return buckets[a].size() > buckets[b].size();
+        });
+
+        std::vector<uint32_t> displacements(bucket_count, 0);
+        std::vector<bool> taken(slot_count, false);
+        std::vector<size_t> candidate;
+
+        for (auto bucket : order) {
+          if (buckets[bucket].empty()) {
+            break;
+          }
+
+          bool placed{false};
+          for (uint32_t displacement = 0; !placed && displacement < MAX_DISPLACEMENT;
+               displacement++) {
+            candidate.clear();
+            placed = true;
+
+            for (auto selector : buckets[bucket]) {
+              auto slot{slot_of(selector, seed, displacement, slot_count)};
+              if (taken[slot] || std::find(candidate.begin(), candidate.end(), slot)
+                                     != candidate.end()) {
+                placed = false;
+                break;
+              }
+              candidate.push_back(slot);
+            }
+
+            if (placed) {
+              displacements[bucket] = displacement;
+              for (auto slot : candidate) taken[slot] = true;
+            }
+          }
+
+          if (!placed) {
+            return {};
+          }
+        }
+
+        return displacements;
+      }
+    }  // namespace
+
+    std::vector<uint8_t> build_signature_index(std::string_view signature_list) {
+      // Group signatures by selector, in the order they're listed.
+      std::vector<uint32_t> selectors;
+      std::vector<std::vector<std::string_view>> grouped;
+      std::unordered_map<uint32_t, size_t> group_of;
+
+      while (!signature_list.empty()) {
+        auto end{signature_list.find('\n')};
+        auto line{trim(signature_list.substr(0, end))};
+        signature_list.remove_prefix(end == std::string_view::npos ? signature_list.size()
+                                                                   : end + 1);
+
+        if (line.empty() || line.starts_with('#')) {
+          continue;
+        }
+
+        auto selector{selector_from_signature(line).value};
+        auto [it, inserted]{group_of.try_emplace(selector, grouped.size())};
+        if (inserted) {
+          selectors.push_back(selector);
+          grouped.emplace_back();
+        }
+
+        auto& group{grouped[it->second]};
+        if (std::find(group.begin(), group.end(), line) == group.end()) {
+          group.push_back(line);
+        }
+      }
+
+      const size_t slot_count{selectors.size()};
+      const size_t bucket_count{std::max<size_t>(1, (slot_count + BUCKET_LOAD - 1) / BUCKET_LOAD)};
+
+      uint32_t seed{0};
+      std::vector<uint32_t> displacements;
+      while (slot_count != 0 && (displacements = place(selectors, seed, bucket_count)).empty()) {
+        seed++;
+      }
+      displacements.resize(bucket_count, 0);
+
+      // Order the slots by where the hash puts them.
+      std::vector<size_t> slot_group(slot_count);
+      for (size_t group = 0; group < slot_count; group++) {
+        auto selector{selectors[group]};
+        auto displacement{displacements[bucket_of(selector, seed, bucket_count)]};
+        slot_group[slot_of(selector, seed, displacement, slot_count)] = group;
+      }
+
+      size_t signature_count{0};
+      size_t blob_size{0};
+      for (const auto& group : grouped) {
+        signature_count += group.size();
+        for (auto signature : group) blob_size += signature.size();
+      }
+
+      if (blob_size > UINT32_MAX || signature_count > UINT32_MAX) {
+        throw std::length_error("signature list is too large to index");
+      }
+
+      std::vector<uint8_t> image(MAGIC.begin(), MAGIC.end());
+      image.reserve(HEADER_SIZE + bucket_count * 4 + slot_count * SLOT_SIZE
+                    + (signature_count + 1) * 4 + blob_size);
+
+      store_u32(image, seed);
+      store_u32(image, static_cast<uint32_t>(bucket_count));
+      store_u32(image, static_cast<uint32_t>(slot_count));
+      store_u32(image, static_cast<uint32_t>(signature_count));
+      store_u32(image, static_cast<uint32_t>(blob_size));
+      store_u32(image, 0);
+
+      for (auto displacement : displacements) {
+        store_u32(image, displacement);
+      }
+
+      uint32_t first_signature{0};
+      for (auto group : slot_group) {
+        store_u32(image, selectors[group]);
+        store_u32(image, first_signature);
+        store_u32(image, static_cast<uint32_t>(grouped[group].size()));
+        first_signature += static_cast<uint32_t>(grouped[group].size());
+      }
+
+      uint32_t offset{0};
+      for (auto group : slot_group) {
+        for (auto signature : grouped[group]) {
+          store_u32(image, offset);
+          offset += static_cast<uint32_t>(signature.size());
+        }
+      }
+      store_u32(image, offset);
+
+      for (auto group : slot_group) {
+        for (auto signature : grouped[group]) {
+          image.insert(image.end(), signature.begin(), signature.end());
+        }
+      }
+
+      return image;
+    }
+
+    SignatureIndex::SignatureIndex(const std::filesystem::path& path) : file(std::in_place, path) {
+      this->image = this->file->bytes();
+      this->parse();
+    }
+
+    SignatureIndex::SignatureIndex(std::vector<uint8_t> image) : owned(std::move(image)) {
+      this->image = this->owned;
+      this->parse();
+    }
+
+    void SignatureIndex::parse() {
+      auto fail{[](const char* what) {
+        return std::runtime_error(std::string{"invalid signature index: "} + what);
+      }};
+
+      if (this->image.size() < HEADER_SIZE
+          || std::memcmp(this->image.data(), MAGIC.data(), MAGIC.size()) != 0) {
+        throw fail("bad magic");
+      }
+
+      auto header{this->image.subspan(MAGIC.size())};
+      this->seed = load_u32(header, 0);
+      const size_t bucket_count{load_u32(header, 1)};
+      const size_t slot_count{load_u32(header, 2)};
+      const size_t signature_count{load_u32(header, 3)};
+      const size_t blob_size{load_u32(header, 4)};
+
+      const size_t expected{HEADER_SIZE + bucket_count * 4 + slot_count * SLOT_SIZE
+                            + (signature_count + 1) * 4 + blob_size};
+      if (bucket_count == 0 || this->image.size() != expected) {
+        throw fail("truncated or corrupt file");
+      }
+
+      auto rest{this->image.subspan(HEADER_SIZE)};
+      this->displacements = rest.first(bucket_count * 4);
+      rest = rest.subspan(bucket_count * 4);
+      this->slots = rest.first(slot_count * SLOT_SIZE);
+      rest = rest.subspan(slot_count * SLOT_SIZE);
+      this->offsets = rest.first((signature_count + 1) * 4);
+      this->blob = rest.subspan((signature_count + 1) * 4);
+    }
+
+    std::optional<size_t> SignatureIndex::find_slot(const Selector selector) const noexcept {
+      const size_t slot_count{this->slots.size() / SLOT_SIZE};
+      if (slot_count == 0) {
+        return std::nullopt;
+      }
+
+      auto bucket{bucket_of(selector.value, this->seed, this->displacements.size() / 4)};
+      auto displacement{load_u32(this->displacements, bucket)};
+      auto slot{slot_of(selector.value, this->seed, displacement, slot_count)};
+
+      // Selectors that aren't indexed still hash to some slot, so check it's really ours.
+      if (load_u32(this->slots, slot * 3) != selector.value) {
+        return std::nullopt;
+      }
+
+      return slot;
+    }
+
+    std::optional<std::string_view> SignatureIndex::find(const Selector selector) const noexcept {
+      return this->signature(selector, 0);
+    }
+
+    size_t SignatureIndex::count(const Selector selector) const noexcept {
+      auto slot{this->find_slot(selector)};
+      return slot ? load_u32(this->slots, *slot * 3 + 2) : 0;
+    }
+
+    std::optional<std::string_view> SignatureIndex::signature(const Selector selector,
+                                                              size_t n) const noexcept {
+      auto slot{this->find_slot(selector)};
+      if (!slot || n >= load_u32(this->slots, *slot * 3 + 2)) {
+        return std::nullopt;
+      }
+
+      const size_t signature{load_u32(this->slots, *slot * 3 + 1) + n};
+      if (signature + 1 >= this->offsets.size() / 4) {
+        return std::nullopt;
+      }
+
+      const size_t begin{load_u32(this->offsets, signature)};
+      const size_t end{load_u32(this->offsets, signature + 1)};
+      if (begin > end || end > this->blob.size()) {
+        return std::nullopt;
+      }
+
+      return std::string_view{reinterpret_cast<const char*>(this->blob.data()) + begin,
+                              end - begin};
+    }
+
+    size_t SignatureIndex::size() const noexcept { return this->slots.size() / SLOT_SIZE; }
+
+    std::vector<Selector> SignatureIndex::selectors() const {
+      std::vector<Selector> indexed(this->size());
+      for (size_t slot = 0; slot < indexed.size(); slot++) {
+        indexed[slot] = Selector{load_u32(this->slots, slot * 3)};
+      }
+      return indexed;
+    }
+
+  }  // namespace signature_index
+}  // namespace evmtools
@@ -0,0 +1,345 @@
+#include <evmtools/batch_decoder.h>
+#include <evmtools/columnar.h>
+#include <evmtools/decode_cache.h>
+#include <evmtools/hex.h>
+#include <evmtools/json_writer.h>
+#include <evmtools/stream_decoder.h>
+#include <evmtools/thread_pool.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace evmtools {
+  namespace stream_decoder {
+    using calldata_decoder::Calldata;
+
+    namespace {
+      /**
+       * A blocking FIFO queue holding at most `capacity` items, used to connect pipeline stages.
+       */
+      template <typename T> class BoundedQueue {
+      public:
+        explicit BoundedQueue(size_t capacity) : capacity(std::max<size_t>(capacity, 1)) {}
+
+        /** Blocks while the queue is full, returning false and dropping `item` once it's closed. */
+        bool push(T item) {
+          std::unique_lock lock{this->mutex};
+          this->not_full.wait(lock, [this] {
+            return this->items.size() < this->capacity || this->closed;
+          });
+
+          if (this->closed) {
+            return false;
+          }
+
+          this->items.push_back(std::move(item));
+          this->not_empty.notify_one();
+          return true;
+        }
+
+        /** Blocks while the queue is empty, returning `std::nullopt` once it's closed and empty. */
+        std::optional<T> pop() {
+          std::unique_lock lock{this->mutex};
+          this->not_empty.wait(lock, [this] { return !this->items.empty() || this->closed; });
+
+          if (this->items.empty()) {
+            return std::nullopt;
+          }
+
+          T item{std::move(this->items.front())};
+          this->items.pop_front();
+          this->not_full.notify_one();
+          return item;
+        }
+
+        void close() {
+          std::lock_guard lock{this->mutex};
+          this->closed = true;
+          this->not_empty.notify_all();
+          this->not_full.notify_all();
+        }
+
+      private:
+        size_t capacity;
+        std::deque<T> items;
+        bool closed{false};
+        std::mutex mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+      };
+
+      struct Batch {
+        size_t first_index{0};
+        std::vector<std::string_view> inputs;
+        std::vector<std::optional<Calldata>> results;
+        // Used instead of `results` when decoding through a cache.
+        std::vector<std::shared_ptr<const Calldata>> cached;
+      };
+
+      /**
+       * Closes both queues and joins the reader and writer when stage 2 leaves, so an exception
+       * while decoding doesn't destroy threads that are still running.
+       */
+      class StageJoiner {
+      public:
+        StageJoiner(BoundedQueue<Batch>& to_decode, BoundedQueue<Batch>& to_write,
+                    std::thread& reader, std::thread& writer) noexcept
+            : to_decode(to_decode), to_write(to_write), reader(reader), writer(writer) {}
+
+        StageJoiner(const StageJoiner&) = delete;
+        StageJoiner& operator=(const StageJoiner&) = delete;
+
+        ~StageJoiner() {
+          this->to_decode.close();
+          this->to_write.close();
+          if (this->reader.joinable()) this->reader.join();
+          if (this->writer.joinable()) this->writer.join();
+        }
+
+      private:
+        BoundedQueue<Batch>& to_decode;
+        BoundedQueue<Batch>& to_write;
+        std::thread& reader;
+        std::thread& writer;
+      };
+
+      std::string_view trim(std::string_view text) noexcept {
+        constexpr std::string_view whitespace{" \t\r\n"};
+        auto begin{text.find_first_not_of(whitespace)};
+        if (begin == std::string_view::npos) {
+          return {};
+        }
+        return text.substr(begin, text.find_last_not_of(whitespace) - begin + 1);
+      }
+
+      void append_word(std::string& out, const calldata_decoder::Word& word,
+                       const calldata_decoder::ParamTypes* types) {
+        const size_t at{out.size() + 1};
+        out.resize(at + calldata_decoder::WORD_SIZE * 2, '\t');
+        hex::encode(word.bytes, std::span{out}.subspan(at));
+
+        if (types == nullptr) {
+          return;
+        }
+
+        char separator{':'};
+        for (auto type : *types) {
+          out += separator;
+          out += calldata_decoder::type_name(type);
+          separator = '|';
+        }
+      }
+
+      void append_call(std::string& out, std::string_view index,
+                       const calldata_decoder::Selector selector,
+                       std::span<const calldata_decoder::Word> words,
+                       std::span<const calldata_decoder::ParamTypes> types,
+                       const signature_index::SignatureIndex* signatures) {
+        out += index;
+        out += '\t';
+        out += selector.to_hex();
+
+        if (signatures != nullptr) {
+          if (auto signature = signatures->find(selector)) {
+            out += ':';
+            out += *signature;
+          }
+        }
+
+        for (size_t i = 0; i < words.size(); i++) {
+          append_word(out, words[i], i < types.size() ? &types[i] : nullptr);
+        }
+
+        out += '\n';
+      }
+    }  // namespace
+
+    std::optional<std::string_view> extract_calldata(std::string_view line) noexcept {
+      line = trim(line);
+
+      if (!line.starts_with('{')) {
+        return line;
+      }
+
+      constexpr std::string_view key{"\"input\""};
+      auto key_pos{line.find(key)};
+      if (key_pos == std::string_view::npos) {
+        return std::nullopt;
+      }
+
+      auto rest{trim(line.substr(key_pos + key.size()))};
+      if (!rest.starts_with(':')) {
+        return std::nullopt;
+      }
+
+      rest = trim(rest.substr(1));
+      if (!rest.starts_with('"')) {
+        return std::nullopt;
+      }
+
+      auto end{rest.find('"', 1)};
+      if (end == std::string_view::npos) {
+        return std::nullopt;
+      }
+
+      return rest.substr(1, end - 1);
+    }
+
+    void format_text(std::string& out, size_t index, const std::optional<Calldata>& calldata,
+                     const signature_index::SignatureIndex* signatures) {
+      format_text(out, index, calldata ? &*calldata : nullptr, signatures);
+    }
+
+    void format_text(std::string& out, size_t index, const Calldata* calldata,
+                     const signature_index::SignatureIndex* signatures) {
+      format_text(out, std::string_view{std::to_string(index)}, calldata, signatures);
+    }
+
+    void format_text(std::string& out, std::string_view label, const Calldata* calldata,
+                     const signature_index::SignatureIndex* signatures) {
+      if (!calldata) {
+        out += label;
+        out += "\terror\n";
+        return;
+      }
+
+      append_call(out, label, calldata->selector, calldata->params,
+                  calldata->main_details.param_types, signatures);
+
+      std::string nested_label{label};
+      nested_label += '.';
+      for (size_t n = 0; n < calldata->nested_details.size(); n++) {
+        const auto& nested{calldata->nested_details[n]};
+        nested_label.resize(label.size() + 1);
+        nested_label += std::to_string(n);
+        append_call(out, nested_label, nested.selector, nested.params, nested.param_types,
+                    signatures);
+      }
+    }
+
+    StreamStats decode_stream(std::string_view input, std::ostream& out,
+                              const StreamOptions& options) {
+      const size_t batch_size{std::max<size_t>(options.batch_size, 1)};
+      BoundedQueue<Batch> to_decode{options.queue_depth};
+      BoundedQueue<Batch> to_write{options.queue_depth};
+      StreamStats stats{};
+
+      // Stage 1: split the input into batches of lines.
+      std::thread reader{[&] {
+        Batch batch{};
+        size_t index{0};
+
+        while (!input.empty()) {
+          auto end{input.find('\n')};
+          auto line{input.substr(0, end)};
+          input.remove_prefix(end == std::string_view::npos ? input.size() : end + 1);
+
+          if (trim(line).empty()) {
+            continue;
+          }
+
+          // Inputs without calldata are kept so they're reported as errors in order.
+          batch.inputs.push_back(extract_calldata(line).value_or(std::string_view{}));
+          stats.bytes += line.size();
+          index++;
+
+          if (batch.inputs.size() == batch_size) {
+            // Stage 2 closes the queue early if it fails.
+            if (!to_decode.push(std::move(batch))) {
+              return;
+            }
+            batch = Batch{index, {}, {}, {}};
+          }
+        }
+
+        if (!batch.inputs.empty()) {
+          to_decode.push(std::move(batch));
+        }
+        to_decode.close();
+      }};
+
+      std::exception_ptr write_error;
+
+      // Stage 3: format the results in order.
+      std::thread writer{[&] {
+        if (options.format == OutputFormat::Columnar) {
+          try {
+            columnar::ColumnWriter columns{out};
+            while (auto batch = to_write.pop()) {
+              for (size_t i = 0; i < batch->results.size(); i++) {
+                columns.append(batch->first_index + i, batch->results[i]);
+              }
+              for (size_t i = 0; i < batch->cached.size(); i++) {
+                columns.append(batch->first_index + i, batch->cached[i].get());
+              }
+            }
+            columns.flush();
+          } catch (...) {
+            // Keep draining, so the earlier stages don't block on a full queue.
+            write_error = std::current_exception();
+            while (to_write.pop()) {
+            }
+          }
+          return;
+        }
+
+        std::string text;
+        auto format{[&](size_t index, const Calldata* calldata) {
+          if (options.format == OutputFormat::Json) {
+            json_writer::append_ndjson(text, index, calldata, options.signatures);
+          } else {
+            format_text(text, index, calldata, options.signatures);
+          }
+        }};
+
+        while (auto batch = to_write.pop()) {
+          text.clear();
+          for (size_t i = 0; i < batch->results.size(); i++) {
+            format(batch->first_index + i, batch->results[i] ? &*batch->results[i] : nullptr);
+          }
+          for (size_t i = 0; i < batch->cached.size(); i++) {
+            format(batch->first_index + i, batch->cached[i].get());
+          }
+          out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+      }};
+
+      // Stage 2: decode each batch across the pool.
+      StageJoiner joiner{to_decode, to_write, reader, writer};
+      thread_pool::ThreadPool pool{options.threads};
+      while (auto batch = to_decode.pop()) {
+        if (options.cache != nullptr) {
+          batch->cached = decode_cache::decode_batch(batch->inputs, pool, *options.cache);
+        } else {
+          batch->results = calldata_decoder::decode_batch(batch->inputs, pool, options.decode);
+        }
+
+        stats.inputs += batch->inputs.size();
+        for (const auto& result : batch->results) {
+          stats.decoded += result.has_value() ? 1 : 0;
+        }
+        for (const auto& result : batch->cached) {
+          stats.decoded += result != nullptr ? 1 : 0;
+        }
+
+        to_write.push(std::move(*batch));
+      }
+      to_write.close();
+
+      reader.join();
+      writer.join();
+      out.flush();
+
+      if (write_error) {
+        std::rethrow_exception(write_error);
+      }
+
+      return stats;
+    }
+
+  }  // namespace stream_decoder
+}  // namespace evmtools
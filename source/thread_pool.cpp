@@ -0,0 +1,166 @@
+#include <evmtools/thread_pool.h>
+
+#include <algorithm>
+#include <exception>
+
+namespace evmtools {
+  namespace thread_pool {
+    namespace {
+      // The pool and queue index of the worker running on this thread, if any.
+      thread_local const ThreadPool* current_pool{nullptr};
+      thread_local size_t current_index{0};
+    }  // namespace
+
+    ThreadPool::ThreadPool(size_t threads) {
+      if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+      }
+
+      for (size_t i = 0; i < threads; i++) {
+        this->queues.push_back(std::make_unique<Queue>());
+      }
+
+      this->workers.reserve(threads);
+      for (size_t i = 0; i < threads; i++) {
+        this->workers.emplace_back([this, i] { this->worker_loop(i); });
+      }
+    }
+
+    ThreadPool::~ThreadPool() {
+      {
+        std::lock_guard lock{this->sleep_mutex};
+        this->stopping = true;
+      }
+      this->wake.notify_all();
+
+      for (auto& worker : this->workers) {
+        worker.join();
+      }
+    }
+
+    size_t ThreadPool::size() const noexcept { return this->workers.size(); }
+
+    void ThreadPool::submit(std::function<void()> task) {
+      size_t index{current_pool == this
+                       ? current_index
+                       : this->next_queue.fetch_add(1, std::memory_order_relaxed) % this->size()};
+
+      {
+        // Count the task under the sleep mutex so a worker about to sleep can't miss it, and
+        // before queueing it so the count never drops below zero.
+        std::lock_guard lock{this->sleep_mutex};
+        this->queued.fetch_add(1, std::memory_order_release);
+      }
+
+      {
+        std::lock_guard lock{this->queues[index]->mutex};
+        this->queues[index]->tasks.push_back(std::move(task));
+      }
+      this->wake.notify_one();
+    }
+
+    void ThreadPool::parallel_for(size_t count, size_t grain,
+                                  const std::function<void(size_t begin, size_t end)>& body) {
+      grain = std::max<size_t>(grain, 1);
+      const size_t chunks{(count + grain - 1) / grain};
+
+      std::atomic<size_t> remaining{chunks};
+      std::exception_ptr error;
+      std::mutex error_mutex;
+
+      for (size_t chunk = 0; chunk < chunks; chunk++) {
+        this->submit([&, chunk] {
+          try {
+            body(chunk * grain, std::min(count, (chunk + 1) * grain));
+          } catch (...) {
+            std::lock_guard lock{error_mutex};
+            if (!error) error = std::current_exception();
+          }
+          if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Take the sleep mutex so a caller about to sleep can't miss the last chunk.
+            { std::lock_guard lock{this->sleep_mutex}; }
+            this->wake.notify_all();
+          }
+        });
+      }
+
+      // Help out while there is work to take, so nested calls from within tasks can't deadlock,
+      // and sleep once every remaining chunk is running elsewhere.
+      const size_t home{current_pool == this ? current_index : 0};
+      while (remaining.load(std::memory_order_acquire) != 0) {
+        if (this->run_one(home)) {
+          continue;
+        }
+
+        std::unique_lock lock{this->sleep_mutex};
+        this->wake.wait(lock, [&] {
+          return remaining.load(std::memory_order_acquire) == 0
+                 || this->queued.load(std::memory_order_acquire) != 0;
+        });
+      }
+
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+
+    bool ThreadPool::run_one(size_t home) {
+      std::function<void()> task;
+
+      // Newest task from our own queue first.
+      {
+        auto& queue{*this->queues[home]};
+        std::lock_guard lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+          task = std::move(queue.tasks.back());
+          queue.tasks.pop_back();
+        }
+      }
+
+      // Otherwise steal the oldest task from the other queues.
+      for (size_t offset = 1; !task && offset < this->queues.size(); offset++) {
+        auto& queue{*this->queues[(home + offset) % this->queues.size()]};
+        std::lock_guard lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+          task = std::move(queue.tasks.front());
+          queue.tasks.pop_front();
+        }
+      }
+
+      if (!task) {
+        return false;
+      }
+
+      this->queued.fetch_sub(1, std::memory_order_acq_rel);
+
+      try {
+        task();
+      } catch (...) {
+        // Tasks report their own errors; see `parallel_for`.
+      }
+
+      return true;
+    }
+
+    void ThreadPool::worker_loop(size_t index) {
+      current_pool = this;
+      current_index = index;
+
+      while (true) {
+        if (this->run_one(index)) {
+          continue;
+        }
+
+        std::unique_lock lock{this->sleep_mutex};
+        this->wake.wait(lock, [this] {
+          return this->stopping || this->queued.load(std::memory_order_acquire) != 0;
+        });
+
+        if (this->stopping && this->queued.load(std::memory_order_acquire) == 0) {
+          return;
+        }
+      }
+    }
+
+  }  // namespace thread_pool
+}  // namespace evmtools
@@ -0,0 +1,290 @@
+#include <evmtools/transaction_decoder.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace evmtools {
+  namespace transaction_decoder {
+    namespace {
+      // Most fields of any supported transaction: a signed blob transaction.
+      constexpr size_t MAX_FIELDS{14};
+
+      constexpr size_t ADDRESS_SIZE{20};
+
+      // Index of the number in a block header.
+      constexpr size_t BLOCK_NUMBER_FIELD{8};
+
+      /** One RLP item. */
+      struct Item {
+        // The string's bytes, or the encoded items of the list.
+        std::span<const uint8_t> payload;
+        bool list{false};
+        // The whole item, prefix included.
+        std::span<const uint8_t> encoded;
+      };
+
+      [[noreturn]] void malformed(const char* what) {
+        throw std::invalid_argument(std::string{"malformed RLP: "} + what);
+      }
+
+      /** Reads the item at the start of `data`, checking that it is canonical. */
+      Item read_item(std::span<const uint8_t> data) {
+        if (data.empty()) {
+          malformed("unexpected end of input");
+        }
+
+        const uint8_t prefix{data[0]};
+        if (prefix < 0x80) {
+          return Item{data.first(1), false, data.first(1)};
+        }
+
+        const bool list{prefix >= 0xc0};
+        const uint8_t short_base{list ? uint8_t{0xc0} : uint8_t{0x80}};
+        const uint8_t long_base{list ? uint8_t{0xf7} : uint8_t{0xb7}};
+
+        size_t header{1};
+        size_t length{0};
+        if (prefix <= long_base) {
+          length = prefix - short_base;
+        } else {
+          const size_t length_size{static_cast<size_t>(prefix - long_base)};
+          if (data.size() < 1 + length_size) {
+            malformed("truncated length");
+          }
+          if (data[1] == 0) {
+            malformed("length with leading zeros");
+          }
+          for (size_t i = 0; i < length_size; i++) {
+            length = length << 8 | data[1 + i];
+          }
+          if (length < 56) {
+            malformed("long form for a short length");
+          }
+          header += length_size;
+        }
+
+        if (length > data.size() - header) {
+          malformed("item runs past the end of its input");
+        }
+
+        auto payload{data.subspan(header, length)};
+        if (!list && length == 1 && payload[0] < 0x80) {
+          malformed("single byte not encoded as itself");
+        }
+
+        return Item{payload, list, data.first(header + length)};
+      }
+
+      /** Reads `data`, which must be exactly one item. */
+      Item read_whole(std::span<const uint8_t> data) {
+        auto item{read_item(data)};
+        if (item.encoded.size() != data.size()) {
+          malformed("trailing bytes");
+        }
+        return item;
+      }
+
+      std::span<const uint8_t> string_field(const Item& item) {
+        if (item.list) {
+          malformed("list where a string was expected");
+        }
+        return item.payload;
+      }
+
+      /** A big-endian integer field, which must not have leading zeros. */
+      std::span<const uint8_t> integer_field(const Item& item, size_t max_size) {
+        auto bytes{string_field(item)};
+        if (bytes.size() > max_size) {
+          malformed("integer too large");
+        }
+        if (!bytes.empty() && bytes[0] == 0) {
+          malformed("integer with leading zeros");
+        }
+        return bytes;
+      }
+
+      uint64_t u64_field(const Item& item) {
+        uint64_t value{0};
+        for (auto byte : integer_field(item, 8)) value = value << 8 | byte;
+        return value;
+      }
+
+      /** Where the fields are in the list of each type. */
+      struct Layout {
+        // Number of fields of an unsigned transaction; signed ones have 3 more.
+        size_t fields;
+        // Index of the chain id, or MAX_FIELDS if there is none.
+        size_t chain_id;
+        size_t nonce;
+        size_t gas_limit;
+        // Index of the recipient, which the value and data follow.
+        size_t to;
+        // Index of the access list, or MAX_FIELDS if there is none.
+        size_t access_list;
+      };
+
+      constexpr Layout layout_of(const TransactionType type) noexcept {
+        switch (type) {
+          case TransactionType::AccessList:
+            return Layout{8, 0, 1, 3, 4, 7};
+          case TransactionType::DynamicFee:
+            return Layout{9, 0, 1, 4, 5, 8};
+          case TransactionType::Blob:
+            return Layout{11, 0, 1, 4, 5, 8};
+          case TransactionType::Legacy:
+            break;
+        }
+        return Layout{6, MAX_FIELDS, 0, 2, 3, MAX_FIELDS};
+      }
+
+      Transaction decode_fields(const TransactionType type, std::span<const uint8_t> encoded,
+                                std::span<const uint8_t> list) {
+        std::array<Item, MAX_FIELDS> fields{};
+        size_t count{0};
+        while (!list.empty()) {
+          if (count == MAX_FIELDS) {
+            malformed("too many fields");
+          }
+          fields[count] = read_item(list);
+          list = list.subspan(fields[count].encoded.size());
+          count++;
+        }
+
+        const auto layout{layout_of(type)};
+        if (count != layout.fields && count != layout.fields + 3) {
+          malformed("wrong number of fields");
+        }
+
+        Transaction transaction{};
+        transaction.type = type;
+        transaction.encoded = encoded;
+        transaction.nonce = u64_field(fields[layout.nonce]);
+        transaction.gas_limit = u64_field(fields[layout.gas_limit]);
+        transaction.to = string_field(fields[layout.to]);
+        transaction.value = integer_field(fields[layout.to + 1], 32);
+        transaction.data = string_field(fields[layout.to + 2]);
+
+        if (!transaction.to.empty() && transaction.to.size() != ADDRESS_SIZE) {
+          malformed("recipient is not an address");
+        }
+        if (type == TransactionType::Blob && transaction.is_create()) {
+          malformed("blob transaction without a recipient");
+        }
+        if (layout.access_list != MAX_FIELDS && !fields[layout.access_list].list) {
+          malformed("access list is not a list");
+        }
+
+        if (layout.chain_id != MAX_FIELDS) {
+          transaction.chain_id = u64_field(fields[layout.chain_id]);
+        } else if (count == layout.fields + 3) {
+          // EIP-155 folds the chain id into v as chain_id * 2 + 35 or 36.
+          const uint64_t v{u64_field(fields[layout.fields])};
+          if (v >= 35) {
+            transaction.chain_id = (v - 35) / 2;
+          }
+        }
+
+        return transaction;
+      }
+    }  // namespace
+
+    intx::uint256 Transaction::value_uint() const noexcept {
+      std::array<uint8_t, 32> padded{};
+      std::copy(this->value.begin(), this->value.end(), padded.end() - this->value.size());
+      return intx::be::unsafe::load<intx::uint256>(padded.data());
+    }
+
+    Transaction decode_transaction(std::span<const uint8_t> encoded) {
+      if (encoded.empty()) {
+        malformed("empty input");
+      }
+
+      // Block bodies hold typed transactions as RLP strings.
+      if (encoded[0] >= 0x80 && encoded[0] < 0xc0) {
+        encoded = read_whole(encoded).payload;
+        if (encoded.empty() || encoded[0] >= 0x80) {
+          malformed("string does not hold a typed transaction");
+        }
+      }
+
+      if (encoded[0] >= 0xc0) {
+        return decode_fields(TransactionType::Legacy, encoded, read_whole(encoded).payload);
+      }
+
+      if (encoded[0] < static_cast<uint8_t>(TransactionType::AccessList)
+          || encoded[0] > static_cast<uint8_t>(TransactionType::Blob)) {
+        malformed("unsupported transaction type");
+      }
+
+      const auto type{static_cast<TransactionType>(encoded[0])};
+      auto body{read_whole(encoded.subspan(1))};
+      if (!body.list) {
+        malformed("typed transaction body is not a list");
+      }
+
+      // The network form of a blob transaction wraps the transaction in a list with its blobs.
+      if (type == TransactionType::Blob && !body.payload.empty() && read_item(body.payload).list) {
+        body = read_item(body.payload);
+      }
+
+      return decode_fields(type, encoded, body.payload);
+    }
+
+    std::optional<Transaction> try_decode_transaction(std::span<const uint8_t> encoded) noexcept {
+      try {
+        return decode_transaction(encoded);
+      } catch (const std::exception&) {
+        return std::nullopt;
+      }
+    }
+
+    std::vector<std::span<const uint8_t>> split_transactions(std::span<const uint8_t> list) {
+      auto whole{read_whole(list)};
+      if (!whole.list) {
+        malformed("transactions are not a list");
+      }
+
+      std::vector<std::span<const uint8_t>> transactions;
+      auto rest{whole.payload};
+      while (!rest.empty()) {
+        auto item{read_item(rest)};
+        transactions.push_back(item.encoded);
+        rest = rest.subspan(item.encoded.size());
+      }
+      return transactions;
+    }
+
+    Block decode_block(std::span<const uint8_t> encoded) {
+      auto block{read_whole(encoded)};
+      if (!block.list) {
+        malformed("block is not a list");
+      }
+
+      auto header{read_item(block.payload)};
+      if (!header.list) {
+        malformed("block header is not a list");
+      }
+
+      auto fields{header.payload};
+      for (size_t i = 0; i < BLOCK_NUMBER_FIELD; i++) {
+        fields = fields.subspan(read_item(fields).encoded.size());
+      }
+
+      Block decoded{};
+      decoded.number = u64_field(read_item(fields));
+      decoded.transactions
+          = split_transactions(read_item(block.payload.subspan(header.encoded.size())).encoded);
+      return decoded;
+    }
+
+    size_t item_size(std::span<const uint8_t> data) { return read_item(data).encoded.size(); }
+
+    DecodeResult decode_calldata(const Transaction& transaction, const DecodeOptions& options,
+                                 allocator_type alloc) noexcept {
+      return calldata_decoder::try_decode(transaction.data, options, alloc);
+    }
+
+  }  // namespace transaction_decoder
+}  // namespace evmtools
@@ -0,0 +1,14 @@
+#include <evmtools/hex.h>
+#include <evmtools/typed_decoder.h>
+
+namespace evmtools {
+  namespace typed_decoder {
+
+    std::string Address::to_hex() const {
+      std::string hex(this->bytes.size() * 2, '0');
+      hex::encode(this->bytes, hex);
+      return hex;
+    }
+
+  }  // namespace typed_decoder
+}  // namespace evmtools
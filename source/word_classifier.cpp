@@ -0,0 +1,169 @@
+#include <evmtools/word_classifier.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define EVMTOOLS_CLASSIFIER_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    define EVMTOOLS_CLASSIFIER_TARGET(isa)
+#  else
+#    define EVMTOOLS_CLASSIFIER_TARGET(isa) __attribute__((target(isa)))
+#  endif
+#endif
+
+namespace evmtools {
+  namespace word_classifier {
+    namespace {
+      using calldata_decoder::Types;
+      using calldata_decoder::WORD_SIZE;
+
+      /**
+       * Byte masks of a word, with bit `i` describing byte `i`: whether it is 0x00, 0xff, at
+       * least 0x10 (so it has no leading zero nibble) and at most 8.
+       */
+      struct Lanes {
+        uint32_t zero;
+        uint32_t ones;
+        uint32_t high;
+        uint32_t small;
+      };
+
+      constexpr uint32_t ALL{0xffffffff};
+
+      constexpr uint32_t bytes_below(const unsigned count) noexcept {
+        return count >= 32 ? ALL : (uint32_t{1} << count) - 1;
+      }
+
+      constexpr ParamTypes ANY_ZERO{Types::AnyZero};
+      constexpr ParamTypes MAX_UINT128{Types::MaxUint128};
+      constexpr ParamTypes ANY_MAX{Types::AnyMax};
+      constexpr ParamTypes SELECTOR{Types::Selector, Types::String, Types::Bytes};
+      constexpr ParamTypes MASKED_INT{Types::Int};
+      constexpr ParamTypes ADDRESS{Types::Address, Types::Bytes20, Types::Uint};
+      constexpr ParamTypes SMALL{Types::Uint8, Types::Bytes1};
+      constexpr ParamTypes NUMBER{Types::Uint, Types::Int, Types::Bytes};
+
+      /** Picks the types of a word from its byte masks, in the order of `get_param_type`. */
+      constexpr ParamTypes types_of(const Lanes lanes) noexcept {
+        // The whole word is 0, MAX_U128 or MAX_U256.
+        if (lanes.zero == ALL) return ANY_ZERO;
+        if ((lanes.zero & bytes_below(16)) == bytes_below(16) && (lanes.ones >> 16) == 0xffff) {
+          return MAX_UINT128;
+        }
+        if (lanes.ones == ALL) return ANY_MAX;
+
+        // 4 bytes other than 0x00000000 and 0xffffffff, followed by 4 zero bytes.
+        const auto prefix_zero{(lanes.zero & bytes_below(4)) == bytes_below(4)};
+        const auto prefix_ones{(lanes.ones & bytes_below(4)) == bytes_below(4)};
+        const auto following_zero{(lanes.zero >> 4 & bytes_below(4)) == bytes_below(4)};
+        if (!prefix_zero && !prefix_ones && following_zero) return SELECTOR;
+        if (prefix_ones) return MASKED_INT;
+
+        // Exactly 24 leading zero nibbles: 12 zero bytes, then a byte of at least 0x10.
+        if ((lanes.zero & bytes_below(12)) == bytes_below(12) && (lanes.high >> 12 & 1) != 0) {
+          return ADDRESS;
+        }
+
+        // A value of 0 is caught by the first check, so only 1 to 8 are left.
+        if ((lanes.zero & bytes_below(31)) == bytes_below(31) && (lanes.small >> 31) != 0) {
+          return SMALL;
+        }
+
+        return NUMBER;
+      }
+
+      void classify_scalar(std::span<const Word> words, ParamTypes* out) noexcept {
+        for (size_t i = 0; i < words.size(); i++) {
+          Lanes lanes{0, 0, 0, 0};
+          for (unsigned byte = 0; byte < WORD_SIZE; byte++) {
+            const auto value{words[i].bytes[byte]};
+            lanes.zero |= uint32_t{value == 0x00} << byte;
+            lanes.ones |= uint32_t{value == 0xff} << byte;
+            lanes.high |= uint32_t{value >= 0x10} << byte;
+            lanes.small |= uint32_t{value <= 8} << byte;
+          }
+          out[i] = types_of(lanes);
+        }
+      }
+
+#ifdef EVMTOOLS_CLASSIFIER_X86
+      /** Sets bit `i` for every byte `i` of 16 bytes that passes each test. */
+      EVMTOOLS_CLASSIFIER_TARGET("sse4.1")
+      inline Lanes lanes_sse4(__m128i bytes) noexcept {
+        const auto zero{_mm_cmpeq_epi8(bytes, _mm_setzero_si128())};
+        const auto ones{_mm_cmpeq_epi8(bytes, _mm_set1_epi8(-1))};
+        const auto high{_mm_cmpeq_epi8(_mm_max_epu8(bytes, _mm_set1_epi8(0x10)), bytes)};
+        const auto small{_mm_cmpeq_epi8(_mm_min_epu8(bytes, _mm_set1_epi8(8)), bytes)};
+
+        return Lanes{static_cast<uint32_t>(_mm_movemask_epi8(zero)),
+                     static_cast<uint32_t>(_mm_movemask_epi8(ones)),
+                     static_cast<uint32_t>(_mm_movemask_epi8(high)),
+                     static_cast<uint32_t>(_mm_movemask_epi8(small))};
+      }
+
+      EVMTOOLS_CLASSIFIER_TARGET("sse4.1")
+      void classify_sse4(std::span<const Word> words, ParamTypes* out) noexcept {
+        for (size_t i = 0; i < words.size(); i++) {
+          const auto* data{reinterpret_cast<const __m128i*>(words[i].bytes.data())};
+          const auto first{lanes_sse4(_mm_loadu_si128(data))};
+          const auto second{lanes_sse4(_mm_loadu_si128(data + 1))};
+
+          out[i] = types_of(Lanes{first.zero | second.zero << 16, first.ones | second.ones << 16,
+                                  first.high | second.high << 16,
+                                  first.small | second.small << 16});
+        }
+      }
+
+      EVMTOOLS_CLASSIFIER_TARGET("avx2")
+      void classify_avx2(std::span<const Word> words, ParamTypes* out) noexcept {
+        const auto zeroes{_mm256_setzero_si256()};
+        const auto ones{_mm256_set1_epi8(-1)};
+        const auto high{_mm256_set1_epi8(0x10)};
+        const auto small{_mm256_set1_epi8(8)};
+
+        // A whole word fits in one register.
+        for (size_t i = 0; i < words.size(); i++) {
+          const auto bytes{
+              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words[i].bytes.data()))};
+
+          out[i] = types_of(Lanes{
+              static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, zeroes))),
+              static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, ones))),
+              static_cast<uint32_t>(
+                  _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(bytes, high), bytes))),
+              static_cast<uint32_t>(
+                  _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(bytes, small), bytes)))});
+        }
+      }
+#endif
+    }  // namespace
+
+    void classify(std::span<const Word> words, std::span<ParamTypes> out) noexcept {
+      classify(words, out, hex::best_kernel());
+    }
+
+    void classify(std::span<const Word> words, std::span<ParamTypes> out,
+                  const Kernel kernel) noexcept {
+      // Never write past the output buffer.
+      words = words.first(std::min(words.size(), out.size()));
+
+      if (!hex::is_supported(kernel)) {
+        return classify_scalar(words, out.data());
+      }
+
+      switch (kernel) {
+#ifdef EVMTOOLS_CLASSIFIER_X86
+        case Kernel::Avx2:
+          return classify_avx2(words, out.data());
+        case Kernel::Sse4:
+          return classify_sse4(words, out.data());
+#endif
+        default:
+          return classify_scalar(words, out.data());
+      }
+    }
+
+  }  // namespace word_classifier
+}  // namespace evmtools
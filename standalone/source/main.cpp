@@ -0,0 +1,253 @@
+#include <evmtools/block_archive.h>
+#include <evmtools/decode_cache.h>
+#include <evmtools/decode_stats.h>
+#include <evmtools/mapped_file.h>
+#include <evmtools/signature_index.h>
+#include <evmtools/stream_decoder.h>
+#include <evmtools/version.h>
+
+#include <chrono>
+#include <cxxopts.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <optional>
+#include <string>
+
+namespace {
+  void print_stats(std::ostream& out, const evmtools::decode_stats::Snapshot& stats) {
+    using evmtools::decode_stats::Phase;
+
+    for (auto phase : {Phase::ParseSelector, Phase::ParseRawParams, Phase::ParseLen,
+                       Phase::GetParamTypes}) {
+      const auto& counters{stats[phase]};
+      out << evmtools::decode_stats::phase_name(phase) << ": " << counters.calls << " calls, "
+          << counters.bytes << " bytes, " << counters.allocations << " allocations, "
+          << counters.nanoseconds / 1e6 << " ms\n";
+    }
+
+    out << "nested calls: " << stats.nested_calls << "\ntypes:";
+    for (size_t i = 0; i < stats.types.size(); i++) {
+      out << ' ' << evmtools::calldata_decoder::type_name(
+          static_cast<evmtools::calldata_decoder::Types>(i))
+          << '=' << stats.types[i];
+    }
+    out << " untyped=" << stats.untyped << std::endl;
+  }
+
+  /** Makes a resource the default memory resource until it goes out of scope. */
+  class DefaultResource {
+  public:
+    explicit DefaultResource(std::pmr::memory_resource* resource) noexcept
+        : previous(std::pmr::set_default_resource(resource)) {}
+
+    DefaultResource(const DefaultResource&) = delete;
+    DefaultResource& operator=(const DefaultResource&) = delete;
+
+    ~DefaultResource() { std::pmr::set_default_resource(this->previous); }
+
+  private:
+    std::pmr::memory_resource* previous;
+  };
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  cxxopts::Options options(*argv, "Decodes calldata from a file of hex strings or JSON lines");
+
+  std::string input;
+  std::string output;
+  std::string signatures;
+  std::string build_index;
+  std::string format;
+  size_t threads{0};
+  size_t batch_size{4096};
+  size_t cache_size{0};
+  evmtools::calldata_decoder::DecodeOptions decode_options{};
+
+  // clang-format off
+  options.add_options()
+    ("h,help", "Show help")
+    ("v,version", "Print the current version number")
+    ("i,input", "File with one hex string or JSON object with an `input` field per line, or a "
+     "block archive with --blocks",
+     cxxopts::value(input))
+    ("o,output", "File to write results to, instead of stdout", cxxopts::value(output))
+    ("f,format", "Output format: text, json (one object per line) or columnar",
+     cxxopts::value(format)->default_value("text"))
+    ("t,threads", "Number of decoder threads, 0 for one per hardware thread",
+     cxxopts::value(threads)->default_value("0"))
+    ("b,batch", "Number of inputs per pipeline batch",
+     cxxopts::value(batch_size)->default_value("4096"))
+    ("s,signatures", "Signature index used to name selectors", cxxopts::value(signatures))
+    ("c,cache", "Number of decoded inputs to cache for repeated calldata, 0 to disable",
+     cxxopts::value(cache_size)->default_value("0"))
+    ("stats", "Print per-phase decode stats (needs a build with EVMTOOLS_ENABLE_STATS)")
+    ("max-depth", "Deepest nesting of calls to decode",
+     cxxopts::value(decode_options.max_depth)->default_value("64"))
+    ("max-steps", "Most units of work per input, about one per word; inputs over it are errors",
+     cxxopts::value(decode_options.max_steps))
+    ("max-memory", "Most bytes of decoded data per input; inputs over it are errors",
+     cxxopts::value(decode_options.max_memory))
+    ("steps-per-byte", "Units of work allowed per byte of input, if fewer than --max-steps",
+     cxxopts::value(decode_options.steps_per_byte)->default_value("8"))
+    ("memory-per-byte", "Bytes of decoded data allowed per byte of input, if fewer than "
+     "--max-memory", cxxopts::value(decode_options.memory_per_byte)->default_value("128"))
+    ("blocks", "Read the input as an archive of RLP blocks (a file, or a directory of files) and "
+     "decode the calldata of their transactions")
+    ("length-prefixed", "With --blocks, each block is preceded by its 4-byte little-endian size")
+    ("build-index", "Build a signature index from a file with one signature per line, "
+     "writing it to --output", cxxopts::value(build_index))
+  ;
+  // clang-format on
+
+  options.parse_positional({"input"});
+  options.positional_help("<input>");
+
+  auto result = options.parse(argc, argv);
+
+  if (result["help"].as<bool>()) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  if (result["version"].as<bool>()) {
+    std::cout << "EvmTools, version " << EVMTOOLS_VERSION << std::endl;
+    return 0;
+  }
+
+  if (!build_index.empty()) {
+    if (output.empty()) {
+      std::cerr << "--build-index needs --output" << std::endl;
+      return 1;
+    }
+
+    try {
+      evmtools::mapped_file::MappedFile list{build_index};
+      auto image{evmtools::signature_index::build_signature_index(list.text())};
+
+      std::ofstream output_file{output, std::ios::binary};
+      output_file.write(reinterpret_cast<const char*>(image.data()),
+                        static_cast<std::streamsize>(image.size()));
+      if (!output_file) {
+        std::cerr << "failed to write " << output << std::endl;
+        return 1;
+      }
+    } catch (const std::exception& error) {
+      std::cerr << error.what() << std::endl;
+      return 1;
+    }
+
+    return 0;
+  }
+
+  if (input.empty()) {
+    std::cerr << options.help() << std::endl;
+    return 1;
+  }
+
+  const bool stats_enabled{result["stats"].as<bool>()};
+
+  // Blocks are decoded one per task, without the line pipeline's batches or cache.
+  const bool blocks{result["blocks"].as<bool>()};
+  if (blocks && (result.count("cache") != 0 || result.count("batch") != 0)) {
+    std::cerr << "--cache and --batch can't be used with --blocks" << std::endl;
+    return 1;
+  }
+
+  auto output_format{evmtools::stream_decoder::OutputFormat::Text};
+  if (format == "columnar") {
+    output_format = evmtools::stream_decoder::OutputFormat::Columnar;
+  } else if (format == "json") {
+    output_format = evmtools::stream_decoder::OutputFormat::Json;
+  } else if (format != "text") {
+    std::cerr << "unknown format " << format << std::endl;
+    return 1;
+  }
+
+  try {
+    std::optional<evmtools::signature_index::SignatureIndex> index;
+    if (!signatures.empty()) {
+      index.emplace(std::filesystem::path{signatures});
+    }
+
+    std::ofstream output_file;
+    if (!output.empty()) {
+      output_file.open(output, std::ios::binary);
+      if (!output_file) {
+        std::cerr << "failed to open " << output << std::endl;
+        return 1;
+      }
+    }
+    std::ostream& out{output.empty() ? std::cout : output_file};
+
+    // Route decode allocations through a counting resource, so the stats can attribute them.
+    // The previous default is restored on every way out, before `counting` is destroyed.
+    evmtools::decode_stats::CountingResource counting{};
+    std::optional<DefaultResource> default_resource;
+    if (stats_enabled) {
+      if constexpr (!evmtools::decode_stats::ENABLED) {
+        std::cerr << "--stats needs a build with EVMTOOLS_ENABLE_STATS" << std::endl;
+        return 1;
+      }
+      default_resource.emplace(&counting);
+    }
+
+    std::optional<evmtools::decode_cache::DecodeCache> cache;
+    if (cache_size != 0) {
+      cache.emplace(cache_size, 0, decode_options);
+    }
+
+    if (blocks) {
+      evmtools::block_archive::BlockArchive archive{
+          input, result["length-prefixed"].as<bool>()
+                     ? evmtools::block_archive::ArchiveFormat::LengthPrefixed
+                     : evmtools::block_archive::ArchiveFormat::Rlp};
+
+      evmtools::block_archive::ArchiveOptions archive_options{threads};
+      archive_options.signatures = index ? &*index : nullptr;
+      archive_options.format = output_format;
+      archive_options.decode = decode_options;
+
+      auto start{std::chrono::steady_clock::now()};
+      auto stats{evmtools::block_archive::decode_archive(archive, out, archive_options)};
+      std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+      std::cerr << "decoded " << stats.decoded << "/" << stats.transactions
+                << " transactions in " << stats.blocks << " blocks (" << stats.skipped
+                << " without calldata, " << stats.malformed_blocks << " malformed blocks, "
+                << stats.bytes / elapsed.count() / 1e6 << " MB/s)" << std::endl;
+    } else {
+      evmtools::mapped_file::MappedFile file{input};
+      file.advise_sequential();
+
+      evmtools::stream_decoder::StreamOptions stream_options{threads, batch_size};
+      stream_options.signatures = index ? &*index : nullptr;
+      stream_options.cache = cache ? &*cache : nullptr;
+      stream_options.format = output_format;
+      stream_options.decode = decode_options;
+
+      auto start{std::chrono::steady_clock::now()};
+      auto stats{evmtools::stream_decoder::decode_stream(file.text(), out, stream_options)};
+      std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+      std::cerr << "decoded " << stats.decoded << "/" << stats.inputs << " inputs ("
+                << stats.bytes / elapsed.count() / 1e6 << " MB/s)" << std::endl;
+
+      if (cache) {
+        auto cache_stats{cache->stats()};
+        std::cerr << "cache: " << cache_stats.hits << " hits, " << cache_stats.misses
+                  << " misses, " << cache_stats.evictions << " evictions" << std::endl;
+      }
+    }
+
+    if (stats_enabled) {
+      print_stats(std::cerr, evmtools::decode_stats::snapshot());
+    }
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,216 @@
+#include <doctest/doctest.h>
+#include <evmtools/abi_decoder.h>
+#include <evmtools/signature_index.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_SUITE("abi_decoder") {
+  using namespace evmtools::abi_decoder;
+  using evmtools::calldata_decoder::bytes_from_hex;
+  using evmtools::calldata_decoder::Calldata;
+  using evmtools::signature_index::selector_from_signature;
+
+  const std::string ERC20_ABI{R"([
+    {"type": "event", "name": "Transfer", "inputs": []},
+    {"type": "function", "name": "transfer", "stateMutability": "nonpayable",
+     "inputs": [{"name": "to", "type": "address"}, {"name": "amount", "type": "uint256"}],
+     "outputs": [{"name": "", "type": "bool"}]},
+    {"name": "name", "inputs": [], "outputs": [{"type": "string"}], "constant": true}
+  ])"};
+
+  const std::string TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af00000000000000000"
+      "000000000000000000000000000000005f7aab8c56b0000"};
+
+  /** Appends a word holding a small integer. */
+  void append_word(std::vector<uint8_t>& out, size_t value) {
+    std::vector<uint8_t> word(32, 0);
+    for (size_t i = 0; i < 8; i++) word[31 - i] = static_cast<uint8_t>(value >> (8 * i));
+    out.insert(out.end(), word.begin(), word.end());
+  }
+
+  TEST_CASE("compile functions into decode plans") {
+    AbiDecoder decoder{};
+    CHECK(decoder.load_json(ERC20_ABI) == 2);
+    CHECK(decoder.load_json(ERC20_ABI) == 0);
+    CHECK(decoder.size() == 2);
+
+    const auto* transfer{decoder.find(Selector{0xa9059cbb})};
+    REQUIRE(transfer != nullptr);
+    CHECK(transfer->signature == "transfer(address,uint256)");
+    REQUIRE(transfer->plan.size() == 3);
+    CHECK(transfer->plan[0].op == Op::Tuple);
+    CHECK(transfer->plan[0].count == 2);
+    CHECK(transfer->plan[0].head == 64);
+    CHECK(transfer->plan[1].op == Op::Address);
+    CHECK(transfer->names[2] == "amount");
+
+    REQUIRE(decoder.find(Selector{0x06fdde03}) != nullptr);
+    CHECK(decoder.find(Selector{0x06fdde03})->signature == "name()");
+    CHECK(decoder.find(Selector{0x095ea7b3}) == nullptr);
+  }
+
+  TEST_CASE("canonicalise tuples and arrays") {
+    AbiDecoder decoder{};
+    decoder.load_json(R"({"abi": [{"type": "function", "name": "f", "inputs": [
+      {"name": "orders", "type": "tuple[]", "components": [
+        {"name": "maker", "type": "address"},
+        {"name": "amounts", "type": "uint[2]"},
+        {"name": "data", "type": "bytes"}]},
+      {"name": "flags", "type": "bool[3][]"}
+    ]}]})");
+
+    REQUIRE(decoder.size() == 1);
+    const auto* function{
+        decoder.find(selector_from_signature("f((address,uint256[2],bytes)[],bool[3][])"))};
+    REQUIRE(function != nullptr);
+    CHECK(function->signature == "f((address,uint256[2],bytes)[],bool[3][])");
+
+    // f, tuple[], tuple, address, uint[2], uint, bytes, bool[3][], bool[3], bool
+    REQUIRE(function->plan.size() == 10);
+    CHECK(function->plan[1].op == Op::Array);
+    CHECK(function->plan[2].op == Op::Tuple);
+    CHECK(function->plan[2].dynamic);
+    CHECK(function->plan[2].end == 7);
+    CHECK(function->plan[4].op == Op::FixedArray);
+    CHECK(function->plan[4].head == 64);
+    CHECK(function->plan[8].op == Op::FixedArray);
+    CHECK_FALSE(function->plan[8].dynamic);
+    CHECK(function->plan[8].head == 96);
+    CHECK(function->depth == 4);
+  }
+
+  TEST_CASE("reject invalid ABIs") {
+    AbiDecoder decoder{};
+    CHECK_THROWS_AS(decoder.load_json(""), std::invalid_argument);
+    CHECK_THROWS_AS(decoder.load_json("[{\"name\": \"f\",]"), std::invalid_argument);
+    CHECK_THROWS_AS(decoder.load_json("{\"name\": \"f\"}"), std::invalid_argument);
+    CHECK_THROWS_AS(
+        decoder.load_json(R"([{"name": "f", "inputs": [{"type": "uint7"}]}])"),
+        std::invalid_argument);
+    CHECK_THROWS_AS(
+        decoder.load_json(R"([{"name": "f", "inputs": [{"type": "tuple", "components": []}]}])"),
+        std::invalid_argument);
+    CHECK_THROWS_AS(decoder.load_json(R"([{"name": "f", "inputs": [{"type": "uint256[0]"}]}])"),
+                    std::invalid_argument);
+
+    // A bad entry leaves the decoder unchanged.
+    CHECK_THROWS_AS(
+        decoder.load_json(R"([{"name": "g", "inputs": []}, {"name": "f", "inputs": [{}]}])"),
+        std::invalid_argument);
+    CHECK(decoder.size() == 0);
+
+    std::string deep{"["};
+    for (size_t i = 0; i < 1000; i++) deep += "[";
+    CHECK_THROWS_AS(decoder.load_json(deep), std::invalid_argument);
+  }
+
+  TEST_CASE("decode a transfer exactly") {
+    AbiDecoder decoder{};
+    decoder.load_json(ERC20_ABI);
+
+    auto bytes{bytes_from_hex(TRANSFER)};
+    auto decoded{decoder.decode(bytes)};
+
+    REQUIRE(decoded.has_value());
+    CHECK(decoded->function->name == "transfer");
+    REQUIRE(decoded->values.size() == 3);
+    CHECK(decoded->values[0].op == Op::Tuple);
+    CHECK(decoded->values[0].count == 2);
+    CHECK(decoded->values[1].name == "to");
+    CHECK(decoded->values[1].parent == 0);
+    CHECK(decoded->values[1].data.data() == bytes.data() + 4);
+    CHECK(decoded->values[2].name == "amount");
+    CHECK(decoded->values[2].data[31] == 0x00);
+    CHECK(decoded->values[2].data[30] == 0x00);
+    CHECK(decoded->values[2].data[29] == 0x6b);
+
+    // The same bytes as decoded heuristically.
+    Calldata calldata{std::span<const uint8_t>{bytes}};
+    CHECK(decoder.decode(calldata).has_value());
+
+    // Dirty address padding, and unknown selectors
+    bytes[4] = 0x01;
+    CHECK_FALSE(decoder.decode(bytes).has_value());
+    bytes[0] = 0x00;
+    CHECK_FALSE(decoder.decode(bytes).has_value());
+    CHECK_FALSE(decoder.decode(std::span{bytes}.first(3)).has_value());
+  }
+
+  TEST_CASE("decode dynamic arrays of tuples") {
+    AbiDecoder decoder{};
+    decoder.load_json(R"([{"name": "f", "inputs": [
+      {"name": "pairs", "type": "tuple[]", "components": [
+        {"name": "id", "type": "uint8"}, {"name": "tag", "type": "string"}]},
+      {"name": "flag", "type": "bool"}
+    ]}])");
+
+    // f([(1, "ab"), (2, "")], true)
+    auto bytes{bytes_from_hex(
+        selector_from_signature("f((uint8,string)[],bool)").to_hex())};
+    for (size_t word : {64, 1, 2, 64, 192, 1, 64, 2}) append_word(bytes, word);
+    bytes.insert(bytes.end(), {'a', 'b'});
+    bytes.resize(bytes.size() + 30, 0);
+    for (size_t word : {2, 64, 0}) append_word(bytes, word);
+
+    auto decoded{decoder.decode(bytes)};
+    REQUIRE(decoded.has_value());
+
+    const auto& values{decoded->values};
+    REQUIRE(values.size() == 9);
+    CHECK(values[1].name == "pairs");
+    CHECK(values[1].op == Op::Array);
+    CHECK(values[1].count == 2);
+    CHECK(values[2].op == Op::Tuple);
+    CHECK(values[2].name.empty());
+    CHECK(values[2].parent == 1);
+    CHECK(values[3].name == "id");
+    CHECK(values[3].data[31] == 1);
+    CHECK(values[4].name == "tag");
+    CHECK(std::string_view{reinterpret_cast<const char*>(values[4].data.data()),
+                           values[4].data.size()}
+          == "ab");
+    CHECK(values[5].parent == 1);
+    CHECK(values[6].data[31] == 2);
+    CHECK(values[7].data.empty());
+    CHECK(values[8].name == "flag");
+    CHECK(values[8].parent == 0);
+
+    // An element offset past the end, and a string longer than the calldata
+    auto broken{bytes};
+    broken[4 + 4 * 32 + 31] = 0xff;
+    CHECK_FALSE(decoder.decode(broken).has_value());
+    broken = bytes;
+    broken[4 + 7 * 32 + 31] = 0xff;
+    CHECK_FALSE(decoder.decode(broken).has_value());
+
+    // An id that doesn't fit in a uint8
+    broken = bytes;
+    broken[4 + 5 * 32 + 30] = 0x01;
+    CHECK_FALSE(decoder.decode(broken).has_value());
+  }
+
+  TEST_CASE("stop heads that all point to the same tail") {
+    AbiDecoder decoder{};
+    decoder.load_json(R"([{"name": "g", "inputs": [{"name": "grid", "type": "uint256[][]"}]}])");
+
+    // 64 outer elements that all refer to the same array of 64 words.
+    constexpr size_t size{64};
+    auto bytes{bytes_from_hex(selector_from_signature("g(uint256[][])").to_hex())};
+    append_word(bytes, 32);
+    append_word(bytes, size);
+    for (size_t i = 0; i < size; i++) append_word(bytes, size * 32);
+    append_word(bytes, size);
+    for (size_t i = 0; i < size; i++) append_word(bytes, i);
+
+    CHECK_FALSE(decoder.decode(bytes).has_value());
+
+    // A single outer element is fine.
+    bytes[4 + 63] = 1;
+    auto decoded{decoder.decode(bytes)};
+    REQUIRE(decoded.has_value());
+    CHECK(decoded->values.size() == 3 + size);
+  }
+}
@@ -0,0 +1,136 @@
+#include <doctest/doctest.h>
+#include <evmtools/async_decoder.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("async_decoder") {
+  using namespace evmtools::async_decoder;
+  using evmtools::calldata_decoder::DecodeStatus;
+  using evmtools::calldata_decoder::Selector;
+
+  std::vector<uint8_t> transfer() {
+    return evmtools::calldata_decoder::bytes_from_hex(
+        "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+        "0000000000000000000000000000000005f7aab8c56b0000");
+  }
+
+  /** A coroutine that starts right away and isn't awaited. */
+  struct Detached {
+    struct promise_type {
+      Detached get_return_object() noexcept { return {}; }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() noexcept {}
+      void unhandled_exception() noexcept { std::terminate(); }
+    };
+  };
+
+  Detached decode_in_coroutine(AsyncDecoder& decoder, std::promise<size_t>& done) {
+    auto first{co_await decoder.decode(transfer())};
+    // Shorter than a selector.
+    auto second{co_await decoder.decode(std::vector<uint8_t>(1, 0xa9))};
+    done.set_value(first.result.calldata->params.size()
+                   + (second.result.status == DecodeStatus::Malformed ? 10 : 0));
+  }
+
+  TEST_CASE("results come back through callbacks, futures and coroutines") {
+    AsyncDecoder decoder{AsyncOptions{2, 16}};
+
+    auto future{decoder.submit(transfer())};
+    auto decoded{future.get()};
+    REQUIRE(decoded.result);
+    CHECK(decoded.result.calldata->selector == Selector{0xa9059cbb});
+    // The calldata refers into the input, which came back with it.
+    CHECK(decoded.result.calldata->calldata.data() == decoded.input.data());
+
+    std::atomic<size_t> called{0};
+    std::promise<void> all_called;
+    for (size_t i = 0; i < 100; i++) {
+      decoder.submit(transfer(), [&](Decoded&& result) {
+        CHECK(result.result.calldata->params.size() == 2);
+        if (++called == 100) all_called.set_value();
+      });
+    }
+    all_called.get_future().wait();
+
+    std::promise<size_t> done;
+    decode_in_coroutine(decoder, done);
+    CHECK(done.get_future().get() == 12);
+  }
+
+  TEST_CASE("tagged results are polled in batches") {
+    AsyncDecoder decoder{AsyncOptions{3, 8, 1000}};
+
+    for (uint64_t tag = 0; tag < 200; tag++) {
+      decoder.submit_tagged(tag % 4 == 0 ? std::vector<uint8_t>{0x00} : transfer(), tag);
+    }
+
+    std::vector<Completion> completions;
+    while (completions.size() < 200) {
+      if (decoder.poll(completions, 32) == 0) std::this_thread::yield();
+    }
+    CHECK(decoder.poll(completions) == 0);
+
+    std::vector<int> seen(200);
+    for (const auto& completion : completions) {
+      seen[completion.tag]++;
+      CHECK(completion.decoded.result.status
+            == (completion.tag % 4 == 0 ? DecodeStatus::Malformed : DecodeStatus::Ok));
+    }
+    CHECK(std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; }));
+  }
+
+  TEST_CASE("full queues push back on submitters") {
+    std::promise<void> release;
+    auto released{release.get_future().share()};
+    std::atomic<size_t> finished{0};
+
+    {
+      AsyncDecoder decoder{AsyncOptions{1, 2}};
+
+      // Keep the only decoder thread busy, then fill the queue.
+      std::promise<void> started;
+      decoder.submit(transfer(), [&](Decoded&&) {
+        started.set_value();
+        released.wait();
+        finished++;
+      });
+      started.get_future().wait();
+      CHECK(decoder.try_submit_tagged(transfer(), 1));
+      CHECK(decoder.try_submit_tagged(transfer(), 2));
+      CHECK(decoder.pending() == 3);
+
+      auto input{transfer()};
+      Callback callback{[&](Decoded&&) { finished++; }};
+      CHECK_FALSE(decoder.try_submit(std::move(input), std::move(callback)));
+      // Refused submissions are left with the caller.
+      CHECK(input == transfer());
+      CHECK(static_cast<bool>(callback));
+
+      release.set_value();
+      decoder.submit(std::move(input), std::move(callback));
+      // Destruction waits for every submitted input.
+    }
+
+    CHECK(finished.load() == 2);
+
+    // Decoder threads wait for results to be polled once the completion queue is full.
+    AsyncDecoder decoder{AsyncOptions{2, 4, 1}};
+    std::vector<Completion> completions;
+    uint64_t next{0};
+    while (completions.size() < 16) {
+      if (next < 16 && decoder.try_submit_tagged(transfer(), next)) next++;
+      decoder.poll(completions);
+    }
+    uint64_t tags{0};
+    for (const auto& completion : completions) tags += completion.tag;
+    CHECK(tags == 15 * 16 / 2);
+  }
+}
@@ -0,0 +1,31 @@
+#include <doctest/doctest.h>
+#include <evmtools/batch_decoder.h>
+
+#include <string>
+#include <vector>
+
+TEST_SUITE("batch_decoder") {
+  using namespace evmtools::calldata_decoder;
+
+  TEST_CASE("decode batch keeps input order") {
+    std::vector<std::string> inputs;
+    for (uint32_t i = 0; i < 1'000; i++) {
+      // transfer(address,uint256) with a different selector per input.
+      inputs.push_back("0x" + Selector{0xa9050000 + i}.to_hex()
+                       + "0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af"
+                       + "00000000000000000000000000000000000000000000000005f7aab8c56b0000");
+    }
+    inputs.push_back("0xzz");
+
+    evmtools::thread_pool::ThreadPool pool{4};
+    auto results{decode_batch(inputs, pool, 16)};
+
+    REQUIRE(results.size() == inputs.size());
+    for (uint32_t i = 0; i < 1'000; i++) {
+      REQUIRE(results[i].has_value());
+      CHECK(results[i]->selector == Selector{0xa9050000 + i});
+      CHECK(results[i]->params.size() == 2);
+    }
+    CHECK_FALSE(results.back().has_value());
+  }
+}
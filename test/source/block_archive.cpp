@@ -0,0 +1,187 @@
+#include <doctest/doctest.h>
+#include <evmtools/block_archive.h>
+#include <evmtools/columnar.h>
+#include <evmtools/transaction_decoder.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rlp.h"
+
+#ifdef _WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+TEST_SUITE("block_archive") {
+  using namespace evmtools::block_archive;
+  using evmtools::calldata_decoder::bytes_from_hex;
+  using evmtools::stream_decoder::OutputFormat;
+  using Bytes = std::vector<uint8_t>;
+
+  constexpr std::string_view TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+      "0000000000000000000000000000000005f7aab8c56b0000"};
+
+  /** An unsigned legacy transaction to `to` with calldata `data`. */
+  Bytes transaction(const Bytes& to, const Bytes& data) {
+    return rlp_list({rlp_uint(0), rlp_uint(1), rlp_uint(90000), rlp_string(to), rlp_uint(0),
+                     rlp_string(data)});
+  }
+
+  /** A block numbered `number`, with a header holding nothing else of note. */
+  Bytes block(uint64_t number, const std::vector<Bytes>& transactions) {
+    std::vector<Bytes> header(8, rlp_string(Bytes(32, 0)));
+    header.push_back(rlp_uint(number));
+    header.push_back(rlp_uint(30000000));
+    return rlp_list({rlp_list(header), rlp_list(transactions), rlp_list({})});
+  }
+
+  void write_file(const std::filesystem::path& path, const std::vector<Bytes>& blocks,
+                  ArchiveFormat format = ArchiveFormat::Rlp) {
+    std::ofstream file{path, std::ios::binary};
+    for (const auto& encoded : blocks) {
+      if (format == ArchiveFormat::LengthPrefixed) {
+        const auto size{static_cast<uint32_t>(encoded.size())};
+        for (int shift = 0; shift < 32; shift += 8) file.put(static_cast<char>(size >> shift));
+      }
+      file.write(reinterpret_cast<const char*>(encoded.data()),
+                 static_cast<std::streamsize>(encoded.size()));
+    }
+  }
+
+  /** A fresh, empty directory for an archive, named after this process so runs can overlap. */
+  std::filesystem::path archive_directory(std::string_view name) {
+#ifdef _WIN32
+    const auto pid{_getpid()};
+#else
+    const auto pid{getpid()};
+#endif
+    auto path{std::filesystem::temp_directory_path()
+              / (std::string{name} + '_' + std::to_string(pid))};
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directory(path);
+    return path;
+  }
+
+  const Bytes RECIPIENT(20, 0x35);
+
+  TEST_CASE("read blocks from every file in name order") {
+    auto directory{archive_directory("evmtools_block_archive_test")};
+    write_file(directory / "b.rlp", {block(3, {}), block(4, {})}, ArchiveFormat::LengthPrefixed);
+    write_file(directory / "a.rlp", {block(1, {}), block(2, {})}, ArchiveFormat::LengthPrefixed);
+    write_file(directory / "c.rlp", {}, ArchiveFormat::LengthPrefixed);
+
+    BlockArchive archive{directory, ArchiveFormat::LengthPrefixed};
+    CHECK(archive.file_count() == 3);
+
+    for (int pass = 0; pass < 2; pass++) {
+      for (uint64_t number = 1; number <= 4; number++) {
+        auto encoded{archive.next()};
+        REQUIRE(encoded.has_value());
+        CHECK(evmtools::transaction_decoder::decode_block(*encoded).number == number);
+      }
+      CHECK_FALSE(archive.next().has_value());
+      archive.rewind();
+    }
+
+    // Files must split into whole blocks.
+    auto truncated{block(5, {})};
+    truncated.pop_back();
+    write_file(directory / "d.rlp", {truncated});
+    BlockArchive rlp_archive{directory / "d.rlp"};
+    CHECK_THROWS_AS((void)rlp_archive.next(), std::invalid_argument);
+
+    std::filesystem::remove_all(directory);
+  }
+
+  TEST_CASE("decode an archive in block order") {
+    auto data{bytes_from_hex(TRANSFER)};
+    auto directory{archive_directory("evmtools_block_archive_order_test")};
+
+    // Blocks of very different sizes, so they finish out of order.
+    std::vector<Bytes> blocks;
+    size_t calls{0};
+    for (uint64_t number = 0; number < 200; number++) {
+      std::vector<Bytes> transactions(number % 7 == 0 ? 50 : number % 3,
+                                      transaction(RECIPIENT, data));
+      calls += transactions.size();
+      blocks.push_back(block(number, transactions));
+    }
+    // A creation, a plain transfer and a malformed transaction.
+    blocks.push_back(
+        block(200, {transaction({}, data), transaction(RECIPIENT, {}), rlp_string(Bytes(3, 1))}));
+    // A malformed block.
+    blocks.push_back(rlp_list({rlp_string({1})}));
+    write_file(directory / "blocks.rlp", blocks);
+
+    BlockArchive archive{directory};
+    ArchiveOptions options{};
+    options.threads = 4;
+    options.window = 3;
+
+    std::ostringstream out;
+    auto stats{decode_archive(archive, out, options)};
+    CHECK(stats.blocks == 202);
+    CHECK(stats.malformed_blocks == 1);
+    CHECK(stats.transactions == calls + 3);
+    CHECK(stats.decoded == calls);
+    CHECK(stats.skipped == 2);
+    CHECK(stats.bytes == archive.size());
+
+    std::istringstream lines{out.str()};
+    std::string line;
+    for (uint64_t number = 0; number < 200; number++) {
+      for (size_t i = 0; i < (number % 7 == 0 ? 50 : number % 3); i++) {
+        REQUIRE(std::getline(lines, line));
+        auto label{std::to_string(number) + ":" + std::to_string(i)};
+        CHECK(line.starts_with(label + "\ta9059cbb\t"));
+      }
+    }
+    REQUIRE(std::getline(lines, line));
+    CHECK(line == "200:2\terror");
+    CHECK_FALSE(std::getline(lines, line));
+
+    std::filesystem::remove_all(directory);
+  }
+
+  TEST_CASE("write an archive as NDJSON or columns") {
+    auto data{bytes_from_hex(TRANSFER)};
+    auto directory{archive_directory("evmtools_block_archive_format_test")};
+    write_file(directory / "blocks.rlp",
+               {block(17000000, {transaction({}, data), transaction(RECIPIENT, data)}),
+                block(17000001, {transaction(RECIPIENT, data)})});
+
+    BlockArchive archive{directory};
+    ArchiveOptions options{};
+    options.threads = 2;
+    options.format = OutputFormat::Json;
+
+    std::ostringstream json;
+    CHECK(decode_archive(archive, json, options).decoded == 2);
+    std::istringstream lines{json.str()};
+    std::string line;
+    REQUIRE(std::getline(lines, line));
+    CHECK(line.starts_with(R"({"block":17000000,"index":1,"selector":"0xa9059cbb",)"));
+    REQUIRE(std::getline(lines, line));
+    CHECK(line.starts_with(R"({"block":17000001,"index":0,"selector":"0xa9059cbb",)"));
+    CHECK_FALSE(std::getline(lines, line));
+
+    archive.rewind();
+    options.format = OutputFormat::Columnar;
+    std::ostringstream columns{std::ios::binary};
+    CHECK(decode_archive(archive, columns, options).decoded == 2);
+
+    auto image{columns.str()};
+    evmtools::columnar::ColumnReader reader{Bytes(image.begin(), image.end())};
+    CHECK(reader.inputs() == 2);
+    CHECK(reader.calls() == 2);
+
+    std::filesystem::remove_all(directory);
+  }
+}
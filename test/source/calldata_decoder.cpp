@@ -2,7 +2,12 @@
 #include <evmtools/calldata_decoder.h>
 #include <evmtools/version.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <memory_resource>
+#include <optional>
+#include <sstream>
 #include <string>
 
 TEST_CASE("EvmTools version") {
@@ -13,24 +18,25 @@ TEST_CASE("EvmTools version") {
 TEST_SUITE("calldata_decoder") {
   using namespace evmtools::calldata_decoder;
 
-  TEST_CASE("parse multicall two-step function calldata") {
-    std::string calldata_str{
-        "0xac9650d800000000000000000000000000000000000000000000000000000000000000200000000000000000"
-        "000000000000000000000000000000000000000000000002000000000000000000000000000000000000000000"
-        "000000000000000000004000000000000000000000000000000000000000000000000000000000000001e00000"
-        "000000000000000000000000000000000000000000000000000000000164883164560000000000000000000000"
-        "00c011a73ee8576fb46f5e1c5751ca3b9fe0af2a6f000000000000000000000000c02aaa39b223fe8d0a0e5c4f"
-        "27ead9083c756cc20000000000000000000000000000000000000000000000000000000000002710ffffffffff"
-        "fffffffffffffffffffffffffffffffffffffffffffffffffee530ffffffffffffffffffffffffffffffffffff"
-        "ffffffffffffffffffffffff1b18000000000000000000000000000000000000000000000000016345785d89fd"
-        "6800000000000000000000000000000000000000000000000000007f73eca3063a000000000000000000000000"
-        "000000000000000000000000016042b530ddaec600000000000000000000000000000000000000000000000000"
-        "007e59f044bada000000000000000000000000f847e9d51989033b691b8be943f8e9e268f99b9e000000000000"
-        "000000000000000000000000000000000000000000006377347700000000000000000000000000000000000000"
-        "000000000000000000000000000000000000000000000000000000000000000000000000000000000412210e8a"
-        "00000000000000000000000000000000000000000000000000000000"};
+  // multicall(bytes[]) with two nested calls.
+  constexpr std::string_view MULTICALL_CALLDATA{
+      "0xac9650d800000000000000000000000000000000000000000000000000000000000000200000000000000000"
+      "000000000000000000000000000000000000000000000002000000000000000000000000000000000000000000"
+      "000000000000000000004000000000000000000000000000000000000000000000000000000000000001e00000"
+      "000000000000000000000000000000000000000000000000000000000164883164560000000000000000000000"
+      "00c011a73ee8576fb46f5e1c5751ca3b9fe0af2a6f000000000000000000000000c02aaa39b223fe8d0a0e5c4f"
+      "27ead9083c756cc20000000000000000000000000000000000000000000000000000000000002710ffffffffff"
+      "fffffffffffffffffffffffffffffffffffffffffffffffffee530ffffffffffffffffffffffffffffffffffff"
+      "ffffffffffffffffffffffff1b18000000000000000000000000000000000000000000000000016345785d89fd"
+      "6800000000000000000000000000000000000000000000000000007f73eca3063a000000000000000000000000"
+      "000000000000000000000000016042b530ddaec600000000000000000000000000000000000000000000000000"
+      "007e59f044bada000000000000000000000000f847e9d51989033b691b8be943f8e9e268f99b9e000000000000"
+      "000000000000000000000000000000000000000000006377347700000000000000000000000000000000000000"
+      "000000000000000000000000000000000000000000000000000000000000000000000000000000000412210e8a"
+      "00000000000000000000000000000000000000000000000000000000"};
 
-    Calldata calldata{calldata_str};
+  TEST_CASE("parse multicall two-step function calldata") {
+    Calldata calldata{MULTICALL_CALLDATA};
 
     std::cout << "Number of parsed nested params: " << calldata.nested_details.size() << std::endl;
 
@@ -51,9 +57,353 @@ TEST_SUITE("calldata_decoder") {
     for (size_t i = 0; i < calldata.params.size(); i++) {
       std::cout << "param: " << calldata.params.at(i) << std::endl;
 
-      for (auto param_type : calldata.main_details.param_types.at(i).types) {
+      for (auto param_type : calldata.main_details.param_types.at(i)) {
         std::cout << "param type: " << param_type << std::endl;
       }
     }
   }
+
+  TEST_CASE("word and selector round trip through hex") {
+    constexpr std::string_view hex{
+        "0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af"};
+
+    auto word{Word::from_hex(hex)};
+    CHECK(word.to_hex() == hex);
+    CHECK(word.leading_zero_nibbles() == 24);
+    CHECK(word.to_uint() > intx::uint256{0});
+    CHECK(constants::EMPTY_32_WORD.is_zero());
+    CHECK(constants::MAX_U256_WORD.leading_zero_nibbles() == 0);
+
+    auto bytes{bytes_from_hex("0xa9059cbb")};
+    CHECK(Selector::from_bytes(bytes.data()) == Selector{0xa9059cbb});
+    CHECK(Selector{0xa9059cbb}.to_hex() == "a9059cbb");
+    CHECK_THROWS_AS(bytes_from_hex("0xabc"), std::invalid_argument);
+  }
+
+  TEST_CASE("get param type of words") {
+    auto types_of{[](std::string_view hex) { return get_param_type(Word::from_hex(hex)); }};
+
+    CHECK(types_of(constants::EMPTY_32) == ParamTypes{Types::AnyZero});
+    CHECK(types_of(constants::MAX_U256) == ParamTypes{Types::AnyMax});
+    CHECK(types_of(constants::MAX_U128) == ParamTypes{Types::MaxUint128});
+    CHECK(types_of("a9059cbb00000000000000000000000000000000000000000000000000000000")
+          == ParamTypes{Types::Selector, Types::String, Types::Bytes});
+    CHECK(types_of("fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffee530")
+          == ParamTypes{Types::Int});
+    CHECK(types_of("0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af")
+          == ParamTypes{Types::Address, Types::Bytes20, Types::Uint});
+    CHECK(types_of("0000000000000000000000000000000000000000000000000000000000000007")
+          == ParamTypes{Types::Uint8, Types::Bytes1});
+  }
+
+  TEST_CASE("param types are a bitmask") {
+    static_assert(sizeof(ParamTypes) == sizeof(uint16_t));
+
+    constexpr ParamTypes types{Types::Address, Types::Uint, Types::Bytes20};
+    static_assert(types.size() == 3);
+    static_assert(types.contains(Types::Bytes20) && !types.contains(Types::Int));
+
+    // Iteration follows the declaration order of Types.
+    std::vector<Types> listed(types.begin(), types.end());
+    CHECK(listed == std::vector{Types::Uint, Types::Bytes20, Types::Address});
+    CHECK(ParamTypes{}.empty());
+
+    std::ostringstream out;
+    out << types;
+    CHECK(out.str() == "Types::Uint|Types::Bytes20|Types::Address");
+  }
+
+  TEST_CASE("params as parallel columns") {
+    auto bytes{bytes_from_hex(MULTICALL_CALLDATA)};
+    Calldata calldata{std::span<const uint8_t>{bytes}};
+
+    auto main{calldata.columns()};
+    CHECK(main.words.size() == calldata.params.size());
+    CHECK(main.offsets.size() == main.words.size());
+    CHECK(main.types.size() == main.words.size());
+    CHECK(main.offsets[1] == 4 + 32);
+
+    REQUIRE(!calldata.nested_details.empty());
+    auto nested{calldata.nested_details.at(0).columns()};
+    REQUIRE(nested.words.size() == 11);
+    REQUIRE(nested.types.size() == 11);
+
+    for (size_t i = 0; i < nested.words.size(); i++) {
+      CHECK(nested.words[i] == Word::from_bytes(std::span{bytes}.subspan(nested.offsets[i])));
+      CHECK(nested.types[i] == get_param_type(nested.words[i]));
+    }
+    CHECK(nested.offsets[0] == 4 + 5 * 32 + 4);
+  }
+
+  TEST_CASE("decode raw calldata bytes without copying") {
+    auto hex_bytes{bytes_from_hex(MULTICALL_CALLDATA)};
+    std::vector<std::byte> buffer(hex_bytes.size());
+    std::memcpy(buffer.data(), hex_bytes.data(), hex_bytes.size());
+
+    Calldata calldata{std::span<const std::byte>{buffer}};
+
+    CHECK(calldata.storage.empty());
+    CHECK(static_cast<const void*>(calldata.calldata.data()) == buffer.data());
+    CHECK(calldata.selector == Selector{0xac9650d8});
+    REQUIRE(calldata.nested_details.size() == 2);
+
+    // The first nested call follows the offsets, array length, and its own length.
+    const auto& nested{calldata.nested_details.at(0)};
+    CHECK(nested.selector == Selector{0x88316456});
+    CHECK(static_cast<const void*>(nested.data.data()) == buffer.data() + 4 + 5 * 32);
+    CHECK(nested.data.size() == 0x164);
+    CHECK(nested.params.size() == 11);
+
+    // Copies of hex calldata refer into their own storage.
+    Calldata from_hex{"0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af"};
+    Calldata copy{from_hex};
+    CHECK(copy.calldata.data() == copy.storage.data());
+    CHECK(copy.main_details.data.data() == copy.storage.data());
+  }
+
+  // Encodes multicall(bytes[]) around the given calls.
+  std::vector<uint8_t> encode_multicall(const std::vector<std::vector<uint8_t>>& calls) {
+    auto out{bytes_from_hex("0xac9650d8")};
+    auto append_size{[&](size_t value) {
+      Word word{};
+      for (size_t i = 0; i < 8; i++) word.bytes[WORD_SIZE - 1 - i] = uint8_t(value >> (8 * i));
+      out.insert(out.end(), word.bytes.begin(), word.bytes.end());
+    }};
+    auto padded{[](size_t size) { return (size + WORD_SIZE - 1) / WORD_SIZE * WORD_SIZE; }};
+
+    append_size(WORD_SIZE);
+    append_size(calls.size());
+
+    size_t offset{calls.size() * WORD_SIZE};
+    for (const auto& call : calls) {
+      append_size(offset);
+      offset += WORD_SIZE + padded(call.size());
+    }
+
+    for (const auto& call : calls) {
+      append_size(call.size());
+      out.insert(out.end(), call.begin(), call.end());
+      out.resize(out.size() + padded(call.size()) - call.size(), 0);
+    }
+
+    return out;
+  }
+
+  TEST_CASE("resolve offsets and lengths of nested calls") {
+    auto transfer{bytes_from_hex(
+        "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+        "0000000000000000000000000000000005f7aab8c56b0000")};
+
+    // A trailing zero word is a param like any other.
+    Calldata zero{"0x095ea7b300000000000000000000000000000000000000000000000000000000000000ff"
+                  "0000000000000000000000000000000000000000000000000000000000000000"};
+    REQUIRE(zero.params.size() == 2);
+    CHECK(zero.params.at(0) == Word::from_hex(
+              "00000000000000000000000000000000000000000000000000000000000000ff"));
+    CHECK(zero.params.at(1).is_zero());
+    CHECK(zero.nested_details.empty());
+
+    // Calls nested in nested calls are followed too.
+    auto inner{encode_multicall({transfer, transfer})};
+    auto outer{encode_multicall({transfer, inner})};
+    Calldata nested{std::span<const uint8_t>{outer}};
+
+    REQUIRE(nested.nested_details.size() == 4);
+    CHECK(nested.nested_details.at(0).selector == Selector{0xa9059cbb});
+    CHECK(nested.nested_details.at(1).selector == Selector{0xac9650d8});
+    CHECK(nested.nested_details.at(1).data.size() == inner.size());
+    CHECK(std::ranges::equal(nested.nested_details.at(2).params,
+                             split_calldata(std::span{transfer}.subspan(4))));
+    CHECK(nested.nested_details.at(3).selector == Selector{0xa9059cbb});
+
+    // Large batches are resolved in a single pass.
+    std::vector<std::vector<uint8_t>> calls(5000, transfer);
+    auto batch{encode_multicall(calls)};
+    CHECK(Calldata{std::span<const uint8_t>{batch}}.nested_details.size() == 5000);
+  }
+
+  TEST_CASE("nested calls form a tree of parent indices") {
+    auto transfer{bytes_from_hex(
+        "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+        "0000000000000000000000000000000005f7aab8c56b0000")};
+
+    auto inner{encode_multicall({transfer, transfer})};
+    auto outer{encode_multicall({transfer, inner})};
+    Calldata tree{std::span<const uint8_t>{outer}};
+
+    REQUIRE(tree.nested_details.size() == 4);
+    CHECK(tree.main_details.parent == NO_PARENT);
+    CHECK(tree.main_details.depth == 0);
+    CHECK(tree.nested_details.at(0).parent == NO_PARENT);
+    CHECK(tree.nested_details.at(1).parent == NO_PARENT);
+    CHECK(tree.nested_details.at(2).parent == 1);
+    CHECK(tree.nested_details.at(3).parent == 1);
+    CHECK(tree.nested_details.at(0).depth == 1);
+    CHECK(tree.nested_details.at(3).depth == 2);
+    CHECK_FALSE(tree.truncated);
+
+    // Calls nested far deeper than any stack would allow are decoded when the limit allows it.
+    auto deep{transfer};
+    for (size_t i = 0; i < 300; i++) deep = encode_multicall({deep});
+
+    DecodeOptions deeper{1000};
+    deeper.steps_per_byte = SIZE_MAX;
+    deeper.memory_per_byte = SIZE_MAX;
+    Calldata chain{std::span<const uint8_t>{deep}, deeper};
+    REQUIRE(chain.nested_details.size() == 300);
+    CHECK_FALSE(chain.truncated);
+    for (size_t i = 0; i < chain.nested_details.size(); i++) {
+      const auto& call{chain.nested_details[i]};
+      CHECK(call.depth == i + 1);
+      CHECK(call.parent == (i == 0 ? NO_PARENT : i - 1));
+    }
+    CHECK(chain.nested_details.back().selector == Selector{0xa9059cbb});
+
+    // Limits leave the rest of the tree undecoded.
+    Calldata shallow{std::span<const uint8_t>{deep}};
+    CHECK(shallow.nested_details.size() == DecodeOptions{}.max_depth);
+    CHECK(shallow.truncated);
+
+    DecodeOptions options{};
+    options.max_depth = 1;
+    Calldata top{std::span<const uint8_t>{outer}, options};
+    CHECK(top.nested_details.size() == 2);
+    CHECK(top.truncated);
+
+    options = DecodeOptions{};
+    options.max_nested_calls = 3;
+    Calldata few{std::span<const uint8_t>{outer}, options};
+    CHECK(few.nested_details.size() == 3);
+    CHECK(few.truncated);
+
+    // Copies keep the tree.
+    Calldata copy{few};
+    CHECK(copy.truncated);
+    CHECK(copy.nested_details.at(2).parent == 1);
+  }
+
+  TEST_CASE("nested calls found in the same call don't overlap") {
+    // Every head points at a call running to the end of the calldata, so each call holds all the
+    // ones after it, and decoding them all would copy the calldata once per head.
+    constexpr size_t heads{2000};
+    std::vector<uint8_t> data{0xde, 0xad, 0xbe, 0xef};
+    auto append_size{[&](size_t value) {
+      Word word{};
+      for (size_t i = 0; i < 8; i++) word.bytes[WORD_SIZE - 1 - i] = uint8_t(value >> (8 * i));
+      data.insert(data.end(), word.bytes.begin(), word.bytes.end());
+    }};
+
+    for (size_t i = 0; i < heads; i++) append_size((heads + i * 2) * WORD_SIZE);
+    const size_t size{data.size() + heads * 2 * WORD_SIZE + SELECTOR_SIZE};
+    for (size_t i = 0; i < heads; i++) {
+      append_size(size - data.size() - WORD_SIZE);
+      data.insert(data.end(), {0x12, 0x34, 0x56, 0x78});
+      data.resize(data.size() + WORD_SIZE - SELECTOR_SIZE, 0);
+    }
+    data.resize(size, 0);
+
+    DecodeOptions options{};
+    options.max_memory = data.size() * 16;
+    auto decoded{try_decode(std::span<const uint8_t>{data}, options)};
+    REQUIRE(decoded);
+    REQUIRE(decoded.calldata->nested_details.size() == 1);
+    CHECK(decoded.calldata->nested_details[0].selector == Selector{0x12345678});
+    CHECK(decoded.calldata->nested_details[0].data.size()
+          == size - SELECTOR_SIZE - (heads + 1) * WORD_SIZE);
+  }
+
+  TEST_CASE("decode budgets bound the work on crafted input") {
+    auto transfer{bytes_from_hex(
+        "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+        "0000000000000000000000000000000005f7aab8c56b0000")};
+
+    auto ok{try_decode(std::span<const uint8_t>{transfer})};
+    REQUIRE(ok);
+    CHECK(ok.status == DecodeStatus::Ok);
+    CHECK(ok.calldata->params.size() == 2);
+
+    // Malformed input is reported instead of thrown.
+    CHECK(try_decode("0xa9059c").status == DecodeStatus::Malformed);
+    CHECK(try_decode("0xa9059cbz").status == DecodeStatus::Malformed);
+    CHECK(try_decode("0xa9059cb").status == DecodeStatus::Malformed);
+    CHECK_FALSE(try_decode("").calldata.has_value());
+    CHECK(status_name(DecodeStatus::BudgetExceeded) == "budget_exceeded");
+
+    // A deep chain of calls costs a copy of its tail per level.
+    auto deep{transfer};
+    for (size_t i = 0; i < 300; i++) deep = encode_multicall({deep});
+    DecodeOptions unlimited{1000};
+    unlimited.steps_per_byte = SIZE_MAX;
+    unlimited.memory_per_byte = SIZE_MAX;
+    auto full{try_decode(std::span<const uint8_t>{deep}, unlimited)};
+    REQUIRE(full);
+    CHECK(full.calldata->nested_details.size() == 300);
+
+    // The default budgets scale with the input, and cover the default depth but not this one.
+    CHECK(try_decode(std::span<const uint8_t>{deep}).status == DecodeStatus::Ok);
+    CHECK(try_decode(std::span<const uint8_t>{deep}, DecodeOptions{1000}).status
+          == DecodeStatus::BudgetExceeded);
+
+    DecodeOptions steps{unlimited};
+    steps.max_steps = deep.size();
+    auto slow{try_decode(std::span<const uint8_t>{deep}, steps)};
+    CHECK(slow.status == DecodeStatus::BudgetExceeded);
+    CHECK_FALSE(slow.calldata.has_value());
+
+    DecodeOptions memory{unlimited};
+    memory.max_memory = deep.size() * 4;
+    CHECK(try_decode(std::span<const uint8_t>{deep}, memory).status
+          == DecodeStatus::BudgetExceeded);
+    CHECK_THROWS_AS((Calldata{std::span<const uint8_t>{deep}, memory}), BudgetExceeded);
+
+    // Hex input is checked against the budget before it is decoded.
+    std::string huge(1 << 20, '0');
+    memory.max_memory = 1024;
+    CHECK(try_decode(huge, memory).status == DecodeStatus::BudgetExceeded);
+
+    // Budgets that cover the decode don't change its result.
+    DecodeOptions generous{unlimited};
+    generous.max_steps = deep.size() * 1000;
+    generous.max_memory = deep.size() * 1000;
+    auto bounded{try_decode(std::span<const uint8_t>{deep}, generous)};
+    REQUIRE(bounded);
+    CHECK(bounded.calldata->nested_details.size() == 300);
+  }
+
+  TEST_CASE("decode within an arena") {
+    DecodeArena arena{};
+    auto* resource{arena.allocator().resource()};
+
+    // Nothing may fall back to the default resource.
+    auto* previous{std::pmr::set_default_resource(std::pmr::null_memory_resource())};
+    std::optional<Calldata> calldata;
+    CHECK_NOTHROW(calldata.emplace(MULTICALL_CALLDATA, arena.allocator()));
+    std::pmr::set_default_resource(previous);
+
+    REQUIRE(calldata.has_value());
+    CHECK(calldata->get_allocator().resource() == resource);
+    CHECK(calldata->storage.get_allocator().resource() == resource);
+    REQUIRE(calldata->nested_details.size() == 2);
+    CHECK(calldata->nested_details.at(0).get_allocator().resource() == resource);
+    CHECK(calldata->nested_details.at(0).param_types.get_allocator().resource() == resource);
+
+    // Moving into a decode on another resource copies the bytes and re-points the views.
+    Calldata moved{"0xa9059cbb"};
+    moved = std::move(*calldata);
+    CHECK(moved.get_allocator().resource() == std::pmr::get_default_resource());
+    CHECK(moved.calldata.data() == moved.storage.data());
+    CHECK(moved.nested_details.at(0).data.data() == moved.storage.data() + 4 + 5 * 32);
+
+    calldata.reset();
+    arena.reset();
+
+    // The arena is reused after a reset.
+    Calldata again{MULTICALL_CALLDATA, arena.allocator()};
+    CHECK(again.nested_details.size() == 2);
+  }
+
+  TEST_CASE("type names are constant") {
+    static_assert(type_name(Types::Address) == "Types::Address");
+    CHECK(type_name(Types::MaxUint128) == "Types::MaxUint128");
+  }
 }
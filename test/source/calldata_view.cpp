@@ -0,0 +1,56 @@
+#include <doctest/doctest.h>
+#include <evmtools/calldata_view.h>
+
+#include <stdexcept>
+#include <vector>
+
+TEST_SUITE("calldata_view") {
+  using namespace evmtools::calldata_decoder;
+
+  TEST_CASE("read the selector without decoding") {
+    auto bytes{bytes_from_hex(
+        "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+        "0000000000000000000000000000000005f7aab8c56b0000")};
+
+    CalldataView view{std::span<const uint8_t>{bytes}};
+    CHECK(view.selector() == Selector{0xa9059cbb});
+    CHECK(view.size() == 2);
+    CHECK_FALSE(view.is_decoded());
+
+    CHECK(view.types(0) == ParamTypes{Types::Address, Types::Bytes20, Types::Uint});
+    CHECK(view.types(0) == view.types(0));
+    CHECK_FALSE(view.is_decoded());
+    CHECK_THROWS_AS((void)view.word(2), std::out_of_range);
+
+    CHECK(view.nested().empty());
+    CHECK(view.is_decoded());
+    CHECK(view.decoded().selector == Selector{0xa9059cbb});
+  }
+
+  TEST_CASE("short calldata has no selector") {
+    std::vector<uint8_t> bytes{0xa9, 0x05};
+    CalldataView view{std::span<const uint8_t>{bytes}};
+
+    CHECK_FALSE(view.selector().has_value());
+    CHECK(view.size() == 0);
+    CHECK_THROWS_AS((void)view.decoded(), std::out_of_range);
+  }
+
+  TEST_CASE("words and types match a full decode") {
+    for (auto hex : {"0xac9650d8000000000000000000000000000000000000000000000000000000000000002000",
+                     "0x095ea7b300000000000000000000000000000000000000000000000000000000000000ff"
+                     "0000000000000000000000000000000000000000000000000000000000000000",
+                     "0x12345678000000000000000000000000000000000000000000000000000000000000002a"
+                     "00000000000000000000000000000000000000000000000000000000"}) {
+      auto bytes{bytes_from_hex(hex)};
+      CalldataView view{std::span<const uint8_t>{bytes}};
+      Calldata calldata{std::span<const uint8_t>{bytes}};
+
+      REQUIRE(view.size() == calldata.params.size());
+      for (size_t i = 0; i < view.size(); i++) {
+        CHECK(view.word(i) == calldata.params[i]);
+        CHECK(view.types(i) == calldata.main_details.param_types[i]);
+      }
+    }
+  }
+}
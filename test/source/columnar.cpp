@@ -0,0 +1,175 @@
+#include <doctest/doctest.h>
+#include <evmtools/columnar.h>
+#include <evmtools/stream_decoder.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_SUITE("columnar") {
+  using namespace evmtools;
+  using calldata_decoder::Calldata;
+  using calldata_decoder::Selector;
+  using calldata_decoder::Word;
+
+  constexpr std::string_view TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+      "0000000000000000000000000000000005f7aab8c56b0000"};
+
+  std::vector<uint8_t> word_of(size_t value) {
+    std::vector<uint8_t> word(calldata_decoder::WORD_SIZE, 0);
+    for (size_t i = 0; i < sizeof(value); i++) {
+      word[word.size() - 1 - i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+    return word;
+  }
+
+  /** Encodes `multicall(bytes[])` around a single call. */
+  std::vector<uint8_t> multicall(const std::vector<uint8_t>& call) {
+    std::vector<uint8_t> out{0xac, 0x96, 0x50, 0xd8};
+    for (size_t value : {size_t{0x20}, size_t{1}, size_t{0x20}, call.size()}) {
+      auto word{word_of(value)};
+      out.insert(out.end(), word.begin(), word.end());
+    }
+    out.insert(out.end(), call.begin(), call.end());
+    out.resize(out.size() + (calldata_decoder::WORD_SIZE - call.size() % 32) % 32, 0);
+    return out;
+  }
+
+  std::vector<uint8_t> to_image(const std::string& text) {
+    return std::vector<uint8_t>(text.begin(), text.end());
+  }
+
+  TEST_CASE("columns round trip through a row group") {
+    auto transfer{calldata_decoder::bytes_from_hex(TRANSFER)};
+    auto nested_bytes{multicall(multicall(transfer))};
+    Calldata plain{TRANSFER};
+    Calldata nested{std::span<const uint8_t>{nested_bytes}};
+
+    std::ostringstream out;
+    {
+      columnar::ColumnWriter writer{out};
+      writer.append(0, &plain);
+      writer.append(1, nullptr);
+      writer.append(2, &nested);
+    }
+
+    columnar::ColumnReader reader{to_image(out.str())};
+    REQUIRE(reader.groups().size() == 1);
+    CHECK(reader.inputs() == 3);
+    CHECK(reader.calls() == 4);
+
+    const auto& group{reader.groups()[0]};
+    CHECK(group.call_inputs[0] == 0);
+    CHECK(group.call_inputs[1] == 2);
+    CHECK(group.selectors[0] == Selector{0xa9059cbb});
+    CHECK(group.selectors[1] == Selector{0xac9650d8});
+
+    auto first{group.call_words(0)};
+    REQUIRE(first.words.size() == plain.params.size());
+    for (size_t i = 0; i < first.words.size(); i++) {
+      CHECK(first.words[i] == plain.params[i]);
+      CHECK(first.offsets[i] == plain.main_details.offsets[i]);
+      CHECK(first.types[i] == plain.main_details.param_types[i]);
+    }
+
+    // Calls 2 and 3 are the nested calls of input 2, linked to the call they were found in.
+    REQUIRE(group.parents.size() == 2);
+    for (size_t n = 0; n < 2; n++) {
+      const auto parent{nested.nested_details[n].parent};
+      CHECK(group.children[n] == 2 + n);
+      CHECK(group.parents[n] == (parent == calldata_decoder::NO_PARENT ? 1 : 2 + parent));
+
+      auto words{group.call_words(2 + n)};
+      CHECK(words.words.size() == nested.nested_details[n].params.size());
+      CHECK(group.selectors[2 + n] == nested.nested_details[n].selector);
+    }
+
+    CHECK(reader.words() == group.words.size());
+    CHECK(group.call_words(4).words.empty());
+  }
+
+  TEST_CASE("full row groups are written as they fill up") {
+    Calldata transfer{TRANSFER};
+
+    std::ostringstream out;
+    {
+      columnar::ColumnWriter writer{out, 5};
+      for (size_t i = 0; i < 10; i++) writer.append(i, &transfer);
+      writer.flush();
+      // Nothing buffered, so flushing again writes no group.
+      writer.flush();
+    }
+
+    columnar::ColumnReader reader{to_image(out.str())};
+    // Each transfer has 2 words, so every third input fills a group.
+    CHECK(reader.groups().size() == 4);
+    CHECK(reader.inputs() == 10);
+    CHECK(reader.calls() == 10);
+    CHECK(reader.words() == 20);
+
+    uint64_t expected{0};
+    for (const auto& group : reader.groups()) {
+      for (auto input : group.call_inputs) CHECK(input == expected++);
+    }
+  }
+
+  TEST_CASE("decode stream writes a memory-mappable columnar file") {
+    std::string input;
+    for (size_t i = 0; i < 100; i++) {
+      input += i % 10 == 3 ? std::string{"0xzz"} : std::string{TRANSFER};
+      input += '\n';
+    }
+
+    auto path{std::filesystem::temp_directory_path() / "evmtools_columnar_test.col"};
+    {
+      std::ofstream file{path, std::ios::binary};
+      stream_decoder::StreamOptions options{2, 7};
+      options.format = stream_decoder::OutputFormat::Columnar;
+      auto stats{stream_decoder::decode_stream(input, file, options)};
+      CHECK(stats.decoded == 90);
+    }
+
+    {
+      columnar::ColumnReader reader{path};
+      CHECK(reader.inputs() == 100);
+      CHECK(reader.calls() == 90);
+
+      // Scan a single column: every selector is a transfer.
+      size_t transfers{0};
+      for (const auto& group : reader.groups()) {
+        for (auto selector : group.selectors) transfers += selector == Selector{0xa9059cbb};
+        for (auto input : group.call_inputs) CHECK(input % 10 != 3);
+      }
+      CHECK(transfers == 90);
+    }
+
+    std::filesystem::remove(path);
+  }
+
+  TEST_CASE("reject invalid files") {
+    Calldata transfer{TRANSFER};
+    std::ostringstream out;
+    {
+      columnar::ColumnWriter writer{out};
+      CHECK(columnar::ColumnReader{to_image(out.str())}.groups().empty());
+      writer.append(0, &transfer);
+    }
+    auto image{to_image(out.str())};
+    CHECK(columnar::ColumnReader{image}.calls() == 1);
+
+    CHECK_THROWS_AS(columnar::ColumnReader{std::vector<uint8_t>(image.begin(), image.end() - 1)},
+                    std::runtime_error);
+
+    auto corrupt{image};
+    // Point the word end of the only call past its words.
+    corrupt[32 + 64 + 32 + 32] = 0xff;
+    CHECK_THROWS_AS(columnar::ColumnReader{corrupt}, std::runtime_error);
+
+    image[0] = 'X';
+    CHECK_THROWS_AS(columnar::ColumnReader{image}, std::runtime_error);
+  }
+}
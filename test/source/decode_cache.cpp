@@ -0,0 +1,130 @@
+#include <doctest/doctest.h>
+#include <evmtools/decode_cache.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("decode_cache") {
+  using namespace evmtools::decode_cache;
+  using evmtools::calldata_decoder::bytes_from_hex;
+  using evmtools::calldata_decoder::Selector;
+
+  const std::string TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af00000000000000000"
+      "000000000000000000000000000000005f7aab8c56b0000"};
+
+  /** A distinct calldata hex string per `n`. */
+  std::string numbered(size_t n) {
+    auto hex{TRANSFER};
+    auto digits{std::to_string(n)};
+    hex.replace(hex.size() - digits.size(), digits.size(), digits);
+    return hex;
+  }
+
+  TEST_CASE("hash byte strings") {
+    auto bytes{bytes_from_hex(TRANSFER)};
+    CHECK(hash_bytes(bytes) == hash_bytes(bytes));
+    CHECK(hash_bytes(bytes) != hash_bytes(std::span{bytes}.first(bytes.size() - 1)));
+
+    auto changed{bytes};
+    changed.back() ^= 1;
+    CHECK(hash_bytes(bytes) != hash_bytes(changed));
+    CHECK(hash_bytes({}) != hash_bytes(std::span{bytes}.first(1)));
+  }
+
+  TEST_CASE("return the same decode for repeated inputs") {
+    DecodeCache cache{16, 1};
+
+    auto first{cache.get(TRANSFER)};
+    auto second{cache.get(TRANSFER)};
+    CHECK(first == second);
+    CHECK(first->selector == Selector{0xa9059cbb});
+
+    auto stats{cache.stats()};
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+    CHECK(stats.size == 1);
+
+    // Raw bytes are keyed separately from hex, and copied into the cache.
+    auto bytes{bytes_from_hex(TRANSFER)};
+    auto raw{cache.get(std::span<const uint8_t>{bytes})};
+    CHECK(raw != first);
+    bytes.assign(bytes.size(), 0);
+    CHECK(raw->selector == Selector{0xa9059cbb});
+    CHECK(raw->calldata.data() != bytes.data());
+    CHECK(cache.stats().size == 2);
+  }
+
+  TEST_CASE("don't cache malformed inputs") {
+    DecodeCache cache{16, 1};
+    CHECK_THROWS_AS((void)cache.get(std::string_view{"0xzz"}), std::invalid_argument);
+    CHECK_THROWS_AS((void)cache.get(std::string_view{"0xzz"}), std::invalid_argument);
+    CHECK(cache.stats().misses == 2);
+    CHECK(cache.stats().size == 0);
+    CHECK_THROWS_AS(DecodeCache{0}, std::invalid_argument);
+  }
+
+  TEST_CASE("evict entries that weren't used since the clock hand last passed") {
+    DecodeCache cache{4, 1};
+    CHECK(cache.capacity() == 4);
+
+    std::vector<std::shared_ptr<const evmtools::calldata_decoder::Calldata>> held;
+    for (size_t i = 0; i < 4; i++) held.push_back(cache.get(numbered(i)));
+
+    // Keep 0 hot, then add a fifth input: 1 is the oldest entry that wasn't used again.
+    (void)cache.get(numbered(0));
+    (void)cache.get(numbered(4));
+
+    auto stats{cache.stats()};
+    CHECK(stats.evictions == 1);
+    CHECK(stats.size == 4);
+
+    (void)cache.get(numbered(0));
+    CHECK(cache.stats().hits == stats.hits + 1);
+    (void)cache.get(numbered(1));
+    CHECK(cache.stats().misses == stats.misses + 1);
+
+    // Evicted results stay valid while they're held.
+    CHECK(held[1]->selector == Selector{0xa9059cbb});
+
+    cache.clear();
+    CHECK(cache.stats().size == 0);
+  }
+
+  TEST_CASE("share the cache between threads") {
+    DecodeCache cache{64};
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < 4; t++) {
+      threads.emplace_back([&] {
+        for (size_t i = 0; i < 1000; i++) {
+          auto calldata{cache.get(numbered(i % 32))};
+          REQUIRE(calldata->selector == Selector{0xa9059cbb});
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+
+    auto stats{cache.stats()};
+    CHECK(stats.hits + stats.misses == 4000);
+    CHECK(stats.size <= cache.capacity());
+    CHECK(stats.misses >= 32);
+  }
+
+  TEST_CASE("decode batches through the cache") {
+    evmtools::thread_pool::ThreadPool pool{2};
+    DecodeCache cache{64};
+
+    std::vector<std::string_view> inputs{TRANSFER, "0xzz", TRANSFER, TRANSFER};
+    auto results{decode_batch(inputs, pool, cache, 1)};
+
+    REQUIRE(results.size() == 4);
+    CHECK(results[0] != nullptr);
+    CHECK(results[1] == nullptr);
+    CHECK(results[2] != nullptr);
+    CHECK(results[3]->selector == Selector{0xa9059cbb});
+    CHECK(cache.stats().size == 1);
+  }
+}
@@ -0,0 +1,61 @@
+#include <doctest/doctest.h>
+#include <evmtools/decode_stats.h>
+
+#include <string>
+#include <thread>
+
+TEST_SUITE("decode_stats") {
+  using namespace evmtools::decode_stats;
+  using evmtools::calldata_decoder::Calldata;
+  using evmtools::calldata_decoder::Types;
+
+  const std::string TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af00000000000000000"
+      "000000000000000000000000000000005f7aab8c56b0000"};
+
+  const std::string MULTICALL{
+      "0xac9650d8000000000000000000000000000000000000000000000000000000000000002000000000000000000"
+      "00000000000000000000000000000000000000000000001000000000000000000000000000000000000000000"
+      "00000000000000000000200000000000000000000000000000000000000000000000000000000000000044a90"
+      "59cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af000000000000000000000"
+      "0000000000000000000000000000005f7aab8c56b000000000000000000000000000000000000000000000000"
+      "00000000000000"};
+
+  TEST_CASE("name phases") {
+    CHECK(phase_name(Phase::ParseSelector) == "parse_selector");
+    CHECK(phase_name(Phase::GetParamTypes) == "get_param_types");
+  }
+
+  TEST_CASE("count decode phases across threads") {
+    reset();
+
+    CountingResource counting{};
+    std::thread worker{[&] { Calldata calldata{MULTICALL, &counting}; }};
+    worker.join();
+    Calldata calldata{TRANSFER, &counting};
+
+    auto stats{snapshot()};
+    if constexpr (!ENABLED) {
+      CHECK(stats[Phase::ParseSelector].calls == 0);
+      CHECK(stats.nested_calls == 0);
+      return;
+    }
+
+    // The worker has exited, but its counters are kept.
+    CHECK(stats[Phase::ParseSelector].calls == 2);
+    CHECK(stats[Phase::ParseSelector].bytes == (TRANSFER.size() + MULTICALL.size() - 4) / 2);
+    CHECK(stats[Phase::ParseRawParams].calls == 2);
+    CHECK(stats[Phase::ParseLen].calls == 1);
+    CHECK(stats[Phase::ParseLen].bytes == 68);
+    CHECK(stats[Phase::GetParamTypes].calls == 2);
+    CHECK(stats.nested_calls == 1);
+
+    // The transfer's address word is a candidate Address, in both calls.
+    CHECK(stats.count(Types::Address) >= 2);
+    CHECK(stats[Phase::ParseSelector].allocations > 0);
+    CHECK(stats[Phase::ParseSelector].allocated_bytes > 0);
+
+    reset();
+    CHECK(snapshot()[Phase::ParseSelector].calls == 0);
+  }
+}
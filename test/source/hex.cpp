@@ -0,0 +1,98 @@
+#include <doctest/doctest.h>
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/hex.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+TEST_SUITE("hex") {
+  using namespace evmtools;
+
+  constexpr hex::Kernel KERNELS[]{hex::Kernel::Scalar, hex::Kernel::Sse4, hex::Kernel::Avx2};
+
+  TEST_CASE("kernels agree on random input of every length") {
+    std::mt19937 rng{42};
+    constexpr std::string_view digits{"0123456789abcdefABCDEF"};
+
+    for (size_t len = 0; len < 300; len++) {
+      std::string input(len * 2, '0');
+      for (auto& c : input) c = digits[rng() % digits.size()];
+
+      std::vector<uint8_t> expected(len);
+      for (size_t i = 0; i < len; i++) {
+        expected[i] = static_cast<uint8_t>(
+            calldata_decoder::nibble_from_hex(input[i * 2]) << 4
+            | calldata_decoder::nibble_from_hex(input[i * 2 + 1]));
+      }
+
+      for (auto kernel : KERNELS) {
+        std::vector<uint8_t> out(len);
+        CHECK_FALSE(hex::decode(input, out, kernel).has_value());
+        CHECK(out == expected);
+      }
+    }
+  }
+
+  TEST_CASE("kernels report the first invalid character") {
+    for (auto bad : {'g', 'G', 'x', ' ', '/', ':', '@', '`', '\x10', '\x80', '\xff'}) {
+      for (size_t pos : {0, 1, 15, 16, 31, 32, 63, 64, 100, 129}) {
+        std::string input(130, 'a');
+        input[pos] = bad;
+
+        for (auto kernel : KERNELS) {
+          std::vector<uint8_t> out(input.size() / 2);
+          auto invalid{hex::decode(input, out, kernel)};
+          REQUIRE(invalid.has_value());
+          CHECK(*invalid == pos);
+        }
+      }
+    }
+  }
+
+  TEST_CASE("kernels encode every length") {
+    std::mt19937 rng{7};
+
+    for (size_t len = 0; len < 300; len++) {
+      std::vector<uint8_t> bytes(len);
+      for (auto& byte : bytes) byte = static_cast<uint8_t>(rng());
+
+      std::string expected;
+      for (auto byte : bytes) {
+        expected += "0123456789abcdef"[byte >> 4];
+        expected += "0123456789abcdef"[byte & 0x0f];
+      }
+
+      for (auto kernel : KERNELS) {
+        // One spare character checks that nothing is written past the encoded bytes.
+        std::string out(len * 2 + 1, '*');
+        hex::encode(bytes, out, kernel);
+        CHECK(out == expected + "*");
+
+        std::vector<uint8_t> decoded(len);
+        CHECK_FALSE(hex::decode(out.substr(0, len * 2), decoded, kernel).has_value());
+        CHECK(decoded == bytes);
+      }
+    }
+  }
+
+  TEST_CASE("encoding never writes past its output") {
+    const std::vector<uint8_t> bytes(64, 0xab);
+    std::string expected;
+    for (size_t i = 0; i < 16; i++) expected += "ab";
+
+    for (auto kernel : KERNELS) {
+      std::string out(33, '*');
+      hex::encode(bytes, std::span{out}.first(32), kernel);
+      CHECK(out == expected + "*");
+    }
+  }
+
+  TEST_CASE("hex strings are validated when decoding") {
+    CHECK(calldata_decoder::uint_from_hex_str<256>("ff") == intx::uint256{0xff} << 248);
+    CHECK_THROWS_AS(calldata_decoder::uint_from_hex_str<256>("0g"), std::invalid_argument);
+    CHECK_THROWS_AS(calldata_decoder::bytes_from_hex("0xa9059cbz"), std::invalid_argument);
+    CHECK(calldata_decoder::bytes_from_hex("0XA9059CBB")
+          == std::vector<uint8_t>{0xa9, 0x05, 0x9c, 0xbb});
+  }
+}
@@ -0,0 +1,115 @@
+#include <doctest/doctest.h>
+#include <evmtools/json_writer.h>
+#include <evmtools/signature_index.h>
+
+#include <string>
+#include <vector>
+
+TEST_SUITE("json_writer") {
+  using namespace evmtools::json_writer;
+
+  constexpr std::string_view TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+      "0000000000000000000000000000000005f7aab8c56b0000"};
+
+  // multicall(bytes[]) with two nested calls.
+  constexpr std::string_view MULTICALL{
+      "0xac9650d800000000000000000000000000000000000000000000000000000000000000200000000000000000"
+      "000000000000000000000000000000000000000000000002000000000000000000000000000000000000000000"
+      "000000000000000000004000000000000000000000000000000000000000000000000000000000000001e00000"
+      "000000000000000000000000000000000000000000000000000000000164883164560000000000000000000000"
+      "00c011a73ee8576fb46f5e1c5751ca3b9fe0af2a6f000000000000000000000000c02aaa39b223fe8d0a0e5c4f"
+      "27ead9083c756cc20000000000000000000000000000000000000000000000000000000000002710ffffffffff"
+      "fffffffffffffffffffffffffffffffffffffffffffffffffee530ffffffffffffffffffffffffffffffffffff"
+      "ffffffffffffffffffffffff1b18000000000000000000000000000000000000000000000000016345785d89fd"
+      "6800000000000000000000000000000000000000000000000000007f73eca3063a000000000000000000000000"
+      "000000000000000000000000016042b530ddaec600000000000000000000000000000000000000000000000000"
+      "007e59f044bada000000000000000000000000f847e9d51989033b691b8be943f8e9e268f99b9e000000000000"
+      "000000000000000000000000000000000000000000006377347700000000000000000000000000000000000000"
+      "000000000000000000000000000000000000000000000000000000000000000000000000000000000412210e8a"
+      "00000000000000000000000000000000000000000000000000000000"};
+
+  TEST_CASE("type names drop the enum prefix") {
+    static_assert(TYPE_NAMES[static_cast<size_t>(Types::Address)] == "Address");
+    static_assert(TYPE_NAMES[static_cast<size_t>(Types::MaxUint128)] == "MaxUint128");
+    for (size_t i = 0; i < TYPE_COUNT; i++) {
+      CHECK_FALSE(TYPE_NAMES[i].empty());
+    }
+  }
+
+  TEST_CASE("write a call as json") {
+    Calldata calldata{TRANSFER};
+    std::string out{"prefix "};
+    append_json(out, calldata);
+
+    CHECK(out
+          == "prefix "
+             R"({"selector":"0xa9059cbb","truncated":false,"params":[)"
+             R"({"word":"0x0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af",)"
+             R"("offset":4,"types":["Uint","Bytes20","Address"]},)"
+             R"({"word":"0x00000000000000000000000000000000000000000000000005f7aab8c56b0000",)"
+             R"("offset":36,"types":["Uint","Int","Bytes"]}],"nested":[]})");
+  }
+
+  TEST_CASE("write nested calls with their signatures") {
+    evmtools::signature_index::SignatureIndex signatures{
+        evmtools::signature_index::build_signature_index("refundETH()\nmulticall(bytes[])\n")};
+    Calldata calldata{MULTICALL};
+    REQUIRE(calldata.nested_details.size() == 2);
+
+    std::string out;
+    append_json(out, calldata, &signatures);
+
+    CHECK(out.starts_with(
+        R"json({"selector":"0xac9650d8","signature":"multicall(bytes[])","truncated":false,)json"));
+    CHECK(out.find(R"(,"nested":[{"selector":"0x88316456","depth":1,"params":[{"word":)")
+          != std::string::npos);
+    CHECK(out.find(R"json(},{"selector":"0x12210e8a","signature":"refundETH()","depth":1,)json")
+          != std::string::npos);
+    CHECK(out.ends_with("]}]}"));
+  }
+
+  TEST_CASE("signatures are escaped") {
+    constexpr std::string_view SIGNATURE{"say(\"hi\\\x01)"};
+    evmtools::signature_index::SignatureIndex signatures{
+        evmtools::signature_index::build_signature_index(std::string{SIGNATURE} + "\n")};
+
+    const auto selector{evmtools::signature_index::selector_from_signature(SIGNATURE)};
+    const std::vector<uint8_t> bytes{
+        static_cast<uint8_t>(selector.value >> 24), static_cast<uint8_t>(selector.value >> 16),
+        static_cast<uint8_t>(selector.value >> 8), static_cast<uint8_t>(selector.value)};
+
+    std::string out;
+    append_json(out, Calldata{std::span<const uint8_t>{bytes}}, &signatures);
+    CHECK(out.find(R"json("signature":"say(\"hi\\\u0001)")json") != std::string::npos);
+  }
+
+  TEST_CASE("write ndjson lines") {
+    std::optional<Calldata> decoded{TRANSFER};
+    std::string out;
+    append_ndjson(out, 7, decoded);
+    append_ndjson(out, 8, std::optional<Calldata>{});
+
+    CHECK(out.starts_with(R"({"index":7,"selector":"0xa9059cbb",)"));
+    CHECK(out.ends_with("\"nested\":[]}\n{\"index\":8,\"error\":true}\n"));
+
+    // Transactions are named by their block and their position in it.
+    out.clear();
+    append_transaction_ndjson(out, 17000000, 3, &*decoded);
+    append_transaction_ndjson(out, 17000000, 4, nullptr);
+    CHECK(out.starts_with(R"({"block":17000000,"index":3,"selector":"0xa9059cbb",)"));
+    CHECK(out.ends_with("\n{\"block\":17000000,\"index\":4,\"error\":true}\n"));
+  }
+
+  TEST_CASE("appending to a buffer with room doesn't reallocate") {
+    Calldata calldata{MULTICALL};
+    std::string out;
+    out.reserve(64 * 1024);
+    const auto* data{out.data()};
+
+    for (size_t i = 0; i < 10; i++) {
+      append_ndjson(out, i, &calldata);
+    }
+    CHECK(out.data() == data);
+  }
+}
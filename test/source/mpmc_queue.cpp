@@ -0,0 +1,76 @@
+#include <doctest/doctest.h>
+#include <evmtools/mpmc_queue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("mpmc_queue") {
+  using namespace evmtools::mpmc_queue;
+
+  TEST_CASE("bounded queue is first in, first out") {
+    MpmcQueue<std::unique_ptr<int>> queue{3};
+    CHECK(queue.capacity() == 4);
+    CHECK_FALSE(queue.try_pop().has_value());
+
+    for (int i = 0; i < 4; i++) CHECK(queue.try_push(std::make_unique<int>(i)));
+    CHECK(queue.size() == 4);
+
+    // A refused item stays with the caller.
+    auto extra{std::make_unique<int>(4)};
+    CHECK_FALSE(queue.try_push(std::move(extra)));
+    REQUIRE(extra != nullptr);
+    CHECK(*extra == 4);
+
+    // Popping frees a slot for the next lap around the ring.
+    CHECK(**queue.try_pop() == 0);
+    CHECK(queue.try_push(std::move(extra)));
+    for (int i = 1; i <= 4; i++) CHECK(**queue.try_pop() == i);
+    CHECK(queue.size() == 0);
+
+    // Items left behind are destroyed with the queue.
+    auto shared{std::make_shared<int>(0)};
+    {
+      MpmcQueue<std::shared_ptr<int>> leftover{2};
+      CHECK(leftover.try_push(std::shared_ptr<int>{shared}));
+      CHECK(shared.use_count() == 2);
+    }
+    CHECK(shared.use_count() == 1);
+  }
+
+  TEST_CASE("concurrent producers and consumers hand over every item once") {
+    constexpr size_t PRODUCERS{4};
+    constexpr size_t ITEMS{20'000};
+    MpmcQueue<size_t> queue{64};
+
+    std::vector<std::atomic<int>> seen(PRODUCERS * ITEMS);
+    std::atomic<size_t> consumed{0};
+    std::vector<std::thread> threads;
+
+    for (size_t p = 0; p < PRODUCERS; p++) {
+      threads.emplace_back([&, p] {
+        for (size_t i = 0; i < ITEMS; i++) {
+          size_t item{p * ITEMS + i};
+          while (!queue.try_push(std::move(item))) std::this_thread::yield();
+        }
+      });
+      threads.emplace_back([&] {
+        while (consumed.load() < PRODUCERS * ITEMS) {
+          if (auto item = queue.try_pop()) {
+            seen[*item]++;
+            consumed++;
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads) thread.join();
+
+    CHECK(consumed.load() == PRODUCERS * ITEMS);
+    CHECK(std::all_of(seen.begin(), seen.end(), [](const auto& count) { return count == 1; }));
+  }
+}
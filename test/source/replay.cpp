@@ -0,0 +1,106 @@
+#include <doctest/doctest.h>
+#include <evmtools/replay.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+TEST_SUITE("replay") {
+  using namespace evmtools::replay;
+  using std::chrono::nanoseconds;
+
+  constexpr std::string_view TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+      "0000000000000000000000000000000005f7aab8c56b0000"};
+
+  TEST_CASE("parse timestamped records") {
+    std::string text{"1000 " + std::string{TRANSFER} + "\n\n  1500\t{\"input\": \"0xa9059cbb\"}\r\n"
+                     + "2000 {\"hash\": \"0x00\"}\n2500"};
+
+    auto records{parse_records(text)};
+    REQUIRE(records.size() == 4);
+    CHECK(records[0].timestamp_us == 1000);
+    CHECK(records[0].input == TRANSFER);
+    CHECK(records[1].timestamp_us == 1500);
+    CHECK(records[1].input == "0xa9059cbb");
+    // Lines without calldata are kept, to be replayed as failures.
+    CHECK(records[2].input.empty());
+    CHECK(records[3].timestamp_us == 2500);
+    CHECK(records[3].input.empty());
+
+    CHECK_THROWS_AS(parse_records("0xa9059cbb\n"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_records("12ab 0xa9059cbb\n"), std::invalid_argument);
+  }
+
+  TEST_CASE("summarize latencies by nearest rank") {
+    std::vector<nanoseconds> latencies;
+    for (int i = 1000; i >= 1; i--) latencies.push_back(nanoseconds{i});
+
+    auto summary{summarize(latencies)};
+    CHECK(summary.p50 == nanoseconds{500});
+    CHECK(summary.p99 == nanoseconds{990});
+    CHECK(summary.p999 == nanoseconds{999});
+    CHECK(summary.max == nanoseconds{1000});
+    CHECK(summary.mean == nanoseconds{500});
+
+    CHECK(summarize({nanoseconds{7}}).p999 == nanoseconds{7});
+    CHECK(summarize({}).max == nanoseconds{0});
+  }
+
+  TEST_CASE("replay at a scaled rate") {
+    // 100 records over 100 ms, replayed 10 times faster.
+    std::vector<Record> records;
+    for (uint64_t i = 0; i < 100; i++) {
+      records.push_back(Record{5'000'000 + i * 1000, i % 10 == 3 ? "0xzz" : TRANSFER});
+    }
+
+    ReplayOptions options{};
+    options.speed = 10;
+    options.threads = 2;
+    auto report{replay(records, options)};
+
+    CHECK(report.inputs == 100);
+    CHECK(report.decoded == 90);
+    REQUIRE(report.latencies.size() == 100);
+    // The last record isn't due until 9.9 ms in.
+    CHECK(report.elapsed >= std::chrono::microseconds{9900});
+    CHECK(std::all_of(report.latencies.begin(), report.latencies.end(),
+                      [](nanoseconds latency) { return latency.count() >= 0; }));
+    CHECK(report.throughput() > 0);
+  }
+
+  TEST_CASE("replay an out-of-order recording in timestamp order") {
+    // The first record is due 200 ms after all the others, and mustn't hold them back.
+    std::vector<Record> records{Record{1'200'000, TRANSFER}};
+    for (uint64_t i = 0; i < 50; i++) records.push_back(Record{1'000'000 + i * 100, TRANSFER});
+
+    ReplayOptions options{};
+    options.threads = 2;
+    auto report{replay(records, options)};
+
+    CHECK(report.decoded == records.size());
+    CHECK(report.elapsed >= std::chrono::milliseconds{200});
+    REQUIRE(report.latencies.size() == records.size());
+    CHECK(std::all_of(report.latencies.begin(), report.latencies.end(), [](nanoseconds latency) {
+      return latency < std::chrono::milliseconds{100};
+    }));
+  }
+
+  TEST_CASE("replay as fast as possible") {
+    std::vector<Record> records(1000, Record{0, TRANSFER});
+    records.push_back(Record{3'600'000'000, TRANSFER});
+
+    ReplayOptions options{};
+    options.speed = 0;
+    options.batch_size = 7;
+    auto report{replay(records, options)};
+
+    // Timestamps are ignored, so the hour-long gap isn't waited out.
+    CHECK(report.decoded == records.size());
+    CHECK(report.elapsed < std::chrono::seconds{60});
+    CHECK(summarize(report.latencies).max <= report.elapsed);
+
+    CHECK(replay({}, options).latencies.empty());
+  }
+}
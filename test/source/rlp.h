@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A minimal RLP encoder for building transactions and blocks in tests.
+
+inline std::vector<uint8_t> rlp_header(size_t length, uint8_t base) {
+  if (length < 56) {
+    return {static_cast<uint8_t>(base + length)};
+  }
+  std::vector<uint8_t> size;
+  for (; length != 0; length >>= 8) size.insert(size.begin(), static_cast<uint8_t>(length));
+  size.insert(size.begin(), static_cast<uint8_t>(base + 55 + size.size()));
+  return size;
+}
+
+inline std::vector<uint8_t> rlp_string(const std::vector<uint8_t>& bytes) {
+  if (bytes.size() == 1 && bytes[0] < 0x80) {
+    return bytes;
+  }
+  auto out{rlp_header(bytes.size(), 0x80)};
+  out.insert(out.end(), bytes.begin(), bytes.end());
+  return out;
+}
+
+inline std::vector<uint8_t> rlp_uint(uint64_t value) {
+  std::vector<uint8_t> bytes;
+  for (; value != 0; value >>= 8) bytes.insert(bytes.begin(), static_cast<uint8_t>(value));
+  return rlp_string(bytes);
+}
+
+inline std::vector<uint8_t> rlp_list(const std::vector<std::vector<uint8_t>>& items) {
+  std::vector<uint8_t> payload;
+  for (const auto& item : items) payload.insert(payload.end(), item.begin(), item.end());
+  auto out{rlp_header(payload.size(), 0xc0)};
+  out.insert(out.end(), payload.begin(), payload.end());
+  return out;
+}
+
+/** A typed transaction's envelope: its type byte followed by its list. */
+inline std::vector<uint8_t> typed(uint8_t type, const std::vector<uint8_t>& list) {
+  std::vector<uint8_t> out{type};
+  out.insert(out.end(), list.begin(), list.end());
+  return out;
+}
@@ -0,0 +1,108 @@
+#include <doctest/doctest.h>
+#include <evmtools/selector_scanner.h>
+#include <evmtools/signature_index.h>
+
+#include <random>
+#include <vector>
+
+TEST_SUITE("selector_scanner") {
+  using namespace evmtools::selector_scanner;
+
+  constexpr Kernel KERNELS[]{Kernel::Scalar, Kernel::Sse4, Kernel::Avx2};
+
+  void put(std::vector<uint8_t>& data, size_t offset, Selector selector) {
+    for (size_t i = 0; i < 4; i++) {
+      data[offset + i] = static_cast<uint8_t>(selector.value >> (24 - 8 * i));
+    }
+  }
+
+  /** Checks every window one at a time against the set. */
+  std::vector<Candidate> naive_scan(const std::vector<uint8_t>& data, const SelectorSet& set) {
+    std::vector<Candidate> out;
+    for (size_t offset = 0; offset + 4 <= data.size(); offset++) {
+      const auto selector{Selector::from_bytes(data.data() + offset)};
+      if (set.contains(selector)) out.push_back(Candidate{offset, selector});
+    }
+    return out;
+  }
+
+  TEST_CASE("finds selectors at every offset") {
+    const std::vector<Selector> known{Selector{0xa9059cbb}, Selector{0x095ea7b3},
+                                      Selector{0x5ae401dc}};
+    SelectorSet set{known};
+
+    for (size_t size = 0; size < 80; size++) {
+      for (size_t offset = 0; offset + 4 <= size; offset++) {
+        std::vector<uint8_t> data(size, 0);
+        put(data, offset, known[offset % known.size()]);
+
+        for (auto kernel : KERNELS) {
+          std::vector<Candidate> out;
+          scan(data, set, out, kernel);
+          REQUIRE(out.size() == 1);
+          CHECK(out[0] == Candidate{offset, known[offset % known.size()]});
+        }
+      }
+    }
+  }
+
+  TEST_CASE("kernels match a naive scan of random data") {
+    std::mt19937 rng{7};
+    std::vector<Selector> known;
+    for (size_t i = 0; i < 500; i++) known.push_back(Selector{static_cast<uint32_t>(rng())});
+    SelectorSet set{known};
+    CHECK(set.size() == 500);
+
+    std::vector<uint8_t> data(4099);
+    for (auto& byte : data) byte = static_cast<uint8_t>(rng());
+    for (size_t i = 0; i < 40; i++) {
+      put(data, rng() % (data.size() - 3), known[rng() % known.size()]);
+    }
+
+    const auto expected{naive_scan(data, set)};
+    CHECK(expected.size() >= 30);
+    for (auto kernel : KERNELS) {
+      std::vector<Candidate> out;
+      scan(data, set, out, kernel);
+      CHECK(out == expected);
+    }
+  }
+
+  TEST_CASE("zero words are not candidates") {
+    SelectorSet set{std::vector<Selector>{Selector{0x12345678}}};
+    std::vector<uint8_t> data(4 + 32 * 8, 0);
+    put(data, 0, Selector{0x12345678});
+
+    CHECK(scan(data, set) == std::vector<Candidate>{Candidate{0, Selector{0x12345678}}});
+  }
+
+  TEST_CASE("the filter never rejects a known selector") {
+    std::mt19937 rng{3};
+    std::vector<Selector> known;
+    for (size_t i = 0; i < 2000; i++) known.push_back(Selector{static_cast<uint32_t>(rng())});
+    SelectorSet set{known};
+
+    for (auto selector : known) {
+      CHECK(set.may_contain(selector));
+      CHECK(set.contains(selector));
+    }
+
+    size_t passed{0};
+    for (size_t i = 0; i < 100000; i++) {
+      passed += set.may_contain(Selector{static_cast<uint32_t>(rng())}) ? 1 : 0;
+    }
+    CHECK(passed < 2000);
+  }
+
+  TEST_CASE("a set built from a signature index") {
+    evmtools::signature_index::SignatureIndex index{
+        evmtools::signature_index::build_signature_index("transfer(address,uint256)\n"
+                                                         "approve(address,uint256)\n")};
+    SelectorSet set{index};
+
+    CHECK(set.size() == 2);
+    CHECK(set.contains(Selector{0xa9059cbb}));
+    CHECK(set.contains(Selector{0x095ea7b3}));
+    CHECK_FALSE(set.contains(Selector{0xdeadbeef}));
+  }
+}
@@ -0,0 +1,107 @@
+#include <doctest/doctest.h>
+#include <evmtools/signature_index.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+TEST_SUITE("signature_index") {
+  using namespace evmtools::signature_index;
+  using evmtools::calldata_decoder::Selector;
+
+  static_assert(selector_from_signature("transfer(address,uint256)") == Selector{0xa9059cbb});
+
+  constexpr std::string_view SIGNATURES{
+      "# ERC-20\n"
+      "transfer(address,uint256)\n"
+      "  approve(address,uint256)  \r\n"
+      "\n"
+      "transferFrom(address,address,uint256)\n"
+      "balanceOf(address)\n"
+      "multicall(uint256,bytes[])\n"
+      "transfer(address,uint256)\n"};
+
+  TEST_CASE("selectors of known signatures") {
+    CHECK(selector_from_signature("approve(address,uint256)") == Selector{0x095ea7b3});
+    CHECK(selector_from_signature("balanceOf(address)") == Selector{0x70a08231});
+    CHECK(selector_from_signature("multicall(uint256,bytes[])") == Selector{0x5ae401dc});
+  }
+
+  TEST_CASE("look up signatures in a built index") {
+    SignatureIndex index{build_signature_index(SIGNATURES)};
+
+    CHECK(index.size() == 5);
+    CHECK(index.find(Selector{0xa9059cbb}) == "transfer(address,uint256)");
+    CHECK(index.find(Selector{0x095ea7b3}) == "approve(address,uint256)");
+    CHECK(index.find(Selector{0x23b872dd}) == "transferFrom(address,address,uint256)");
+    CHECK(index.count(Selector{0xa9059cbb}) == 1);
+
+    CHECK_FALSE(index.find(Selector{0xdeadbeef}).has_value());
+    CHECK(index.count(Selector{0xdeadbeef}) == 0);
+  }
+
+  TEST_CASE("keep every signature that shares a selector") {
+    // Both hash to 0x42966c68.
+    SignatureIndex index{
+        build_signature_index("burn(uint256)\ncollate_propagate_storage(bytes16)\n")};
+
+    CHECK(index.size() == 1);
+    CHECK(index.count(Selector{0x42966c68}) == 2);
+    CHECK(index.signature(Selector{0x42966c68}, 0) == "burn(uint256)");
+    CHECK(index.signature(Selector{0x42966c68}, 1) == "collate_propagate_storage(bytes16)");
+    CHECK_FALSE(index.signature(Selector{0x42966c68}, 2).has_value());
+  }
+
+  TEST_CASE("every selector of a large index is found") {
+    auto signature_of{[](size_t i) {
+      std::string signature{"f"};
+      signature += std::to_string(i);
+      signature += "(uint256)";
+      return signature;
+    }};
+
+    std::string list;
+    for (size_t i = 0; i < 5000; i++) {
+      list += signature_of(i) + "\n";
+    }
+
+    SignatureIndex index{build_signature_index(list)};
+    CHECK(index.size() == 5000);
+
+    for (size_t i = 0; i < 5000; i++) {
+      auto signature{signature_of(i)};
+      REQUIRE(index.find(selector_from_signature(signature)) == signature);
+    }
+  }
+
+  TEST_CASE("load a memory-mapped index") {
+    auto path{std::filesystem::temp_directory_path() / "evmtools_signature_index_test.bin"};
+    {
+      auto image{build_signature_index(SIGNATURES)};
+      std::ofstream file{path, std::ios::binary};
+      file.write(reinterpret_cast<const char*>(image.data()),
+                 static_cast<std::streamsize>(image.size()));
+    }
+
+    {
+      SignatureIndex index{path};
+      CHECK(index.size() == 5);
+      CHECK(index.find(Selector{0x70a08231}) == "balanceOf(address)");
+    }
+
+    std::filesystem::remove(path);
+  }
+
+  TEST_CASE("reject invalid indexes") {
+    CHECK(SignatureIndex{build_signature_index("")}.size() == 0);
+    CHECK_FALSE(SignatureIndex{build_signature_index("")}.find(Selector{0}).has_value());
+
+    auto image{build_signature_index(SIGNATURES)};
+    CHECK_THROWS_AS(SignatureIndex{std::vector<uint8_t>(image.begin(), image.end() - 1)},
+                    std::runtime_error);
+
+    image[0] = 'X';
+    CHECK_THROWS_AS(SignatureIndex{image}, std::runtime_error);
+  }
+}
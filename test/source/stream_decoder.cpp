@@ -0,0 +1,113 @@
+#include <doctest/doctest.h>
+#include <evmtools/mapped_file.h>
+#include <evmtools/stream_decoder.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+TEST_SUITE("stream_decoder") {
+  using namespace evmtools::stream_decoder;
+
+  constexpr std::string_view TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+      "0000000000000000000000000000000005f7aab8c56b0000"};
+
+  TEST_CASE("extract calldata from hex and json lines") {
+    CHECK(extract_calldata("  0xa9059cbb\r") == "0xa9059cbb");
+    CHECK(extract_calldata(R"({"hash": "0x01", "input" : "0xa9059cbb"})") == "0xa9059cbb");
+    CHECK_FALSE(extract_calldata(R"({"hash": "0x01"})").has_value());
+  }
+
+  TEST_CASE("decode stream writes results in input order") {
+    std::string input;
+    for (size_t i = 0; i < 100; i++) {
+      input += i % 10 == 3 ? std::string{"0xzz"} : std::string{TRANSFER};
+      input += i % 2 == 0 ? "\n" : "\n\n";
+    }
+
+    std::ostringstream out;
+    auto stats{decode_stream(input, out, StreamOptions{2, 7, 2})};
+
+    CHECK(stats.inputs == 100);
+    CHECK(stats.decoded == 90);
+
+    std::istringstream lines{out.str()};
+    std::string line;
+    for (size_t i = 0; i < 100; i++) {
+      REQUIRE(std::getline(lines, line));
+      CHECK(line.starts_with(std::to_string(i) + "\t" + (i % 10 == 3 ? "error" : "a9059cbb")));
+    }
+  }
+
+  TEST_CASE("decode repeated inputs once through a cache") {
+    std::string input;
+    for (size_t i = 0; i < 100; i++) {
+      input += i % 10 == 3 ? std::string{"0xzz"} : std::string{TRANSFER};
+      input += '\n';
+    }
+
+    evmtools::decode_cache::DecodeCache cache{16};
+    StreamOptions options{2, 7, 2};
+    options.cache = &cache;
+
+    std::ostringstream cached;
+    auto stats{decode_stream(input, cached, options)};
+    CHECK(stats.inputs == 100);
+    CHECK(stats.decoded == 90);
+    CHECK(cache.stats().size == 1);
+    CHECK(cache.stats().hits >= 80);
+
+    std::ostringstream uncached;
+    decode_stream(input, uncached, StreamOptions{2, 7, 2});
+    CHECK(cached.str() == uncached.str());
+  }
+
+  TEST_CASE("name known selectors") {
+    evmtools::signature_index::SignatureIndex signatures{
+        evmtools::signature_index::build_signature_index("transfer(address,uint256)\n")};
+
+    StreamOptions options{};
+    options.signatures = &signatures;
+
+    std::ostringstream out;
+    decode_stream(TRANSFER, out, options);
+    CHECK(out.str().starts_with("0\ta9059cbb:transfer(address,uint256)\t"));
+  }
+
+  TEST_CASE("decode stream writes one json object per line") {
+    std::string input{std::string{TRANSFER} + "\n0xzz\n"};
+    StreamOptions options{};
+    options.format = OutputFormat::Json;
+
+    std::ostringstream out;
+    decode_stream(input, out, options);
+
+    std::istringstream lines{out.str()};
+    std::string line;
+    REQUIRE(std::getline(lines, line));
+    CHECK(line.starts_with(R"({"index":0,"selector":"0xa9059cbb",)"));
+    CHECK(line.ends_with(R"("nested":[]})"));
+    REQUIRE(std::getline(lines, line));
+    CHECK(line == R"({"index":1,"error":true})");
+    CHECK_FALSE(std::getline(lines, line));
+  }
+
+  TEST_CASE("decode a memory-mapped file") {
+    auto path{std::filesystem::temp_directory_path() / "evmtools_stream_decoder_test.txt"};
+    {
+      std::ofstream file{path};
+      file << R"({"input":")" << TRANSFER << "\"}\n";
+    }
+
+    evmtools::mapped_file::MappedFile mapped{path};
+    CHECK(mapped.size() == TRANSFER.size() + 13);
+
+    std::ostringstream out;
+    CHECK(decode_stream(mapped.text(), out).decoded == 1);
+    CHECK(out.str().starts_with("0\ta9059cbb\t"));
+
+    std::filesystem::remove(path);
+  }
+}
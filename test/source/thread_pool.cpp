@@ -0,0 +1,45 @@
+#include <doctest/doctest.h>
+#include <evmtools/thread_pool.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST_SUITE("thread_pool") {
+  using namespace evmtools::thread_pool;
+
+  TEST_CASE("parallel_for visits every index once") {
+    ThreadPool pool{4};
+    CHECK(pool.size() == 4);
+
+    std::vector<std::atomic<int>> visits(10'000);
+    pool.parallel_for(visits.size(), 7, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) visits[i]++;
+    });
+
+    for (const auto& count : visits) {
+      CHECK(count.load() == 1);
+    }
+  }
+
+  TEST_CASE("nested parallel_for doesn't deadlock") {
+    ThreadPool pool{2};
+    std::atomic<size_t> total{0};
+
+    pool.parallel_for(8, 1, [&](size_t, size_t) {
+      pool.parallel_for(100, 10, [&](size_t begin, size_t end) { total += end - begin; });
+    });
+
+    CHECK(total.load() == 800);
+  }
+
+  TEST_CASE("parallel_for rethrows task exceptions") {
+    ThreadPool pool{2};
+
+    CHECK_THROWS_AS(pool.parallel_for(10, 1,
+                                      [](size_t begin, size_t) {
+                                        if (begin == 5) throw std::runtime_error("task failed");
+                                      }),
+                    std::runtime_error);
+  }
+}
@@ -0,0 +1,176 @@
+#include <doctest/doctest.h>
+#include <evmtools/transaction_decoder.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "rlp.h"
+
+TEST_SUITE("transaction_decoder") {
+  using namespace evmtools::transaction_decoder;
+  using evmtools::calldata_decoder::bytes_from_hex;
+  using evmtools::calldata_decoder::DecodeStatus;
+  using evmtools::calldata_decoder::Selector;
+  using Bytes = std::vector<uint8_t>;
+
+  // The signed example transaction of EIP-155.
+  constexpr std::string_view EIP155_TRANSACTION{
+      "0xf86c098504a817c800825208943535353535353535353535353535353535353535880de0b6b3a764000080"
+      "25a028ef61340bd939bc2195fe537567866003e1a15d3c71ff63e1590620aa636276a067cbe9d8997f761aec"
+      "b703304b3800ccf555c9f3dc64214b297fb1966a3b6d83"};
+
+  constexpr std::string_view TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af0000000000000000"
+      "0000000000000000000000000000000005f7aab8c56b0000"};
+
+  const Bytes RECIPIENT(20, 0x35);
+
+  /** A signed EIP-1559 transaction calling `data`. */
+  Bytes dynamic_fee(const Bytes& data) {
+    return typed(2, rlp_list({rlp_uint(1), rlp_uint(7), rlp_uint(2), rlp_uint(100), rlp_uint(90000),
+                              rlp_string(RECIPIENT), rlp_uint(0), rlp_string(data), rlp_list({}),
+                              rlp_uint(1), rlp_string(Bytes(32, 1)), rlp_string(Bytes(32, 2))}));
+  }
+
+  bool points_into(std::span<const uint8_t> field, const Bytes& buffer) {
+    return field.data() >= buffer.data()
+           && field.data() + field.size() <= buffer.data() + buffer.size();
+  }
+
+  TEST_CASE("decode a legacy transaction") {
+    auto encoded{bytes_from_hex(EIP155_TRANSACTION)};
+    auto transaction{decode_transaction(encoded)};
+
+    CHECK(transaction.type == TransactionType::Legacy);
+    CHECK(transaction.chain_id == 1);
+    CHECK(transaction.nonce == 9);
+    CHECK(transaction.gas_limit == 21000);
+    CHECK(transaction.to.size() == 20);
+    CHECK(transaction.to[0] == 0x35);
+    CHECK(transaction.value_uint() == intx::uint256{1000000000000000000});
+    CHECK(transaction.data.empty());
+    CHECK(transaction.encoded.size() == encoded.size());
+
+    // Plain transfers have no calldata to decode.
+    CHECK(decode_calldata(transaction).status == DecodeStatus::Malformed);
+  }
+
+  TEST_CASE("decode every typed transaction in place") {
+    auto data{bytes_from_hex(TRANSFER)};
+    const Bytes access_list{rlp_list({rlp_list({rlp_string(RECIPIENT), rlp_list({})})})};
+
+    std::vector<std::pair<TransactionType, Bytes>> transactions{
+        {TransactionType::AccessList,
+         typed(1, rlp_list({rlp_uint(5), rlp_uint(3), rlp_uint(2), rlp_uint(90000),
+                            rlp_string(RECIPIENT), rlp_uint(1000), rlp_string(data),
+                            access_list}))},
+        {TransactionType::DynamicFee, dynamic_fee(data)},
+        {TransactionType::Blob,
+         typed(3, rlp_list({rlp_uint(5), rlp_uint(3), rlp_uint(1), rlp_uint(2), rlp_uint(90000),
+                            rlp_string(RECIPIENT), rlp_uint(1000), rlp_string(data), access_list,
+                            rlp_uint(4), rlp_list({rlp_string(Bytes(32, 1))}), rlp_uint(0),
+                            rlp_string(Bytes(32, 1)), rlp_string(Bytes(32, 2))}))},
+    };
+
+    for (const auto& [type, encoded] : transactions) {
+      CAPTURE(type_name(type));
+      auto transaction{decode_transaction(encoded)};
+
+      CHECK(transaction.type == type);
+      CHECK(transaction.chain_id.has_value());
+      CHECK(transaction.to.size() == 20);
+      CHECK(points_into(transaction.to, encoded));
+      CHECK(points_into(transaction.data, encoded));
+      CHECK(transaction.data.size() == data.size());
+
+      auto result{decode_calldata(transaction)};
+      REQUIRE(result);
+      CHECK(result.calldata->selector == Selector{0xa9059cbb});
+      CHECK(result.calldata->calldata.data() == transaction.data.data());
+    }
+  }
+
+  TEST_CASE("decode wrapped and network forms") {
+    auto data{bytes_from_hex(TRANSFER)};
+
+    // Block bodies wrap typed transactions in a string.
+    auto wrapped{rlp_string(dynamic_fee(data))};
+    auto transaction{decode_transaction(wrapped)};
+    CHECK(transaction.type == TransactionType::DynamicFee);
+    CHECK(transaction.nonce == 7);
+    CHECK(transaction.encoded.size() == dynamic_fee(data).size());
+
+    // Blob transactions on the network carry their blobs, commitments and proofs.
+    auto body{rlp_list({rlp_uint(1), rlp_uint(9), rlp_uint(1), rlp_uint(2), rlp_uint(90000),
+                        rlp_string(RECIPIENT), rlp_uint(0), rlp_string(data), rlp_list({}),
+                        rlp_uint(4), rlp_list({})})};
+    auto network{typed(3, rlp_list({body, rlp_list({}), rlp_list({}), rlp_list({})}))};
+    auto blob{decode_transaction(network)};
+    CHECK(blob.type == TransactionType::Blob);
+    CHECK(blob.nonce == 9);
+    CHECK(blob.data.size() == data.size());
+
+    // Unsigned transactions and contract creation.
+    auto creation{rlp_list({rlp_uint(0), rlp_uint(1), rlp_uint(53000), rlp_string({}),
+                            rlp_uint(0), rlp_string(Bytes(100, 0x60))})};
+    auto created{decode_transaction(creation)};
+    CHECK(created.is_create());
+    CHECK_FALSE(created.chain_id.has_value());
+    CHECK(created.data.size() == 100);
+  }
+
+  TEST_CASE("split the transactions of a block body") {
+    auto legacy{bytes_from_hex(EIP155_TRANSACTION)};
+    auto list{rlp_list({legacy, rlp_string(dynamic_fee(bytes_from_hex(TRANSFER))), legacy})};
+
+    auto transactions{split_transactions(list)};
+    REQUIRE(transactions.size() == 3);
+    CHECK(decode_transaction(transactions[0]).type == TransactionType::Legacy);
+    CHECK(decode_transaction(transactions[1]).type == TransactionType::DynamicFee);
+    CHECK(decode_transaction(transactions[2]).nonce == 9);
+
+    CHECK(split_transactions(rlp_list({})).empty());
+    CHECK_THROWS_AS((void)split_transactions(rlp_string(Bytes(3, 1))), std::invalid_argument);
+  }
+
+  TEST_CASE("reject malformed transactions") {
+    auto valid{bytes_from_hex(EIP155_TRANSACTION)};
+    auto data{bytes_from_hex(TRANSFER)};
+
+    std::vector<Bytes> malformed{
+        {},
+        // Truncated, or followed by trailing bytes.
+        Bytes(valid.begin(), valid.end() - 1),
+        [&] {
+          auto longer{valid};
+          longer.push_back(0);
+          return longer;
+        }(),
+        // A single small byte must be encoded as itself.
+        rlp_list({Bytes{0x81, 0x05}, rlp_uint(1), rlp_uint(1), rlp_string(RECIPIENT), rlp_uint(0),
+                  rlp_string({})}),
+        // Integers must not have leading zeros.
+        rlp_list({rlp_string({0, 1}), rlp_uint(1), rlp_uint(1), rlp_string(RECIPIENT), rlp_uint(0),
+                  rlp_string({})}),
+        // Wrong number of fields, or a recipient that isn't an address.
+        rlp_list({rlp_uint(1), rlp_uint(1), rlp_string(RECIPIENT), rlp_uint(0), rlp_string({})}),
+        rlp_list({rlp_uint(1), rlp_uint(1), rlp_uint(1), rlp_string(Bytes(19, 1)), rlp_uint(0),
+                  rlp_string({})}),
+        // Unsupported types, and blob transactions that create contracts.
+        typed(5, rlp_list({})),
+        typed(3, rlp_list({rlp_uint(1), rlp_uint(9), rlp_uint(1), rlp_uint(2), rlp_uint(90000),
+                           rlp_string({}), rlp_uint(0), rlp_string(data), rlp_list({}),
+                           rlp_uint(4), rlp_list({})})),
+        // A long-form length that fits the short form.
+        Bytes{0xf8, 0x01, 0x80},
+        // A length far past the end of the input.
+        Bytes{0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    };
+
+    for (size_t i = 0; i < malformed.size(); i++) {
+      CAPTURE(i);
+      CHECK_FALSE(try_decode_transaction(malformed[i]).has_value());
+      CHECK_THROWS_AS((void)decode_transaction(malformed[i]), std::invalid_argument);
+    }
+  }
+}
@@ -0,0 +1,150 @@
+#include <doctest/doctest.h>
+#include <evmtools/typed_decoder.h>
+
+#include <string>
+#include <vector>
+
+TEST_SUITE("typed_decoder") {
+  using namespace evmtools::typed_decoder;
+  using evmtools::calldata_decoder::bytes_from_hex;
+
+  const std::string TRANSFER{
+      "0xa9059cbb0000000000000000000000004d278b35b4fa66e7dc694197826abf76240533af00000000000000000"
+      "000000000000000000000000000000005f7aab8c56b0000"};
+
+  TEST_CASE("compute selectors and param types at compile time") {
+    using Transfer = decoder<"transfer(address,uint256)">;
+    static_assert(Transfer::selector == Selector{0xa9059cbb});
+    static_assert(Transfer::params.size() == 2);
+    static_assert(Transfer::params[0].kind == Kind::Address);
+    static_assert(Transfer::params[1].kind == Kind::Uint && Transfer::params[1].size == 256);
+
+    using Multicall = decoder<"multicall(uint256,bytes[])">;
+    static_assert(Multicall::params[1].kind == Kind::Array);
+    static_assert(Multicall::params[1].element == Kind::Bytes);
+    static_assert(std::is_same_v<Multicall::values,
+                                 std::tuple<intx::uint256, std::vector<std::span<const uint8_t>>>>);
+
+    static_assert(decoder<"name()">::params.empty());
+    static_assert(decoder<"f(int8,bytes4,bool)">::params[1].size == 4);
+  }
+
+  TEST_CASE("decode a transfer") {
+    auto bytes{bytes_from_hex(TRANSFER)};
+    auto values{decoder<"transfer(address,uint256)">::decode(bytes)};
+
+    REQUIRE(values.has_value());
+    auto [to, amount]{*values};
+    CHECK(to.to_hex() == "4d278b35b4fa66e7dc694197826abf76240533af");
+    CHECK(amount == intx::uint256{0x5f7aab8c56b0000});
+  }
+
+  TEST_CASE("reject calldata that doesn't match the signature") {
+    auto bytes{bytes_from_hex(TRANSFER)};
+
+    // Different selector
+    CHECK_FALSE(decoder<"approve(address,uint256)">::decode(bytes).has_value());
+
+    // Too short
+    CHECK_FALSE(decoder<"transfer(address,uint256)">::decode(
+                    std::span{bytes}.first(bytes.size() - 1))
+                    .has_value());
+
+    // Dirty address padding
+    bytes[4] = 0x01;
+    CHECK_FALSE(decoder<"transfer(address,uint256)">::decode(bytes).has_value());
+  }
+
+  TEST_CASE("check the padding of small values") {
+    using Decoder = decoder<"f(int8,bool,bytes2)">;
+    auto bytes{bytes_from_hex(Selector{Decoder::selector}.to_hex())};
+    auto append{[&](std::string_view hex) {
+      auto word{bytes_from_hex(hex)};
+      bytes.insert(bytes.end(), word.begin(), word.end());
+    }};
+
+    append("ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff80");
+    append("0000000000000000000000000000000000000000000000000000000000000001");
+    append("abcd000000000000000000000000000000000000000000000000000000000000");
+
+    auto values{Decoder::decode(bytes)};
+    REQUIRE(values.has_value());
+    CHECK(std::get<0>(*values) == ~intx::uint256{0x7f});
+    CHECK(std::get<1>(*values));
+    CHECK(std::get<2>(*values) == std::array<uint8_t, 2>{0xab, 0xcd});
+
+    // Not sign-extended
+    bytes[4 + 30] = 0x00;
+    CHECK_FALSE(Decoder::decode(bytes).has_value());
+    bytes[4 + 30] = 0xff;
+
+    // Neither true nor false
+    bytes[4 + 32 + 31] = 0x02;
+    CHECK_FALSE(Decoder::decode(bytes).has_value());
+    bytes[4 + 32 + 31] = 0x01;
+
+    // Trailing bytes
+    bytes[4 + 64 + 2] = 0x01;
+    CHECK_FALSE(Decoder::decode(bytes).has_value());
+  }
+
+  TEST_CASE("decode dynamic params as views into the calldata") {
+    // multicall(bytes[]) with two transfers
+    auto transfer{bytes_from_hex(TRANSFER)};
+    auto bytes{bytes_from_hex("0xac9650d8")};
+    auto append_size{[&](size_t value) {
+      std::vector<uint8_t> word(WORD_SIZE, 0);
+      for (size_t i = 0; i < 4; i++) word[WORD_SIZE - 1 - i] = uint8_t(value >> (8 * i));
+      bytes.insert(bytes.end(), word.begin(), word.end());
+    }};
+    const size_t padded{(transfer.size() + WORD_SIZE - 1) / WORD_SIZE * WORD_SIZE};
+
+    append_size(WORD_SIZE);
+    append_size(2);
+    append_size(2 * WORD_SIZE);
+    append_size(3 * WORD_SIZE + padded);
+    for (size_t i = 0; i < 2; i++) {
+      append_size(transfer.size());
+      bytes.insert(bytes.end(), transfer.begin(), transfer.end());
+      bytes.resize(bytes.size() + padded - transfer.size(), 0);
+    }
+
+    auto values{decoder<"multicall(bytes[])">::decode(bytes)};
+    REQUIRE(values.has_value());
+    const auto& calls{std::get<0>(*values)};
+    REQUIRE(calls.size() == 2);
+    CHECK(std::ranges::equal(calls[0], transfer));
+    CHECK(std::ranges::equal(calls[1], transfer));
+    CHECK(calls[0].data() >= bytes.data());
+    CHECK(calls[1].data() + calls[1].size() <= bytes.data() + bytes.size());
+
+    // An element offset past the end of the calldata
+    bytes[4 + 3 * WORD_SIZE - 1] = 0xff;
+    CHECK_FALSE(decoder<"multicall(bytes[])">::decode(bytes).has_value());
+    bytes[4 + 3 * WORD_SIZE - 1] = uint8_t(2 * WORD_SIZE);
+
+    // An array longer than the calldata
+    bytes[4 + 2 * WORD_SIZE - 4] = 0x10;
+    CHECK_FALSE(decoder<"multicall(bytes[])">::decode(bytes).has_value());
+  }
+
+  TEST_CASE("dispatch on the selector") {
+    auto bytes{bytes_from_hex(TRANSFER)};
+    std::string visited;
+
+    auto visitor{[&]<typename Decoder>(Decoder, const typename Decoder::values&) {
+      visited = Decoder::signature;
+    }};
+
+    CHECK(CommonDecoders::contains(Selector{0xa9059cbb}));
+    CHECK(CommonDecoders::visit(bytes, visitor));
+    CHECK(visited == "transfer(address,uint256)");
+
+    // Unknown selectors are left to the heuristic decoder.
+    visited.clear();
+    bytes[0] = 0x00;
+    CHECK_FALSE(CommonDecoders::contains(Selector::from_bytes(bytes.data())));
+    CHECK_FALSE(CommonDecoders::visit(bytes, visitor));
+    CHECK(visited.empty());
+  }
+}
@@ -0,0 +1,87 @@
+#include <doctest/doctest.h>
+#include <evmtools/calldata_decoder.h>
+#include <evmtools/word_classifier.h>
+
+#include <random>
+#include <vector>
+
+TEST_SUITE("word_classifier") {
+  using namespace evmtools;
+  using calldata_decoder::ParamTypes;
+  using calldata_decoder::Types;
+  using calldata_decoder::Word;
+
+  constexpr word_classifier::Kernel KERNELS[]{
+      word_classifier::Kernel::Scalar, word_classifier::Kernel::Sse4,
+      word_classifier::Kernel::Avx2};
+
+  /** Words that sit on either side of every pattern the classifier looks for. */
+  std::vector<Word> edge_words(std::mt19937& rng) {
+    std::vector<Word> words;
+    constexpr uint8_t BYTES[]{0x00, 0x01, 0x08, 0x09, 0x0f, 0x10, 0x7f, 0x80, 0xfe, 0xff};
+
+    // Runs of 0x00 or 0xff of every length, then one chosen byte, then random or repeated bytes.
+    for (uint8_t fill : {0x00, 0xff}) {
+      for (size_t run = 0; run <= calldata_decoder::WORD_SIZE; run++) {
+        for (auto next : BYTES) {
+          for (bool random : {false, true}) {
+            Word word{};
+            for (size_t i = 0; i < word.bytes.size(); i++) {
+              word.bytes[i] = i < run ? fill
+                              : i == run ? next
+                              : random   ? static_cast<uint8_t>(rng())
+                                         : fill;
+            }
+            words.push_back(word);
+          }
+        }
+      }
+    }
+
+    // Selector-shaped words, with and without a zero or 0xff byte in the selector.
+    for (size_t i = 0; i < 200; i++) {
+      Word word{};
+      for (size_t j = 0; j < 4; j++) word.bytes[j] = BYTES[rng() % std::size(BYTES)];
+      if (rng() % 2 != 0) {
+        for (size_t j = 8; j < word.bytes.size(); j++) word.bytes[j] = static_cast<uint8_t>(rng());
+      }
+      words.push_back(word);
+    }
+
+    words.push_back(calldata_decoder::constants::MAX_U128_WORD);
+    words.push_back(calldata_decoder::constants::MAX_U256_WORD);
+
+    return words;
+  }
+
+  TEST_CASE("kernels match get_param_type") {
+    std::mt19937 rng{42};
+    auto words{edge_words(rng)};
+    for (size_t i = 0; i < 1000; i++) {
+      Word word{};
+      for (auto& byte : word.bytes) byte = static_cast<uint8_t>(rng());
+      words.push_back(word);
+    }
+
+    for (auto kernel : KERNELS) {
+      std::vector<ParamTypes> types(words.size());
+      word_classifier::classify(words, types, kernel);
+
+      for (size_t i = 0; i < words.size(); i++) {
+        CHECK(types[i].mask == calldata_decoder::get_param_type(words[i]).mask);
+      }
+    }
+  }
+
+  TEST_CASE("output is never written past its end") {
+    std::vector<Word> words(4, calldata_decoder::constants::MAX_U256_WORD);
+    std::vector<ParamTypes> types(3);
+
+    for (auto kernel : KERNELS) {
+      word_classifier::classify(words, std::span{types}.first(2), kernel);
+      CHECK(types[0] == ParamTypes{Types::AnyMax});
+      CHECK(types[1] == ParamTypes{Types::AnyMax});
+      CHECK(types[2].empty());
+    }
+  }
+}